@@ -45,6 +45,35 @@ align 4                 ; aligns next data element/instruction that is multiple
     dd 768              ; screen height
     dd 32               ; depth
 
+; kernel is linked at KERNEL_VIRTUAL_BASE + 1M, but loaded at 1M
+KERNEL_VIRTUAL_BASE equ 0xC0000000
+KERNEL_PDE_INDEX    equ KERNEL_VIRTUAL_BASE >> 22
+BOOT_MAPPED_PDES    equ 4           ; map first 16 MB with 4 MB pages
+
+PDE_FLAGS           equ 0x83        ; present, writable, 4 MB page
+
+CR0_WP              equ 1 << 16     ; write protect in kernel mode
+CR0_PG              equ 1 << 31     ; enable paging
+CR4_PSE             equ 1 << 4      ; enable 4 MB pages
+
+section .data           ; stores initialized global and static variables
+align 4096
+; boot page directory maps first 16 MB twice: identity mapping is used
+; only for the jump to the higher half and is dropped by vmm.init()
+boot_page_directory:
+%assign i 0
+%rep BOOT_MAPPED_PDES
+    dd (i << 22) | PDE_FLAGS
+%assign i i + 1
+%endrep
+    times (KERNEL_PDE_INDEX - BOOT_MAPPED_PDES) dd 0
+%assign i 0
+%rep BOOT_MAPPED_PDES
+    dd (i << 22) | PDE_FLAGS
+%assign i i + 1
+%endrep
+    times (1024 - KERNEL_PDE_INDEX - BOOT_MAPPED_PDES) dd 0
+
 section .bss            ; stores uninitialized global and static variables
 align 16                ; reserving space for the stack
 stack_bottom:
@@ -53,10 +82,31 @@ stack_top:
 
 section .text           ; contains executable instructions of a program
 
+; bootloader jumps to the physical address of the entry point
 global boot
-boot:
+boot equ (_boot - KERNEL_VIRTUAL_BASE)
+
+_boot:
+    ; paging is disabled - only physical addresses can be used here
+    mov ecx, (boot_page_directory - KERNEL_VIRTUAL_BASE)
+    mov cr3, ecx        ; set boot page directory
+
+    ; global pages are enabled by vmm.init() if CPU supports them
+    mov ecx, cr4
+    or  ecx, CR4_PSE
+    mov cr4, ecx        ; enable 4 MB pages
+
+    mov ecx, cr0
+    or  ecx, CR0_PG | CR0_WP
+    mov cr0, ecx        ; enable paging
+
+    lea ecx, [higher_half]
+    jmp ecx             ; absolute jump to the higher half
+
+higher_half:
     mov esp, stack_top  ; set stack pointer
-    push ebx            ; multiboot info
+    add ebx, KERNEL_VIRTUAL_BASE
+    push ebx            ; multiboot info (virtual address)
     push eax            ; magic number
     xor ebp, ebp        ; reset ebp
     extern kmain        ; from kernel/lernel.cpp
@@ -66,6 +116,3 @@ boot:
 halt:
     hlt	                ; this instruction halts the CPU
     jmp halt            ; infinite loop
-
-section .data           ; stores initialized global and static variables
-align 4096
\ No newline at end of file
@@ -0,0 +1,179 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/drivers/ata.hpp>
+#include <kernel/arch/x86/io.hpp>
+
+
+namespace kernel {
+namespace driver {
+
+// command block registers (offsets from base)
+inline const uint16_t ATA_DATA     {0};
+inline const uint16_t ATA_COUNT    {2};
+inline const uint16_t ATA_LBA_LO   {3};
+inline const uint16_t ATA_LBA_MID  {4};
+inline const uint16_t ATA_LBA_HI   {5};
+inline const uint16_t ATA_DRIVE    {6};
+inline const uint16_t ATA_STATUS   {7};
+inline const uint16_t ATA_COMMAND  {7};
+
+// status register bits
+inline const uint8_t ATA_SR_ERR {0x01};
+inline const uint8_t ATA_SR_DRQ {0x08};
+inline const uint8_t ATA_SR_DF  {0x20};
+inline const uint8_t ATA_SR_BSY {0x80};
+
+// commands
+inline const uint8_t ATA_CMD_READ     {0x20};
+inline const uint8_t ATA_CMD_WRITE    {0x30};
+inline const uint8_t ATA_CMD_IDENTIFY {0xEC};
+
+inline const uint8_t  ATA_CTRL_NIEN {0x02};     // disable disk interrupts
+inline const uint32_t ATA_TIMEOUT   {0x100000}; // status polls before giving up
+
+bool ata_t::wait(bool drq) const noexcept
+{
+    // reading alternate status takes ~100 ns, so 4 reads give selection delay
+    for (uint32_t i = 0; i < 4; i++)
+        arch::x86::inb(m_ctrl);
+
+    for (uint32_t i = 0; i < ATA_TIMEOUT; i++) {
+        uint8_t status = arch::x86::inb(m_base + ATA_STATUS);
+
+        if (status & ATA_SR_BSY)
+            continue;
+
+        if (status & (ATA_SR_ERR | ATA_SR_DF))
+            return false;
+
+        if (!drq || (status & ATA_SR_DRQ))
+            return true;
+    }
+
+    return false;
+}
+
+void ata_t::command(uint32_t lba, uint8_t count, uint8_t cmd) const noexcept
+{
+    using namespace arch::x86;
+
+    outb(m_base + ATA_DRIVE, 0xE0 | (m_slave << 4) | ((lba >> 24) & 0x0F));
+    outb(m_base + ATA_COUNT, count);
+    outb(m_base + ATA_LBA_LO, lba & 0xFF);
+    outb(m_base + ATA_LBA_MID, (lba >> 8) & 0xFF);
+    outb(m_base + ATA_LBA_HI, (lba >> 16) & 0xFF);
+    outb(m_base + ATA_COMMAND, cmd);
+}
+
+bool ata_t::set(uint16_t base, uint16_t ctrl, bool slave) noexcept
+{
+    using namespace arch::x86;
+
+    m_base    = base;
+    m_ctrl    = ctrl;
+    m_slave   = slave;
+    m_present = false;
+    m_sectors = 0;
+    m_stats   = {};
+
+    // transfers are polled, so interrupts are not needed
+    outb(m_ctrl, ATA_CTRL_NIEN);
+    command(0, 0, ATA_CMD_IDENTIFY);
+
+    // floating bus or no drive
+    if (inb(m_base + ATA_STATUS) == 0 || inb(m_base + ATA_STATUS) == 0xFF)
+        return false;
+
+    // ATAPI & SATA devices set signature instead of data
+    if (!wait(false) || inb(m_base + ATA_LBA_MID) || inb(m_base + ATA_LBA_HI))
+        return false;
+
+    if (!wait(true))
+        return false;
+
+    uint16_t id[256];
+
+    for (uint32_t i = 0; i < 256; i++)
+        id[i] = inw(m_base + ATA_DATA);
+
+    // words 60-61 hold number of LBA28 sectors
+    m_sectors = id[60] | (uint32_t(id[61]) << 16);
+    m_present = m_sectors != 0;
+
+    return m_present;
+}
+
+bool ata_t::read(uint32_t lba, uint8_t count, void *buf) noexcept
+{
+    if (!m_present || !count || lba + count > m_sectors)
+        return false;
+
+    auto data = static_cast<uint16_t*>(buf);
+
+    command(lba, count, ATA_CMD_READ);
+    m_stats.m_reads++;
+
+    for (uint32_t s = 0; s < count; s++) {
+        if (!wait(true)) {
+            m_stats.m_errors++;
+            return false;
+        }
+
+        for (uint32_t i = 0; i < ATA_SECTOR_SIZE / 2; i++)
+            *data++ = arch::x86::inw(m_base + ATA_DATA);
+    }
+
+    m_stats.m_sectors += count;
+    return true;
+}
+
+bool ata_t::write(uint32_t lba, uint8_t count, const void *buf) noexcept
+{
+    if (!m_present || !count || lba + count > m_sectors)
+        return false;
+
+    auto data = static_cast<const uint16_t*>(buf);
+
+    command(lba, count, ATA_CMD_WRITE);
+    m_stats.m_writes++;
+
+    for (uint32_t s = 0; s < count; s++) {
+        if (!wait(true)) {
+            m_stats.m_errors++;
+            return false;
+        }
+
+        for (uint32_t i = 0; i < ATA_SECTOR_SIZE / 2; i++)
+            arch::x86::outw(m_base + ATA_DATA, *data++);
+    }
+
+    // disk stays busy until the last sector is written
+    if (!wait(false)) {
+        m_stats.m_errors++;
+        return false;
+    }
+
+    m_stats.m_sectors += count;
+    return true;
+}
+
+ata_t ata;
+
+} // namespace driver
+} // namespace kernel
@@ -0,0 +1,258 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/acpi.hpp>
+#include <kernel/arch/x86/pit.hpp>
+#include <kernel/drivers/hpet.hpp>
+#include <kernel/clocksource.hpp>
+#include <kernel/clockevent.hpp>
+#include <kernel/irq.hpp>
+#include <kernel/vmm.hpp>
+
+
+namespace kernel {
+namespace driver {
+
+// registers offsets:
+inline const uint32_t HPET_CAP        {0x000};  // general capabilities & ID
+inline const uint32_t HPET_PERIOD     {0x004};  // main counter period (fs)
+inline const uint32_t HPET_CONF       {0x010};  // general configuration
+inline const uint32_t HPET_COUNTER    {0x0F0};
+inline const uint32_t HPET_COUNTER_HI {0x0F4};
+
+/**
+ * @brief Get comparator configuration register offset.
+ *
+ * @param [in] timer - given comparator.
+ * @return register offset.
+ */
+static inline uint32_t timer_conf(uint32_t timer) noexcept
+{
+    return 0x100 + timer * 0x20;
+}
+
+/**
+ * @brief Get comparator value register offset.
+ *
+ * @param [in] timer - given comparator.
+ * @return register offset.
+ */
+static inline uint32_t timer_cmp(uint32_t timer) noexcept
+{
+    return 0x108 + timer * 0x20;
+}
+
+// capabilities bits:
+inline const uint32_t CAP_NUM_TIM_SHIFT {8};
+inline const uint32_t CAP_NUM_TIM_MASK  {0x1F};
+inline const uint32_t CAP_COUNT_SIZE    {1 << 13};  // 64-bit main counter
+inline const uint32_t CAP_LEGACY        {1 << 15};  // legacy replacement route
+
+// general configuration bits:
+inline const uint32_t CONF_ENABLE {1 << 0};     // main counter runs
+inline const uint32_t CONF_LEGACY {1 << 1};     // timer 0 - IRQ 0, timer 1 - IRQ 8
+
+// comparator configuration bits:
+inline const uint32_t TIMER_INT_ENABLE {1 << 2};
+inline const uint32_t TIMER_PERIODIC   {1 << 3};
+inline const uint32_t TIMER_PER_CAP    {1 << 4};  // periodic mode is supported
+inline const uint32_t TIMER_SIZE_CAP   {1 << 5};  // 64-bit comparator
+inline const uint32_t TIMER_VAL_SET    {1 << 6};  // next write sets periodic accumulator
+inline const uint32_t TIMER_32BIT      {1 << 8};  // force 32-bit mode
+
+inline const uint32_t HPET_MMIO_SIZE   {1_KB};
+inline const uint32_t HPET_MAX_PERIOD  {100000000};      // 100 ns (fs)
+inline const uint64_t FSEC_PER_MSEC    {1000000000000};
+inline const uint32_t HPET_MIN_TICKS   {128};            // shortest reliable one-shot delta
+inline const uint32_t HPET_MAX_TICKS   {0x7FFFFFFF};     // comparators run in 32-bit mode
+
+hpet_t hpet;
+
+static uint64_t hpet_read(void) noexcept
+{
+    return hpet.read();
+}
+
+static bool hpet_set_next_event(uint32_t ticks) noexcept
+{
+    return hpet.set_oneshot(0, ticks);
+}
+
+static bool hpet_set_periodic(uint32_t ticks) noexcept
+{
+    return hpet.set_periodic(0, ticks);
+}
+
+static void hpet_shutdown(void) noexcept
+{
+    hpet.stop(0);
+}
+
+static core::clocksource_t hpet_clocksource {
+    "hpet", core::RATING_HPET, 0, core::CLOCKSOURCE_MASK_64, 0, 0, nullptr, hpet_read
+};
+
+static core::clockevent_t hpet_clockevent {
+    "hpet", core::CLOCK_EVT_ONESHOT, core::RATING_EVT_HPET, 0, HPET_MIN_TICKS, HPET_MAX_TICKS,
+    0, 0, 0, 0, 0, nullptr, hpet_set_next_event, hpet_set_periodic, hpet_shutdown, nullptr
+};
+
+/**
+ * @brief Handle interrupt of timer 0.
+ *
+ * @param [in] irq - given IRQ line.
+ * @param [in] dev - given HPET.
+ */
+static void hpet_irq(uint32_t irq, void *dev) noexcept
+{
+    (void)irq;
+    (void)dev;
+
+    // edge triggered, so status register is not cleared
+    core::clockevent_handle(hpet_clockevent);
+}
+
+uint32_t hpet_t::reg_read(uint32_t reg) const noexcept
+{
+    return m_regs[reg >> 2];
+}
+
+void hpet_t::reg_write(uint32_t reg, uint32_t value) noexcept
+{
+    m_regs[reg >> 2] = value;
+}
+
+bool hpet_t::set(void) noexcept
+{
+    using namespace arch::x86;
+
+    auto table = reinterpret_cast<const acpi::hpet_table_t*>(acpi::find_table("HPET"));
+    m_regs     = nullptr;
+
+    if (!table || table->m_base.m_space_id != acpi::GAS_MEMORY || table->m_base.m_addr >> 32)
+        return false;
+
+    m_regs = static_cast<volatile uint32_t*>(core::memory::vmm.ioremap(table->m_base.m_addr, HPET_MMIO_SIZE));
+
+    if (!m_regs)
+        return false;
+
+    uint32_t cap = reg_read(HPET_CAP);
+    m_period     = reg_read(HPET_PERIOD);
+
+    if (!m_period || m_period > HPET_MAX_PERIOD) {
+        m_regs = nullptr;
+        return false;
+    }
+
+    m_nr_timers = ((cap >> CAP_NUM_TIM_SHIFT) & CAP_NUM_TIM_MASK) + 1;
+    m_wide      = cap & CAP_COUNT_SIZE;
+    m_legacy    = cap & CAP_LEGACY;
+    m_khz       = kstd::div_u64(FSEC_PER_MSEC, m_period);
+
+    // firmware may have left main counter or comparators running
+    reg_write(HPET_CONF, reg_read(HPET_CONF) & ~(CONF_ENABLE | CONF_LEGACY));
+    reg_write(HPET_COUNTER, 0);
+    reg_write(HPET_COUNTER_HI, 0);
+
+    for (uint32_t timer = 0; timer < m_nr_timers; timer++)
+        stop(timer);
+
+    reg_write(HPET_CONF, CONF_ENABLE | (m_legacy ? CONF_LEGACY : 0));
+
+    hpet_clocksource.m_khz = m_khz;
+
+    if (!m_wide)
+        hpet_clocksource.m_mask = 0xFFFFFFFF;
+
+    core::clocksource_register(hpet_clocksource);
+
+    // without legacy replacement comparators are not connected to ISA lines
+    if (!m_legacy || !core::request_irq(pit::IRQ, hpet_irq, "hpet", this))
+        return true;
+
+    if (reg_read(timer_conf(0)) & TIMER_PER_CAP)
+        hpet_clockevent.m_features |= core::CLOCK_EVT_PERIODIC;
+
+    hpet_clockevent.m_khz = m_khz;
+    core::clockevent_register(hpet_clockevent);
+
+    return true;
+}
+
+uint64_t hpet_t::read(void) const noexcept
+{
+    if (!m_wide)
+        return reg_read(HPET_COUNTER);
+
+    uint32_t high, low;
+
+    // the lower half may wrap between two 32-bit reads
+    do {
+        high = reg_read(HPET_COUNTER_HI);
+        low  = reg_read(HPET_COUNTER);
+    } while (high != reg_read(HPET_COUNTER_HI));
+
+    return (static_cast<uint64_t>(high) << 32) | low;
+}
+
+uint32_t hpet_t::read_low(void) const noexcept
+{
+    return reg_read(HPET_COUNTER);
+}
+
+bool hpet_t::set_oneshot(uint32_t timer, uint32_t ticks) noexcept
+{
+    uint32_t conf = reg_read(timer_conf(timer));
+
+    conf &= ~TIMER_PERIODIC;
+    conf |= TIMER_INT_ENABLE | TIMER_32BIT;
+    reg_write(timer_conf(timer), conf);
+
+    uint32_t cmp = read_low() + ticks;
+    reg_write(timer_cmp(timer), cmp);
+
+    // comparator matches only once, so it must be still ahead of counter
+    return static_cast<int32_t>(cmp - read_low()) > static_cast<int32_t>(HPET_MIN_TICKS / 2);
+}
+
+bool hpet_t::set_periodic(uint32_t timer, uint32_t ticks) noexcept
+{
+    uint32_t conf = reg_read(timer_conf(timer));
+
+    if (!(conf & TIMER_PER_CAP))
+        return false;
+
+    conf |= TIMER_INT_ENABLE | TIMER_PERIODIC | TIMER_VAL_SET | TIMER_32BIT;
+    reg_write(timer_conf(timer), conf);
+
+    // the first write sets comparator, the second - period added on match
+    reg_write(timer_cmp(timer), read_low() + ticks);
+    reg_write(timer_cmp(timer), ticks);
+
+    return true;
+}
+
+void hpet_t::stop(uint32_t timer) noexcept
+{
+    uint32_t conf = reg_read(timer_conf(timer));
+    reg_write(timer_conf(timer), conf & ~(TIMER_INT_ENABLE | TIMER_PERIODIC));
+}
+
+} // namespace driver
+} // namespace kernel
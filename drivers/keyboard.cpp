@@ -17,7 +17,10 @@
  */
 
 #include <kernel/drivers/keyboard.hpp>
+#include <kernel/arch/x86/system.hpp>
 #include <kernel/arch/x86/io.hpp>
+#include <kernel/sched.hpp>
+#include <kernel/irq.hpp>
 
 
 namespace kernel {
@@ -80,59 +83,138 @@ UNKNOWN,UNKNOWN,UNKNOWN,UNKNOWN,UNKNOWN,UNKNOWN,UNKNOWN,UNKNOWN,UNKNOWN,UNKNOWN,
 };
 
 
+inline const uint32_t KEYBOARD_IRQ    {1};
+inline const uint16_t KEYBOARD_DATA   {0x60};
+inline const uint16_t KEYBOARD_STATUS {0x64};
+inline const uint8_t  STATUS_OUTPUT   {0x01}; // output buffer is full
+
+/**
+ * @brief Keyboard interrupt handler.
+ *
+ * @param [in] irq - given IRQ line.
+ * @param [in] dev - given keyboard.
+ */
+static void keyboard_irq(uint32_t irq, void *dev) noexcept
+{
+    (void)irq;
+    static_cast<keyboard_t*>(dev)->receive();
+}
+
 void keyboard_t::set(void) noexcept
 {
     m_is_caps      = false;
     m_is_caps_lock = false;
+    m_is_extended  = false;
+    m_reader       = nullptr;
+    m_codes.init();
+
+    // drop scan codes received before interrupts
+    while (arch::x86::inb(KEYBOARD_STATUS) & STATUS_OUTPUT)
+        arch::x86::inb(KEYBOARD_DATA);
+
+    core::request_irq(KEYBOARD_IRQ, keyboard_irq, "keyboard", this);
 }
 
-inline void keyboard_t::wait(void) const noexcept
+void keyboard_t::receive(void) noexcept
 {
-    while((arch::x86::inb(0x64) & 0x01) == 0)
-        continue;
+    uint8_t code = arch::x86::inb(KEYBOARD_DATA);
+
+    // key presses are lost when reader does not keep up
+    m_codes.push(code);
+
+    if (m_reader)
+        core::wake_up_process(m_reader);
 }
 
-uint8_t keyboard_t::getchar(void) const noexcept
+inline void keyboard_t::wait(void) noexcept
 {
-    wait();
+    for (;;) {
+        arch::x86::irq_disable();
 
-    uint8_t scan_code = arch::x86::inb(0x60) & 0x7F; // get code of key that is pressed
-    uint8_t press     = arch::x86::inb(0x60) & 0x80; // is key is pressed down or released
+        if (!m_codes.empty())
+            break;
 
-    switch(static_cast<key>(scan_code)) {
-        case key::up_arrow:
-        case key::down_arrow:
-        case key::left_arrow:
-        case key::right_arrow:
+        // sleep until controller raises IRQ 1, CPU is given to other tasks
+        m_reader = core::current();
+        core::set_current_state(core::task_state::SLEEPING);
+        core::schedule();
+        m_reader = nullptr;
+    }
+
+    arch::x86::irq_enable();
+}
+
+uint8_t keyboard_t::decode(uint8_t code) noexcept
+{
+    if (static_cast<key>(code) == key::extended) {
+        m_is_extended = true;
+        return 0;
+    }
+
+    uint8_t scan_code = code & 0x7F; // get code of key that is pressed
+    uint8_t press     = code & 0x80; // is key is pressed down or released
+    bool extended     = m_is_extended;
 
+    m_is_extended = false;
+
+    // extended codes are arrows, right modifiers & navigation keys
+    if (extended) {
+        if (press)
+            return 0;
+
+        if (static_cast<key>(scan_code) == key::enter)
+            return '\n';
+
+        if (static_cast<key>(scan_code) == key::slash)
+            return '/';
+
+        return 0;
+    }
+
+    switch(static_cast<key>(scan_code)) {
         case key::lshft:
-            if(!press)
-                m_is_caps = true;
-            else
-                m_is_caps = false;
-            break;
+        case key::rshft:
+            m_is_caps = !press;
+            return 0;
 
         case key::caps_lock:
-            if(!m_is_caps_lock && !press)
-                m_is_caps_lock = true;
-            else if(m_is_caps_lock && !press)
-                m_is_caps_lock = false;
-            break;
+            if (!press)
+                m_is_caps_lock = !m_is_caps_lock;
+            return 0;
 
         default:
-            if(!press) {
-                uint8_t cc;
+            break;
+    }
 
-                if((m_is_caps || m_is_caps_lock) && (lowercase[scan_code] != UNKNOWN))
-                    cc = uppercase[scan_code];
-                else
-                    cc = lowercase[scan_code];
+    if (press)
+        return 0;
 
-                return cc;
-            }
-            break;
+    uint32_t cc;
+
+    if((m_is_caps || m_is_caps_lock) && (lowercase[scan_code] != UNKNOWN))
+        cc = uppercase[scan_code];
+    else
+        cc = lowercase[scan_code];
+
+    // special keys are encoded above ASCII range
+    return cc < 0x80 ? static_cast<uint8_t>(cc) : 0;
+}
+
+uint8_t keyboard_t::getchar(void) noexcept
+{
+    uint8_t code;
+
+    for (;;) {
+        if (!m_codes.pop(code)) {
+            wait();
+            continue;
+        }
+
+        uint8_t cc = decode(code);
+
+        if (cc)
+            return cc;
     }
-    return 0;
 }
 
 keyboard_t keyboard;
@@ -18,6 +18,7 @@
 
 #include <kernel/drivers/vesa.hpp>
 #include <kernel/gfx/font.hpp>
+#include <kernel/vmm.hpp>
 
 
 namespace kernel {
@@ -25,11 +26,14 @@ namespace driver {
 
 void vesa_t::set(const multiboot_t& mboot) noexcept
 {
-    m_addr   = reinterpret_cast<uint32_t*>(mboot.framebuffer_addr);
     m_pitch  = mboot.framebuffer_pitch;
     m_width  = mboot.framebuffer_width;
     m_height = mboot.framebuffer_height;
     m_bpp    = mboot.framebuffer_bpp;
+
+    // framebuffer is not covered by the direct map
+    auto size = m_pitch * m_height;
+    m_addr    = static_cast<uint32_t*>(core::memory::vmm.ioremap(mboot.framebuffer_addr, size));
 }
 
 inline void vesa_t::draw_pixel(uint32_t x, uint32_t y, gfx::rgb_t color) noexcept
@@ -0,0 +1,300 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/tsc.hpp>
+#include <kernel/drivers/zram.hpp>
+#include <kernel/kstd/cstring.hpp>
+#include <kernel/kstd/cmath.hpp>
+#include <kernel/printk.hpp>
+#include <kernel/swap.hpp>
+#include <kernel/slab.hpp>
+#include <kernel/pmm.hpp>
+
+
+namespace kernel {
+namespace driver {
+
+using namespace core::memory;
+
+// pages are stored during reclaim, so it must not be entered again
+inline const gfp_t ZRAM_GFP {GFP::KERNEL | GFP::ATOMIC};
+
+/**
+ * @brief Check whether page consists of single repeated word.
+ *
+ * @param [in] buf - given page sized buffer.
+ * @param [out] value - given repeated word.
+ * @return true - in case of page is same-filled.
+ * @return false - otherwise.
+ */
+static bool page_same_filled(const void *buf, uint32_t& value) noexcept
+{
+    auto words = static_cast<const uint32_t*>(buf);
+
+    for (uint32_t i = 1; i < PAGE_SIZE / sizeof(uint32_t); i++) {
+        if (words[i] != words[0])
+            return false;
+    }
+
+    value = words[0];
+    return true;
+}
+
+/**
+ * @brief Read page from compressed RAM device.
+ *
+ * @param [in] priv - given device.
+ * @param [in] offset - given slot offset.
+ * @param [out] buf - given page sized buffer to fill.
+ * @return true - in case of success.
+ * @return false - in case of corrupted data.
+ */
+static bool zram_swap_read(void *priv, uint32_t offset, void *buf) noexcept
+{
+    return static_cast<zram_t*>(priv)->read(offset, buf);
+}
+
+/**
+ * @brief Write page to compressed RAM device.
+ *
+ * @param [in] priv - given device.
+ * @param [in] offset - given slot offset.
+ * @param [in] buf - given page sized buffer.
+ * @return true - in case of success.
+ * @return false - in case of allocation error.
+ */
+static bool zram_swap_write(void *priv, uint32_t offset, const void *buf) noexcept
+{
+    return static_cast<zram_t*>(priv)->write(offset, buf);
+}
+
+/**
+ * @brief Free page of compressed RAM device.
+ *
+ * @param [in] priv - given device.
+ * @param [in] offset - given slot offset.
+ */
+static void zram_swap_discard(void *priv, uint32_t offset) noexcept
+{
+    static_cast<zram_t*>(priv)->discard(offset);
+}
+
+static const swap_ops_t zram_swap_ops = {
+    .m_read    = zram_swap_read,
+    .m_write   = zram_swap_write,
+    .m_discard = zram_swap_discard
+};
+
+bool zram_t::set(uint32_t pages) noexcept
+{
+    m_table = static_cast<zram_slot_t*>(kmalloc(pages * sizeof(zram_slot_t), GFP::KERNEL));
+
+    if (!m_table)
+        return false;
+
+    kstd::memset(m_table, 0, pages * sizeof(zram_slot_t));
+    kstd::memset(&m_stats, 0, sizeof(m_stats));
+    m_pages = pages;
+    m_pool.init();
+
+    if (!m_huge_pool.create_page_pool(ZRAM_HUGE_RESERVE, 0)) {
+        kfree(m_table);
+        m_table = nullptr;
+        return false;
+    }
+
+    if (!swapon("zram0", &zram_swap_ops, this, pages, ZRAM_PRIO)) {
+        m_huge_pool.destroy();
+        kfree(m_table);
+        m_table = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+bool zram_t::read(uint32_t index, void *buf) noexcept
+{
+    const zram_slot_t& slot = m_table[index];
+
+    if (slot.m_flags & ZRAM::SAME) {
+        auto words = static_cast<uint32_t*>(buf);
+
+        for (uint32_t i = 0; i < PAGE_SIZE / sizeof(uint32_t); i++)
+            words[i] = slot.m_handle;
+
+        return true;
+    }
+
+    if (!slot.m_size) {
+        m_stats.m_failed++;
+        return false;
+    }
+
+    auto data = reinterpret_cast<const void*>(slot.m_handle);
+
+    if (slot.m_flags & ZRAM::HUGE) {
+        kstd::memcpy(buf, data, PAGE_SIZE);
+        return true;
+    }
+
+    auto start = arch::x86::rdtsc();
+    auto size  = kstd::lz4_decompress(data, slot.m_size, buf, PAGE_SIZE);
+
+    m_stats.m_decompr_cycles += arch::x86::rdtsc() - start;
+    m_stats.m_reads++;
+
+    if (size != static_cast<int32_t>(PAGE_SIZE)) {
+        m_stats.m_failed++;
+        return false;
+    }
+
+    return true;
+}
+
+bool zram_t::write(uint32_t index, const void *buf) noexcept
+{
+    discard(index);
+
+    zram_slot_t& slot = m_table[index];
+    uint32_t value;
+
+    // zero pages and the like need no memory at all
+    if (page_same_filled(buf, value)) {
+        slot.m_handle = value;
+        slot.m_flags  = ZRAM::SAME;
+        m_stats.m_same++;
+        m_stats.m_stored++;
+        return true;
+    }
+
+    auto start = arch::x86::rdtsc();
+    auto size  = kstd::lz4_compress(buf, PAGE_SIZE, m_buf, sizeof(m_buf), m_wrkmem);
+
+    m_stats.m_compr_cycles += arch::x86::rdtsc() - start;
+    m_stats.m_writes++;
+
+    // data that does not fit pool object takes a whole page anyway,
+    // reserve lets reclaim make progress when no free page is left
+    if (!size) {
+        void *data = m_huge_pool.alloc(ZRAM_GFP);
+
+        if (!data) {
+            m_stats.m_failed++;
+            return false;
+        }
+
+        kstd::memcpy(data, buf, PAGE_SIZE);
+        slot.m_handle = reinterpret_cast<uint32_t>(data);
+        slot.m_size   = PAGE_SIZE;
+        slot.m_flags  = ZRAM::HUGE;
+        m_stats.m_huge++;
+        m_stats.m_stored++;
+        return true;
+    }
+
+    void *objp = m_pool.alloc(size, ZRAM_GFP);
+
+    if (!objp) {
+        m_stats.m_failed++;
+        return false;
+    }
+
+    kstd::memcpy(objp, m_buf, size);
+    slot.m_handle = reinterpret_cast<uint32_t>(objp);
+    slot.m_size   = size;
+    slot.m_flags  = 0;
+    m_stats.m_compr_bytes += size;
+    m_stats.m_stored++;
+
+    return true;
+}
+
+void zram_t::discard(uint32_t index) noexcept
+{
+    zram_slot_t& slot = m_table[index];
+
+    if (slot.m_flags & ZRAM::SAME)
+        m_stats.m_same--;
+    else if (slot.m_flags & ZRAM::HUGE) {
+        m_huge_pool.free(reinterpret_cast<void*>(slot.m_handle));
+        m_stats.m_huge--;
+    }
+    else if (slot.m_size) {
+        m_pool.free(reinterpret_cast<void*>(slot.m_handle));
+        m_stats.m_compr_bytes -= slot.m_size;
+    }
+    else
+        return;
+
+    slot = {};
+    m_stats.m_stored--;
+}
+
+/**
+ * @brief Display ratio with two decimal places.
+ *
+ * @param [in] name - given ratio name.
+ * @param [in] num - given numerator.
+ * @param [in] den - given denominator.
+ */
+static void print_ratio(const char *name, uint64_t num, uint64_t den) noexcept
+{
+    if (!den) {
+        printk("%s: -\n", name);
+        return;
+    }
+
+    // denominator is scaled down to fit divisor while keeping precision
+    while (den > 0xFFFFFFFF) {
+        num >>= 1;
+        den >>= 1;
+    }
+
+    auto ratio = static_cast<uint32_t>(kstd::div_u64(num * 100, den));
+    printk("%s: %u.%u%u\n", name, ratio / 100, (ratio / 10) % 10, ratio % 10);
+}
+
+void zram_t::stat(void) const noexcept
+{
+    uint32_t compressed = m_stats.m_stored - m_stats.m_same - m_stats.m_huge;
+    uint32_t mem_pages  = m_pool.m_pages + m_stats.m_huge;
+
+    printk("stored:     %u of %u pages (%u same-filled, %u huge, %u from reserve)\n",
+        m_stats.m_stored, m_pages, m_stats.m_same, m_stats.m_huge, m_huge_pool.m_reserve_hits
+    );
+    printk("memory:     %u KB (%u KB compressed data in %u pool pages)\n",
+        (mem_pages * PAGE_SIZE) >> 10, m_stats.m_compr_bytes >> 10, m_pool.m_pages
+    );
+
+    print_ratio("data ratio", uint64_t(compressed) * PAGE_SIZE, m_stats.m_compr_bytes);
+    print_ratio("mem ratio ", uint64_t(m_stats.m_stored) * PAGE_SIZE, uint64_t(mem_pages) * PAGE_SIZE);
+
+    printk("compress:   %u pages, %u cycles/page\n", m_stats.m_writes,
+        m_stats.m_writes ? static_cast<uint32_t>(kstd::div_u64(m_stats.m_compr_cycles, m_stats.m_writes)) : 0
+    );
+    printk("decompress: %u pages, %u cycles/page\n", m_stats.m_reads,
+        m_stats.m_reads ? static_cast<uint32_t>(kstd::div_u64(m_stats.m_decompr_cycles, m_stats.m_reads)) : 0
+    );
+    printk("failed:     %u\n", m_stats.m_failed);
+}
+
+zram_t zram;
+
+} // namespace driver
+} // namespace kernel
@@ -0,0 +1,203 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  acpi.hpp
+ * @brief Contains ACPI tables declaration & MADT parsing.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#ifndef _KERNEL_ARCH_X86_ACPI_HPP_
+#define _KERNEL_ARCH_X86_ACPI_HPP_
+
+#include <kernel/percpu.hpp>
+
+
+namespace kernel {
+namespace arch {
+namespace x86 {
+namespace acpi {
+
+inline const uint32_t MAX_IOAPICS {4};
+inline const uint32_t ISA_IRQS    {16};
+
+/** @brief Root System Description Pointer.*/
+struct rsdp_t
+{
+    char     m_signature[8];    // "RSD PTR "
+    uint8_t  m_checksum;        // sum of the first 20 bytes is zero
+    char     m_oem_id[6];
+    uint8_t  m_revision;        // 0 - ACPI 1.0, 2 - ACPI 2.0+
+    uint32_t m_rsdt_addr;
+    uint32_t m_length;          // ACPI 2.0+ fields
+    uint64_t m_xsdt_addr;
+    uint8_t  m_ext_checksum;
+    uint8_t  m_reserved[3];
+} __attribute__((packed));
+
+/** @brief System Description Table header.*/
+struct sdt_header_t
+{
+    char     m_signature[4];
+    uint32_t m_length;          // table size including header
+    uint8_t  m_revision;
+    uint8_t  m_checksum;        // sum of the whole table is zero
+    char     m_oem_id[6];
+    char     m_oem_table_id[8];
+    uint32_t m_oem_revision;
+    uint32_t m_creator_id;
+    uint32_t m_creator_revision;
+} __attribute__((packed));
+
+/** @brief Multiple APIC Description Table.*/
+struct madt_t
+{
+    sdt_header_t m_header;
+    uint32_t     m_lapic_addr;  // local APIC physical address
+    uint32_t     m_flags;       // MADT_PCAT_COMPAT
+} __attribute__((packed));
+
+inline const uint32_t MADT_PCAT_COMPAT {0x1}; // dual 8259 PIC is installed
+
+// MADT entry types:
+enum MADT : uint8_t {
+    LAPIC          = 0,
+    IOAPIC         = 1,
+    ISO            = 2,     // interrupt source override
+    LAPIC_NMI      = 4,
+    LAPIC_OVERRIDE = 5      // 64-bit local APIC address
+};
+
+/** @brief MADT entry header.*/
+struct madt_entry_t
+{
+    uint8_t m_type;
+    uint8_t m_length;
+} __attribute__((packed));
+
+struct madt_lapic_t
+{
+    madt_entry_t m_entry;
+    uint8_t      m_acpi_id;
+    uint8_t      m_apic_id;
+    uint32_t     m_flags;       // bit 0 - enabled, bit 1 - can be enabled
+} __attribute__((packed));
+
+struct madt_ioapic_t
+{
+    madt_entry_t m_entry;
+    uint8_t      m_id;
+    uint8_t      m_reserved;
+    uint32_t     m_addr;
+    uint32_t     m_gsi_base;    // first global system interrupt of I/O APIC
+} __attribute__((packed));
+
+struct madt_iso_t
+{
+    madt_entry_t m_entry;
+    uint8_t      m_bus;         // always 0 (ISA)
+    uint8_t      m_source;      // ISA IRQ
+    uint32_t     m_gsi;
+    uint16_t     m_flags;       // MPS INTI polarity & trigger mode
+} __attribute__((packed));
+
+struct madt_lapic_override_t
+{
+    madt_entry_t m_entry;
+    uint16_t     m_reserved;
+    uint64_t     m_addr;
+} __attribute__((packed));
+
+// MPS INTI flags:
+inline const uint16_t INTI_POLARITY_MASK {0x3};
+inline const uint16_t INTI_ACTIVE_LOW    {0x3};
+inline const uint16_t INTI_TRIGGER_MASK  {0xC};
+inline const uint16_t INTI_LEVEL         {0xC};
+
+/** @brief Generic Address Structure.*/
+struct gas_t
+{
+    uint8_t  m_space_id;        // GAS_MEMORY or I/O space
+    uint8_t  m_bit_width;
+    uint8_t  m_bit_offset;
+    uint8_t  m_access_size;
+    uint64_t m_addr;
+} __attribute__((packed));
+
+inline const uint8_t GAS_MEMORY {0x0};  // system memory space
+
+/** @brief High Precision Event Timer Description Table.*/
+struct hpet_table_t
+{
+    sdt_header_t m_header;
+    uint32_t     m_block_id;    // copy of capabilities register bits 31:0
+    gas_t        m_base;        // registers address
+    uint8_t      m_number;      // HPET sequence number
+    uint16_t     m_min_tick;    // minimal periodic mode tick
+    uint8_t      m_protection;
+} __attribute__((packed));
+
+/** @brief I/O APIC described by MADT.*/
+struct ioapic_info_t
+{
+    uint8_t  m_id;
+    uint32_t m_addr;            // registers physical address
+    uint32_t m_gsi_base;
+};
+
+/** @brief Interrupt controllers configuration described by MADT.*/
+struct madt_info_t
+{
+    bool          m_present;
+    bool          m_has_pic;                // MADT_PCAT_COMPAT
+    phys_addr_t   m_lapic_addr;
+    uint32_t      m_nr_cpus;                // enabled processors
+    uint8_t       m_apic_ids[NR_CPUS];      // local APIC ID of each CPU
+    uint32_t      m_nr_ioapics;
+    ioapic_info_t m_ioapics[MAX_IOAPICS];
+    uint32_t      m_isa_gsi[ISA_IRQS];      // ISA IRQ to GSI mapping
+    uint16_t      m_isa_flags[ISA_IRQS];    // ISA IRQ polarity & trigger mode
+};
+
+extern madt_info_t madt;
+
+/**
+ * @brief Find ACPI tables & parse MADT.
+ *
+ * @return true - in case of MADT was found.
+ * @return false - in case of ACPI is not supported.
+ */
+bool init(void) noexcept;
+
+/**
+ * @brief Find ACPI table.
+ *
+ * @param [in] signature - given 4 character table signature.
+ * @return table - in case of success.
+ * @return nullptr - in case of table is missing or corrupted.
+ */
+const sdt_header_t *find_table(const char *signature) noexcept;
+
+} // namespace acpi
+} // namespace x86
+} // namespace arch
+} // namespace kernel
+
+#endif // _KERNEL_ARCH_X86_ACPI_HPP_
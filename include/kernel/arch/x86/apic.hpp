@@ -0,0 +1,162 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  apic.hpp
+ * @brief Contains local APIC & I/O APIC declaration.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#ifndef _KERNEL_ARCH_X86_APIC_HPP_
+#define _KERNEL_ARCH_X86_APIC_HPP_
+
+#include <kernel/types.hpp>
+
+
+namespace kernel {
+namespace arch {
+namespace x86 {
+namespace apic {
+
+inline const uint32_t MSR_APIC_BASE    {0x1B};
+inline const uint32_t APIC_BASE_ENABLE {1 << 11};   // local APIC global enable
+
+// local APIC registers offsets:
+inline const uint32_t LAPIC_ID        {0x020};
+inline const uint32_t LAPIC_VERSION   {0x030};
+inline const uint32_t LAPIC_TPR       {0x080};     // task priority
+inline const uint32_t LAPIC_EOI       {0x0B0};
+inline const uint32_t LAPIC_SVR       {0x0F0};     // spurious interrupt vector
+inline const uint32_t LAPIC_LVT_TIMER {0x320};
+inline const uint32_t LAPIC_LVT_LINT0 {0x350};
+inline const uint32_t LAPIC_LVT_LINT1 {0x360};
+inline const uint32_t LAPIC_LVT_ERROR {0x370};
+inline const uint32_t LAPIC_TIMER_ICR {0x380};     // timer initial count
+inline const uint32_t LAPIC_TIMER_CCR {0x390};     // timer current count
+inline const uint32_t LAPIC_TIMER_DCR {0x3E0};     // timer divide configuration
+
+inline const uint32_t SVR_ENABLE      {1 << 8};    // local APIC software enable
+inline const uint32_t LVT_MASKED      {1 << 16};
+inline const uint32_t LVT_NMI         {0x4 << 8};  // NMI delivery mode
+
+// LVT timer modes:
+inline const uint32_t LVT_TIMER_ONESHOT  {0x0 << 17};
+inline const uint32_t LVT_TIMER_PERIODIC {0x1 << 17};
+inline const uint32_t LVT_TIMER_DEADLINE {0x2 << 17};  // interrupt when TSC reaches MSR value
+
+inline const uint32_t TIMER_DIV_16     {0x3};          // timer counts bus clock / 16
+inline const uint32_t MSR_TSC_DEADLINE {0x6E0};
+
+extern volatile uint32_t *lapic;    // local APIC registers (nullptr - APIC is not used)
+
+/**
+ * @brief Read local APIC register.
+ *
+ * @param [in] reg - given register offset.
+ * @return register value.
+ */
+inline uint32_t lapic_read(uint32_t reg) noexcept
+{
+    return lapic[reg >> 2];
+}
+
+/**
+ * @brief Write local APIC register.
+ *
+ * @param [in] reg - given register offset.
+ * @param [in] value - given register value.
+ */
+inline void lapic_write(uint32_t reg, uint32_t value) noexcept
+{
+    lapic[reg >> 2] = value;
+}
+
+/** @brief Signal end of interrupt to local APIC.*/
+inline void lapic_eoi(void) noexcept
+{
+    lapic_write(LAPIC_EOI, 0);
+}
+
+/**
+ * @brief Get local APIC ID of current CPU.
+ *
+ * @return local APIC ID.
+ */
+inline uint8_t lapic_id(void) noexcept
+{
+    return lapic_read(LAPIC_ID) >> 24;
+}
+
+/**
+ * @brief Initialize local APIC of current CPU & I/O APICs described by MADT.
+ *
+ * @details All I/O APIC pins are masked.
+ *
+ * @return true - in case of success.
+ * @return false - in case of APIC is not supported.
+ */
+bool init(void) noexcept;
+
+/**
+ * @brief Get number of interrupt pins of all I/O APICs.
+ *
+ * @return the highest GSI + 1.
+ */
+uint32_t nr_gsis(void) noexcept;
+
+/**
+ * @brief Program I/O APIC redirection entry (masked).
+ *
+ * @param [in] gsi - given global system interrupt.
+ * @param [in] vector - given interrupt vector.
+ * @param [in] inti - given MPS INTI polarity & trigger mode flags.
+ * @param [in] level - given default trigger mode (true - level, active low).
+ * @param [in] dest - given destination local APIC ID.
+ */
+void route(uint32_t gsi, uint8_t vector, uint16_t inti, bool level, uint8_t dest) noexcept;
+
+/**
+ * @brief Disable I/O APIC pin.
+ *
+ * @param [in] gsi - given global system interrupt.
+ */
+void mask(uint32_t gsi) noexcept;
+
+/**
+ * @brief Enable I/O APIC pin.
+ *
+ * @param [in] gsi - given global system interrupt.
+ */
+void unmask(uint32_t gsi) noexcept;
+
+/**
+ * @brief Change destination CPU of I/O APIC pin.
+ *
+ * @param [in] gsi - given global system interrupt.
+ * @param [in] dest - given destination local APIC ID.
+ */
+void set_dest(uint32_t gsi, uint8_t dest) noexcept;
+
+} // namespace apic
+} // namespace x86
+} // namespace arch
+} // namespace kernel
+
+#endif // _KERNEL_ARCH_X86_APIC_HPP_
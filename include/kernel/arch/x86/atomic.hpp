@@ -0,0 +1,125 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  atomic.hpp
+ * @brief Contains atomic operations.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_ARCH_X86_ATOMIC_HPP_
+#define _KERNEL_ARCH_X86_ATOMIC_HPP_
+
+#include <kernel/types.hpp>
+
+
+namespace kernel {
+namespace arch {
+namespace x86 {
+
+/** @brief Prevent compiler from reordering memory accesses.*/
+inline void barrier(void) noexcept
+{
+    __asm__ volatile("" : : : "memory");
+}
+
+/** @brief Spin-wait loop hint.*/
+inline void cpu_relax(void) noexcept
+{
+    __asm__ volatile("pause" : : : "memory");
+}
+
+/**
+ * @brief Atomically exchange value.
+ *
+ * @param [in,out] ptr - given value pointer.
+ * @param [in] value - given new value.
+ * @return old value.
+ */
+inline uint32_t xchg(volatile uint32_t *ptr, uint32_t value) noexcept
+{
+    __asm__ volatile("xchgl %0, %1" : "+r"(value), "+m"(*ptr) : : "memory");
+    return value;
+}
+
+/**
+ * @brief Atomically compare and exchange 32-bit value.
+ *
+ * @param [in,out] ptr - given value pointer.
+ * @param [in] old - given expected value.
+ * @param [in] value - given new value.
+ * @return true - if @a ptr contained @a old and was updated.
+ * @return false - otherwise.
+ */
+inline bool cmpxchg(volatile uint32_t *ptr, uint32_t old, uint32_t value) noexcept
+{
+    bool ret;
+
+    __asm__ volatile(
+        "lock cmpxchgl %3, %1"
+        : "=@ccz"(ret), "+m"(*ptr), "+a"(old)
+        : "r"(value)
+        : "memory"
+    );
+
+    return ret;
+}
+
+/**
+ * @brief Atomically compare and exchange 64-bit value using cmpxchg8b.
+ *
+ * @param [in,out] ptr - given 8-byte aligned value pointer.
+ * @param [in] old - given expected value.
+ * @param [in] value - given new value.
+ * @return true - if @a ptr contained @a old and was updated.
+ * @return false - otherwise.
+ */
+inline bool cmpxchg8b(volatile uint64_t *ptr, uint64_t old, uint64_t value) noexcept
+{
+    bool ret;
+
+    __asm__ volatile(
+        "lock cmpxchg8b %1"
+        : "=@ccz"(ret), "+m"(*ptr), "+A"(old)
+        : "b"(static_cast<uint32_t>(value)), "c"(static_cast<uint32_t>(value >> 0x20))
+        : "memory"
+    );
+
+    return ret;
+}
+
+/**
+ * @brief Atomically add to value.
+ *
+ * @param [in,out] ptr - given value pointer.
+ * @param [in] value - given value to add.
+ * @return old value.
+ */
+inline uint32_t fetch_add(volatile uint32_t *ptr, uint32_t value) noexcept
+{
+    __asm__ volatile("lock xaddl %0, %1" : "+r"(value), "+m"(*ptr) : : "memory");
+    return value;
+}
+
+} // namespace x86
+} // namespace arch
+} // namespace kernel
+
+#endif // _KERNEL_ARCH_X86_ATOMIC_HPP_
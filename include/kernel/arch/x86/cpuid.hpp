@@ -0,0 +1,96 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  cpuid.hpp
+ * @brief Contains CPU identification functions.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_ARCH_X86_CPUID_HPP_
+#define _KERNEL_ARCH_X86_CPUID_HPP_
+
+#include <kernel/types.hpp>
+
+
+namespace kernel {
+namespace arch {
+namespace x86 {
+
+/** @brief CPUID instruction result.*/
+struct cpuid_t
+{
+    uint32_t m_eax;
+    uint32_t m_ebx;
+    uint32_t m_ecx;
+    uint32_t m_edx;
+};
+
+// CPUID leaf 0x1 EDX feature bits:
+inline const uint32_t CPUID_EDX_TSC  {1 << 4};  // Time Stamp Counter
+inline const uint32_t CPUID_EDX_PSE  {1 << 3};  // 4 MB pages
+inline const uint32_t CPUID_EDX_APIC {1 << 9};  // on-chip APIC
+inline const uint32_t CPUID_EDX_PGE  {1 << 13}; // global pages
+
+// CPUID leaf 0x1 ECX feature bits:
+inline const uint32_t CPUID_ECX_TSC_DEADLINE {1 << 24}; // local APIC timer TSC-deadline mode
+
+// CPUID extended leaves:
+inline const uint32_t CPUID_EXT_MAX      {0x80000000}; // highest extended leaf
+inline const uint32_t CPUID_EXT_POWER    {0x80000007}; // advanced power management
+inline const uint32_t CPUID_EDX_INVTSC   {1 << 8};     // TSC rate is invariant in all states
+
+/**
+ * @brief Execute CPUID instruction.
+ *
+ * @param [in] leaf - given CPUID leaf (EAX).
+ * @param [in] subleaf - given CPUID subleaf (ECX).
+ * @return CPUID registers.
+ */
+inline cpuid_t cpuid(uint32_t leaf, uint32_t subleaf = 0) noexcept
+{
+    cpuid_t ret;
+
+    __asm__ volatile(
+        "cpuid"
+        : "=a"(ret.m_eax), "=b"(ret.m_ebx), "=c"(ret.m_ecx), "=d"(ret.m_edx)
+        : "a"(leaf), "c"(subleaf)
+    );
+
+    return ret;
+}
+
+/**
+ * @brief Check CPU feature in CPUID leaf 0x1 EDX.
+ *
+ * @param [in] feature - given feature bit.
+ * @return true - if feature is supported.
+ * @return false - otherwise.
+ */
+inline bool has_feature(uint32_t feature) noexcept
+{
+    return cpuid(0x1).m_edx & feature;
+}
+
+} // namespace x86
+} // namespace arch
+} // namespace kernel
+
+#endif // _KERNEL_ARCH_X86_CPUID_HPP_
@@ -0,0 +1,95 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  idt.hpp
+ * @brief Contains Interrupt Descriptor Table declaration.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_ARCH_X86_IDT_HPP_
+#define _KERNEL_ARCH_X86_IDT_HPP_
+
+#include <kernel/types.hpp>
+
+
+namespace kernel {
+namespace arch {
+namespace x86 {
+namespace idt {
+
+inline const uint32_t ENTRIES    {256};
+inline const uint32_t EXCEPTIONS {32};  // number of CPU exception vectors
+inline const uint8_t  IRQ_BASE   {32};  // vector of IRQ 0
+inline const uint32_t IRQ_LINES  {24};  // number of hardware interrupt vectors
+
+// CPU exception vectors:
+inline const uint8_t VEC_PAGE_FAULT {14};
+
+// local APIC vectors:
+inline const uint8_t VEC_LAPIC_TIMER {0xEF};
+inline const uint8_t VEC_SPURIOUS    {0xFF};   // not acknowledged
+
+/** @brief IDT gate structure in 32-bit mode.*/
+struct gate_t
+{
+    uint16_t m_base_low;    // handler address (low bytes).
+    uint16_t m_selector;    // code segment selector.
+    uint8_t  m_zero;        // unused, always zero.
+    uint8_t  m_flags;       // gate type, privilege level & present bit.
+    uint16_t m_base_high;   // handler address (high bytes).
+} __attribute__((packed));
+
+/** @brief IDT pointer.*/
+struct ptr_t
+{
+   uint16_t m_size;     // IDT size - 1
+   uint32_t m_offset;   // linear address of IDT.
+} __attribute__((packed));
+
+/** @brief Registers saved by interrupt entry code.*/
+struct regs_t
+{
+    uint32_t m_gs, m_fs, m_es, m_ds;                            // pushed by isr_common
+    uint32_t m_edi, m_esi, m_ebp, m_esp, m_ebx, m_edx, m_ecx, m_eax; // pushed by pusha
+    uint32_t m_vector, m_err_code;                              // pushed by ISR stub
+    uint32_t m_eip, m_cs, m_eflags;                             // pushed by CPU
+} __attribute__((packed));
+
+// interrupt handler type
+using handler_t = void (*)(regs_t *regs) noexcept;
+
+/** @brief Initialize Interrupt Descriptor Table.*/
+void init(void) noexcept;
+
+/**
+ * @brief Set interrupt handler.
+ *
+ * @param [in] vector - given interrupt vector.
+ * @param [in] handler - given interrupt handler.
+ */
+void set_handler(uint8_t vector, handler_t handler) noexcept;
+
+} // namespace idt
+} // namespace x86
+} // namespace arch
+} // namespace kernel
+
+#endif // _KERNEL_ARCH_X86_IDT_HPP_
@@ -47,6 +47,41 @@ inline uint8_t inb(uint16_t port) noexcept
     return rv;
 }
 
+/**
+ * @brief Send a byte of data to a specified input/output port.
+ *
+ * @param [in] port - given port to which the data will be written.
+ * @param [in] data - given byte of data.
+ */
+inline void outb(uint16_t port, uint8_t data) noexcept
+{
+    __asm__ volatile("outb %0, %1" : : "a" (data), "dN" (port));
+}
+
+/**
+ * @brief Receive a word of data from a specified input/output port.
+ *
+ * @param [in] port - given port from which the data will be read.
+ * @return the word of data read from the port.
+ */
+inline uint16_t inw(uint16_t port) noexcept
+{
+    uint16_t rv = 0;
+    __asm__ volatile("inw %1, %0" : "=a" (rv) : "dN" (port));
+    return rv;
+}
+
+/**
+ * @brief Send a word of data to a specified input/output port.
+ *
+ * @param [in] port - given port to which the data will be written.
+ * @param [in] data - given word of data.
+ */
+inline void outw(uint16_t port, uint16_t data) noexcept
+{
+    __asm__ volatile("outw %0, %1" : : "a" (data), "dN" (port));
+}
+
 } // namespace x86
 } // namespace arch
 } // namespace kernel
@@ -0,0 +1,94 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  pic.hpp
+ * @brief Contains 8259 Programmable Interrupt Controller declaration.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_ARCH_X86_PIC_HPP_
+#define _KERNEL_ARCH_X86_PIC_HPP_
+
+#include <kernel/types.hpp>
+
+
+namespace kernel {
+namespace arch {
+namespace x86 {
+namespace pic {
+
+inline const uint16_t MASTER_CMD  {0x20};
+inline const uint16_t MASTER_DATA {0x21};
+inline const uint16_t SLAVE_CMD   {0xA0};
+inline const uint16_t SLAVE_DATA  {0xA1};
+
+inline const uint8_t  CASCADE_IRQ {2};  // master line the slave is connected to
+inline const uint8_t  LINES       {16}; // number of IRQ lines of both controllers
+
+/**
+ * @brief Remap both controllers to consecutive vectors & mask all lines.
+ *
+ * @param [in] base - given vector of IRQ 0 (multiple of 8).
+ */
+void init(uint8_t base) noexcept;
+
+/** @brief Mask all lines of both controllers.*/
+void disable(void) noexcept;
+
+/**
+ * @brief Disable IRQ line.
+ *
+ * @param [in] irq - given IRQ line.
+ */
+void mask(uint8_t irq) noexcept;
+
+/**
+ * @brief Enable IRQ line.
+ *
+ * @param [in] irq - given IRQ line.
+ */
+void unmask(uint8_t irq) noexcept;
+
+/**
+ * @brief Send End Of Interrupt command.
+ *
+ * @param [in] irq - given IRQ line.
+ */
+void eoi(uint8_t irq) noexcept;
+
+/**
+ * @brief Check whether interrupt was raised without being in service.
+ *
+ * @details Spurious IRQ 7 & IRQ 15 must not be acknowledged, except the
+ * master cascade line in case of spurious IRQ 15.
+ *
+ * @param [in] irq - given IRQ line.
+ * @return true - in case of spurious interrupt.
+ * @return false - otherwise.
+ */
+bool is_spurious(uint8_t irq) noexcept;
+
+} // namespace pic
+} // namespace x86
+} // namespace arch
+} // namespace kernel
+
+#endif // _KERNEL_ARCH_X86_PIC_HPP_
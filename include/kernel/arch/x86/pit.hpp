@@ -0,0 +1,85 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  pit.hpp
+ * @brief Contains 8253/8254 Programmable Interval Timer functions.
+ *
+ * @details Channel 0 free-runs as fallback clock with its IRQ masked,
+ * channel 2 is gated through port 0x61 to measure TSC frequency.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#ifndef _KERNEL_ARCH_X86_PIT_HPP_
+#define _KERNEL_ARCH_X86_PIT_HPP_
+
+#include <kernel/types.hpp>
+
+
+namespace kernel {
+namespace arch {
+namespace x86 {
+namespace pit {
+
+inline const uint32_t FREQUENCY {1193182};  // input clock (Hz)
+inline const uint32_t IRQ       {0};        // ISA IRQ line of channel 0
+
+/** @brief Start channel 0 counting down from 65536 repeatedly.*/
+void init(void) noexcept;
+
+/**
+ * @brief Raise single IRQ 0 after countdown of channel 0.
+ *
+ * @param [in] ticks - given countdown length in PIT ticks.
+ */
+void set_oneshot(uint16_t ticks) noexcept;
+
+/**
+ * @brief Raise IRQ 0 periodically by channel 0.
+ *
+ * @param [in] ticks - given period in PIT ticks.
+ */
+void set_periodic(uint16_t ticks) noexcept;
+
+/** @brief Stop channel 0 until it is programmed again.*/
+void stop(void) noexcept;
+
+/**
+ * @brief Read channel 0 counter.
+ *
+ * @return number of elapsed PIT ticks modulo 65536.
+ */
+uint16_t read(void) noexcept;
+
+/**
+ * @brief Measure TSC frequency with channel 2 one-shot countdown.
+ *
+ * @param [in] ms - given countdown length in milliseconds (up to 50).
+ * @return TSC frequency in kHz.
+ * @return 0 - if countdown has not finished.
+ */
+uint32_t calibrate_tsc(uint32_t ms) noexcept;
+
+} // namespace pit
+} // namespace x86
+} // namespace arch
+} // namespace kernel
+
+#endif // _KERNEL_ARCH_X86_PIT_HPP_
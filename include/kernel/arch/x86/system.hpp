@@ -29,17 +29,224 @@
 
 #include <kernel/types.hpp>
 
+#ifdef CONFIG_IRQ_TRACE
+#include <kernel/irqtrace.hpp>
+#endif // CONFIG_IRQ_TRACE
+
 
 namespace kernel {
 namespace arch {
 namespace x86 {
 
+inline const uint32_t EFLAGS_IF {1 << 9};   // interrupts are enabled
+inline const uint32_t CR4_PGE   {1 << 7};   // global pages are enabled
+
+/**
+ * @brief Read EFLAGS register.
+ *
+ * @return EFLAGS register value.
+ */
+inline uint32_t read_eflags(void) noexcept
+{
+    uint32_t flags;
+    __asm__ volatile("pushfl\n\tpopl %0" : "=r"(flags) : : "memory");
+    return flags;
+}
+
 /** @brief Halt CPU.*/
 inline void halt(void) noexcept
 {
+    // interrupts would wake CPU up
+    __asm__ volatile("cli");
+
     for (;;) __asm__ volatile("hlt");
 }
 
+/** @brief Enable interrupts.*/
+inline void irq_enable(void) noexcept
+{
+#ifdef CONFIG_IRQ_TRACE
+    if (!(read_eflags() & EFLAGS_IF))
+        core::trace_irqs_on();
+#endif // CONFIG_IRQ_TRACE
+
+    __asm__ volatile("sti" : : : "memory");
+}
+
+/** @brief Disable interrupts.*/
+inline void irq_disable(void) noexcept
+{
+#ifdef CONFIG_IRQ_TRACE
+    bool was_on = read_eflags() & EFLAGS_IF;
+#endif // CONFIG_IRQ_TRACE
+
+    __asm__ volatile("cli" : : : "memory");
+
+#ifdef CONFIG_IRQ_TRACE
+    if (was_on)
+        core::trace_irqs_off();
+#endif // CONFIG_IRQ_TRACE
+}
+
+/**
+ * @brief Enable interrupts and wait for the next one.
+ *
+ * @details Interrupt enabled by STI is recognized only after the next
+ * instruction, so condition checked with interrupts disabled cannot be
+ * changed by handler before CPU is halted.
+ */
+inline void safe_halt(void) noexcept
+{
+#ifdef CONFIG_IRQ_TRACE
+    core::trace_irqs_on();
+#endif // CONFIG_IRQ_TRACE
+
+    __asm__ volatile("sti\n\thlt" : : : "memory");
+}
+
+/**
+ * @brief Save EFLAGS and disable interrupts.
+ *
+ * @return saved EFLAGS register value.
+ */
+inline uint32_t irq_save(void) noexcept
+{
+    uint32_t flags;
+    __asm__ volatile("pushfl\n\tpopl %0\n\tcli" : "=r"(flags) : : "memory");
+
+#ifdef CONFIG_IRQ_TRACE
+    if (flags & EFLAGS_IF)
+        core::trace_irqs_off();
+#endif // CONFIG_IRQ_TRACE
+
+    return flags;
+}
+
+/**
+ * @brief Restore interrupt flag saved by irq_save().
+ *
+ * @param [in] flags - given saved EFLAGS register value.
+ */
+inline void irq_restore(uint32_t flags) noexcept
+{
+#ifdef CONFIG_IRQ_TRACE
+    if ((flags & EFLAGS_IF) && !(read_eflags() & EFLAGS_IF))
+        core::trace_irqs_on();
+#endif // CONFIG_IRQ_TRACE
+
+    __asm__ volatile("pushl %0\n\tpopfl" : : "r"(flags) : "memory", "cc");
+}
+
+/**
+ * @brief Read Model Specific Register.
+ *
+ * @param [in] msr - given register index.
+ * @return register value.
+ */
+inline uint64_t rdmsr(uint32_t msr) noexcept
+{
+    uint32_t low, high;
+    __asm__ volatile("rdmsr" : "=a"(low), "=d"(high) : "c"(msr));
+    return (uint64_t(high) << 32) | low;
+}
+
+/**
+ * @brief Write Model Specific Register.
+ *
+ * @param [in] msr - given register index.
+ * @param [in] value - given register value.
+ */
+inline void wrmsr(uint32_t msr, uint64_t value) noexcept
+{
+    __asm__ volatile("wrmsr" : : "c"(msr), "a"(uint32_t(value)), "d"(uint32_t(value >> 32)) : "memory");
+}
+
+/**
+ * @brief Read CR2 register (page fault linear address).
+ *
+ * @return CR2 register value.
+ */
+inline uint32_t read_cr2(void) noexcept
+{
+    uint32_t ret;
+    __asm__ volatile("mov %%cr2, %0" : "=r"(ret));
+    return ret;
+}
+
+/**
+ * @brief Read CR3 register (page directory base).
+ *
+ * @return CR3 register value.
+ */
+inline uint32_t read_cr3(void) noexcept
+{
+    uint32_t ret;
+    __asm__ volatile("mov %%cr3, %0" : "=r"(ret));
+    return ret;
+}
+
+/**
+ * @brief Write CR3 register (flushes non-global TLB entries).
+ *
+ * @param [in] value - given page directory physical address.
+ */
+inline void write_cr3(uint32_t value) noexcept
+{
+    __asm__ volatile("mov %0, %%cr3" : : "r"(value) : "memory");
+}
+
+/**
+ * @brief Read CR4 register.
+ *
+ * @return CR4 register value.
+ */
+inline uint32_t read_cr4(void) noexcept
+{
+    uint32_t ret;
+    __asm__ volatile("mov %%cr4, %0" : "=r"(ret));
+    return ret;
+}
+
+/**
+ * @brief Write CR4 register.
+ *
+ * @param [in] value - given CR4 register value.
+ */
+inline void write_cr4(uint32_t value) noexcept
+{
+    __asm__ volatile("mov %0, %%cr4" : : "r"(value) : "memory");
+}
+
+/**
+ * @brief Invalidate TLB entry of a single page.
+ *
+ * @param [in] addr - given virtual address.
+ */
+inline void invlpg(uint32_t addr) noexcept
+{
+    __asm__ volatile("invlpg (%0)" : : "r"(addr) : "memory");
+}
+
+/** @brief Invalidate all non-global TLB entries.*/
+inline void flush_tlb(void) noexcept
+{
+    write_cr3(read_cr3());
+}
+
+/** @brief Invalidate all TLB entries including global ones.*/
+inline void flush_tlb_global(void) noexcept
+{
+    uint32_t cr4 = read_cr4();
+
+    // toggling CR4.PGE flushes global entries
+    if (cr4 & CR4_PGE) {
+        write_cr4(cr4 & ~CR4_PGE);
+        write_cr4(cr4);
+    }
+    else
+        flush_tlb();
+}
+
 /**
  * @brief Get current privilege level .
  *
@@ -0,0 +1,70 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  tsc.hpp
+ * @brief Contains Time Stamp Counter functions.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_ARCH_X86_TSC_HPP_
+#define _KERNEL_ARCH_X86_TSC_HPP_
+
+#include <kernel/arch/x86/cpuid.hpp>
+
+
+namespace kernel {
+namespace arch {
+namespace x86 {
+
+/**
+ * @brief Read Time Stamp Counter.
+ *
+ * @return number of CPU cycles since reset.
+ */
+inline uint64_t rdtsc(void) noexcept
+{
+    uint32_t low, high;
+    __asm__ volatile("rdtsc" : "=a"(low), "=d"(high));
+    return (static_cast<uint64_t>(high) << 0x20) | low;
+}
+
+/**
+ * @brief Check whether TSC ticks at constant rate.
+ *
+ * @details Invariant TSC is not stopped in deep C-states & does not
+ * follow P-state frequency changes, so it can be used as clock.
+ *
+ * @return true - if TSC is invariant.
+ * @return false - otherwise.
+ */
+inline bool tsc_invariant(void) noexcept
+{
+    if (cpuid(CPUID_EXT_MAX).m_eax < CPUID_EXT_POWER)
+        return false;
+
+    return cpuid(CPUID_EXT_POWER).m_edx & CPUID_EDX_INVTSC;
+}
+
+} // namespace x86
+} // namespace arch
+} // namespace kernel
+
+#endif // _KERNEL_ARCH_X86_TSC_HPP_
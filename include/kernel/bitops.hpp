@@ -67,6 +67,17 @@ constexpr inline size_t BYTES_TO_BITS(size_t n) noexcept
 template <typename T>
 constexpr inline size_t BITS_PER_TYPE = BYTES_TO_BITS(sizeof(T));
 
+/**
+ * @brief Get integer base-2 logarithm.
+ *
+ * @param [in] n - given value.
+ * @return position of the most significant set bit (0 for @a n = 0).
+ */
+constexpr inline uint32_t ilog2(uint64_t n) noexcept
+{
+    return n ? 63 - __builtin_clzll(n) : 0;
+}
+
 } // namespace kernel
 
 #endif // _KERNEL_BITOPS_HPP_
\ No newline at end of file
@@ -0,0 +1,141 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  clockevent.hpp
+ * @brief Declares devices raising interrupt at programmed time.
+ *
+ * @details Driver converts nanoseconds to its ticks by multiply & shift
+ * and reports each interrupt to the handler of device consumer. Local
+ * APIC timer is preferred, in TSC-deadline mode if supported. PIT is the
+ * fallback, so there is always a tick source.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#ifndef _KERNEL_CLOCKEVENT_HPP_
+#define _KERNEL_CLOCKEVENT_HPP_
+
+#include <kernel/types.hpp>
+
+
+namespace kernel {
+namespace core {
+
+// clockevent features:
+inline const uint32_t CLOCK_EVT_PERIODIC {1 << 0};
+inline const uint32_t CLOCK_EVT_ONESHOT  {1 << 1};
+
+// clockevent ratings:
+inline const uint32_t RATING_EVT_PIT          {20};    // port I/O & 16-bit counter
+inline const uint32_t RATING_EVT_HPET         {50};
+inline const uint32_t RATING_EVT_LAPIC        {100};
+inline const uint32_t RATING_EVT_TSC_DEADLINE {150};   // no calibration & MMIO writes
+
+struct clockevent_t;
+
+// clockevent consumer (called with interrupts disabled)
+using clockevent_handler_t = void (*)(clockevent_t& evt) noexcept;
+
+/** @brief Timer interrupt source.*/
+struct clockevent_t
+{
+    const char   *m_name;
+    uint32_t      m_features;       // CLOCK_EVT_*
+    uint32_t      m_rating;         // higher is preferred
+    uint32_t      m_khz;            // ticks frequency
+    uint32_t      m_min_ticks;      // shortest programmable delta
+    uint32_t      m_max_ticks;      // longest programmable delta
+    uint32_t      m_mult;           // ticks = (ns * m_mult) >> m_shift
+    uint32_t      m_shift;
+    uint64_t      m_min_delta_ns;
+    uint64_t      m_max_delta_ns;
+    uint32_t      m_events;         // interrupts raised
+    clockevent_t *m_next;
+
+    bool (*m_set_next_event)(uint32_t ticks) noexcept;  // false - time has already passed
+    bool (*m_set_periodic)(uint32_t ticks) noexcept;    // optional
+    void (*m_shutdown)(void) noexcept;
+
+    clockevent_handler_t m_handler;  // nullptr - events are only counted
+};
+
+extern clockevent_t *clockevent;        // best rated device
+extern clockevent_t *clockevent_list;   // registered devices
+
+/**
+ * @brief Calibrate local APIC timer against clocksource & register it.
+ *
+ * @details TSC-deadline mode is used instead if TSC is calibrated.
+ * Without local APIC & HPET legacy replacement PIT channel 0 is used.
+ */
+void clockevent_init(void) noexcept;
+
+/**
+ * @brief Add clockevent device & select it if it has higher rating.
+ *
+ * @param [in] evt - given device with name, features, rating, frequency,
+ * ticks limits & operations set.
+ */
+void clockevent_register(clockevent_t& evt) noexcept;
+
+/**
+ * @brief Raise single interrupt after delay.
+ *
+ * @details Delay is clamped to device limits. Delay that has passed
+ * while programming is retried with the shortest one.
+ *
+ * @param [in] evt - given device.
+ * @param [in] delta_ns - given delay in nanoseconds.
+ * @return true - in case of success.
+ * @return false - in case of device has missed the event.
+ */
+bool clockevent_program(clockevent_t& evt, uint64_t delta_ns) noexcept;
+
+/**
+ * @brief Raise interrupts periodically.
+ *
+ * @param [in] evt - given device.
+ * @param [in] period_ns - given period in nanoseconds.
+ * @return true - in case of success.
+ * @return false - in case of periodic mode is not supported.
+ */
+bool clockevent_set_periodic(clockevent_t& evt, uint64_t period_ns) noexcept;
+
+/**
+ * @brief Stop raising interrupts.
+ *
+ * @param [in] evt - given device.
+ */
+void clockevent_shutdown(clockevent_t& evt) noexcept;
+
+/**
+ * @brief Report interrupt of device to its consumer.
+ *
+ * @param [in] evt - given device.
+ */
+void clockevent_handle(clockevent_t& evt) noexcept;
+
+/** @brief Print registered clockevent devices.*/
+void clockevent_info(void) noexcept;
+
+} // namespace core
+} // namespace kernel
+
+#endif // _KERNEL_CLOCKEVENT_HPP_
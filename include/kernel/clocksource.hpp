@@ -0,0 +1,132 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  clocksource.hpp
+ * @brief Declares monotonic clock built on free-running counters.
+ *
+ * @details Each counter is converted to nanoseconds by multiply & shift.
+ * The best rated one is used: invariant TSC, then HPET, then TSC, then PIT.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#ifndef _KERNEL_CLOCKSOURCE_HPP_
+#define _KERNEL_CLOCKSOURCE_HPP_
+
+#include <kernel/kstd/cmath.hpp>
+
+
+namespace kernel {
+namespace core {
+
+inline const uint32_t MSEC_PER_SEC  {1000};
+inline const uint32_t NSEC_PER_USEC {1000};
+inline const uint32_t NSEC_PER_MSEC {1000000};
+inline const uint32_t NSEC_PER_SEC  {1000000000};
+
+inline const uint64_t KTIME_MAX           {~0ULL};  // time that never comes
+inline const uint64_t CLOCKSOURCE_MASK_64 {~0ULL};  // counter never wraps
+
+// clocksource ratings:
+inline const uint32_t RATING_PIT          {110};
+inline const uint32_t RATING_TSC_UNSTABLE {200};    // rate follows P-states
+inline const uint32_t RATING_HPET         {250};
+inline const uint32_t RATING_TSC          {300};
+
+/** @brief Free-running counter.*/
+struct clocksource_t
+{
+    const char    *m_name;
+    uint32_t       m_rating;    // higher is preferred
+    uint32_t       m_khz;       // counter frequency
+    uint64_t       m_mask;      // counter width mask
+    uint32_t       m_mult;      // ns = (cycles * m_mult) >> m_shift
+    uint32_t       m_shift;
+    clocksource_t *m_next;
+
+    uint64_t (*m_read)(void) noexcept;
+};
+
+extern clocksource_t *clocksource;          // current clock
+extern clocksource_t *clocksource_list;     // registered clocksources
+extern uint32_t       tsc_khz;              // calibrated TSC frequency (0 - unknown)
+
+/**
+ * @brief Convert counter cycles to nanoseconds.
+ *
+ * @param [in] cs - given clocksource.
+ * @param [in] cycles - given number of cycles.
+ * @return number of nanoseconds.
+ */
+inline uint64_t clocksource_cyc2ns(const clocksource_t& cs, uint64_t cycles) noexcept
+{
+    return kstd::mul_u64_u32_shr(cycles, cs.m_mult, cs.m_shift);
+}
+
+/**
+ * @brief Select the most precise conversion between frequencies.
+ *
+ * @param [out] mult - given multiplier (fits in 32 bits).
+ * @param [out] shift - given shift (up to 32).
+ * @param [in] from - given source frequency.
+ * @param [in] to - given target frequency.
+ */
+void clocks_calc_mult_shift(uint32_t& mult, uint32_t& shift, uint32_t from, uint32_t to) noexcept;
+
+/**
+ * @brief Calibrate TSC & select best clocksource.
+ *
+ * @details TSC is measured against already registered clocksource
+ * (HPET) if there is one, otherwise against PIT.
+ */
+void clocksource_init(void) noexcept;
+
+/**
+ * @brief Add clocksource & switch to it if it has higher rating.
+ *
+ * @param [in] cs - given clocksource with name, rating, frequency,
+ * mask & read function set.
+ */
+void clocksource_register(clocksource_t& cs) noexcept;
+
+/**
+ * @brief Get time since clocksource initialization.
+ *
+ * @details Counters narrower than 64 bits have to be read at least
+ * once per wrap around (PIT - 55 ms).
+ *
+ * @return number of nanoseconds.
+ */
+uint64_t clock_monotonic_ns(void) noexcept;
+
+/**
+ * @brief Get longest time clocksource may be left unread.
+ *
+ * @return number of nanoseconds (KTIME_MAX - counter never wraps).
+ */
+uint64_t clocksource_max_idle_ns(void) noexcept;
+
+/** @brief Print registered clocksources.*/
+void clocksource_info(void) noexcept;
+
+} // namespace core
+} // namespace kernel
+
+#endif // _KERNEL_CLOCKSOURCE_HPP_
@@ -27,6 +27,7 @@
 #ifndef _KERNEL_DEBUG_HPP_
 #define _KERNEL_DEBUG_HPP_
 
+#include <kernel/kstd/arena.hpp>
 #include <kernel/types.hpp>
 
 
@@ -65,6 +66,94 @@ inline uint32_t ebp(void) noexcept
  */
 void kdump(phys_addr_t addr, size_t size) noexcept;
 
+/**
+ * @brief Stress kmalloc caches and display cycles per operation.
+ *
+ * @details Each pass allocates a batch of objects of every kmalloc
+ * size class and frees them in reverse and interleaved order, so both
+ * lock-free and slow paths are exercised. Runs on the bootstrap CPU,
+ * application processors are not brought up.
+ *
+ * @param [in] arena - given arena for object table.
+ */
+void slab_bench(kstd::arena_t& arena) noexcept;
+
+/**
+ * @brief Touch lazily mapped areas and display page fault counters.
+ *
+ * @details Sequential reads of a file mapping are repeated with cold
+ * page cache, with fault-around disabled and enabled to show how many
+ * faults fault-around saves.
+ */
+void fault_bench(void) noexcept;
+
+/**
+ * @brief Duplicate address space and display copy-on-write cost.
+ *
+ * @details Child address space writes to a fraction of shared pages,
+ * so only these pages are copied. Writes of parent have to stay out of
+ * child private pages and be seen in its shared anonymous pages.
+ */
+void cow_bench(void) noexcept;
+
+/**
+ * @brief Create many small areas and display area lookup cost.
+ *
+ * @details Neighbouring areas have different flags, so they are not
+ * merged and lookups have to walk the areas tree.
+ */
+void vma_bench(void) noexcept;
+
+/**
+ * @brief Swap out anonymous area and display swap-in cost.
+ *
+ * @details Area is written, reclaimed entirely and read back
+ * sequentially, so most pages come from swap cache filled by readahead.
+ */
+void swap_bench(void) noexcept;
+
+/**
+ * @brief Merge mergeable area of few distinct pages and display scan cost.
+ *
+ * @details Area pages are merged by scanner and then written again,
+ * so every shared frame is copied back on write.
+ */
+void ksm_bench(void) noexcept;
+
+/**
+ * @brief Read each clocksource and display cost & clockevent accuracy.
+ *
+ * @details One-shot & periodic events of the best clockevent device
+ * are measured with monotonic clock.
+ */
+void clock_bench(void) noexcept;
+
+/**
+ * @brief Add & cancel many timeouts and display cost & expiry batching.
+ *
+ * @details The same timeouts are run without & with slack, so number
+ * of batches shows how many wakeups coalescing saves.
+ *
+ * @param [in] arena - given arena for timeouts.
+ */
+void timer_bench(kstd::arena_t& arena) noexcept;
+
+/**
+ * @brief Run periodic & one-shot hrtimers and display expiry latency.
+ *
+ * @details Periods are far shorter than tick, so they show precision
+ * timer wheel cannot provide.
+ */
+void hrtimer_bench(void) noexcept;
+
+/**
+ * @brief Measure context switch cost & share CPU with busy thread.
+ *
+ * @details Two tasks yielding to each other show cost of voluntary
+ * switch, two spinning tasks show tick-driven preemption.
+ */
+void sched_bench(void) noexcept;
+
 } // namespace debug
 } // namespace kernel
 
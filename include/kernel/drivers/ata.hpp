@@ -0,0 +1,117 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  ata.hpp
+ * @brief Contains ATA PIO disk driver declaration.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_DRIVER_ATA_HPP_
+#define _KERNEL_DRIVER_ATA_HPP_
+
+#include <kernel/types.hpp>
+
+
+namespace kernel {
+namespace driver {
+
+inline const uint32_t ATA_SECTOR_SIZE {512};
+
+/** @brief Statistics of disk transfers.*/
+struct ata_stats_t
+{
+    uint32_t m_reads;   // read commands
+    uint32_t m_writes;  // write commands
+    uint32_t m_sectors; // transferred sectors
+    uint32_t m_errors;  // failed commands
+};
+
+/** @brief Disk on the legacy IDE controller polled in PIO mode.*/
+struct ata_t
+{
+    uint16_t    m_base;     // command block I/O ports base
+    uint16_t    m_ctrl;     // control block I/O port
+    bool        m_slave;    // drive select
+    bool        m_present;  // disk responded to IDENTIFY
+    uint32_t    m_sectors;  // number of LBA28 addressable sectors
+    ata_stats_t m_stats;
+
+private:
+    /**
+     * @brief Wait until disk is not busy.
+     *
+     * @param [in] drq - given flag to also wait for data request.
+     * @return true - in case of success.
+     * @return false - in case of disk error or timeout.
+     */
+    bool wait(bool drq) const noexcept;
+
+    /**
+     * @brief Select drive & issue command for sector range.
+     *
+     * @param [in] lba - given first sector.
+     * @param [in] count - given number of sectors.
+     * @param [in] cmd - given command.
+     */
+    void command(uint32_t lba, uint8_t count, uint8_t cmd) const noexcept;
+
+public:
+    /**
+     * @brief Detect disk on controller.
+     *
+     * @param [in] base - given command block I/O ports base.
+     * @param [in] ctrl - given control block I/O port.
+     * @param [in] slave - given drive select.
+     * @return true - in case of ATA disk is present.
+     * @return false - otherwise.
+     */
+    bool set(uint16_t base, uint16_t ctrl, bool slave) noexcept;
+
+    /**
+     * @brief Read sectors.
+     *
+     * @param [in] lba - given first sector.
+     * @param [in] count - given number of sectors (1-255).
+     * @param [out] buf - given buffer of count sectors.
+     * @return true - in case of success.
+     * @return false - in case of I/O error.
+     */
+    bool read(uint32_t lba, uint8_t count, void *buf) noexcept;
+
+    /**
+     * @brief Write sectors.
+     *
+     * @param [in] lba - given first sector.
+     * @param [in] count - given number of sectors (1-255).
+     * @param [in] buf - given buffer of count sectors.
+     * @return true - in case of success.
+     * @return false - in case of I/O error.
+     */
+    bool write(uint32_t lba, uint8_t count, const void *buf) noexcept;
+};
+
+// primary master disk
+extern ata_t ata;
+
+} // namespace driver
+} // namespace kernel
+
+#endif // _KERNEL_DRIVER_ATA_HPP_
@@ -0,0 +1,122 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  hpet.hpp
+ * @brief Contains High Precision Event Timer driver declarations.
+ *
+ * @details Main counter is registered as clocksource. Timer 0 in legacy
+ * replacement mode raises IRQ 0 & is registered as clockevent device.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#ifndef _KERNEL_DRIVER_HPET_HPP_
+#define _KERNEL_DRIVER_HPET_HPP_
+
+#include <kernel/types.hpp>
+
+
+namespace kernel {
+namespace driver {
+
+/** @brief HPET block described by ACPI HPET table.*/
+struct hpet_t
+{
+    volatile uint32_t *m_regs;      // registers mapped by ioremap
+    uint32_t           m_period;    // main counter period (fs)
+    uint32_t           m_khz;       // main counter frequency
+    uint32_t           m_nr_timers; // number of comparators
+    bool               m_wide;      // 64-bit main counter
+    bool               m_legacy;    // timer 0 is routed to IRQ 0
+
+private:
+    /**
+     * @brief Read 32-bit register.
+     *
+     * @param [in] reg - given register offset.
+     * @return register value.
+     */
+    uint32_t reg_read(uint32_t reg) const noexcept;
+
+    /**
+     * @brief Write 32-bit register.
+     *
+     * @param [in] reg - given register offset.
+     * @param [in] value - given register value.
+     */
+    void reg_write(uint32_t reg, uint32_t value) noexcept;
+
+public:
+    /**
+     * @brief Find HPET, start main counter & register clock devices.
+     *
+     * @return true - in case of success.
+     * @return false - in case of HPET is missing.
+     */
+    bool set(void) noexcept;
+
+    /**
+     * @brief Read main counter.
+     *
+     * @return number of ticks since HPET initialization.
+     */
+    uint64_t read(void) const noexcept;
+
+    /**
+     * @brief Read the lower half of main counter.
+     *
+     * @return number of ticks modulo 2^32.
+     */
+    uint32_t read_low(void) const noexcept;
+
+    /**
+     * @brief Raise single interrupt of comparator.
+     *
+     * @param [in] timer - given comparator.
+     * @param [in] ticks - given delay in main counter ticks (up to 2^31).
+     * @return true - in case of success.
+     * @return false - in case of counter has passed comparator value.
+     */
+    bool set_oneshot(uint32_t timer, uint32_t ticks) noexcept;
+
+    /**
+     * @brief Raise interrupts of comparator periodically.
+     *
+     * @param [in] timer - given comparator.
+     * @param [in] ticks - given period in main counter ticks.
+     * @return true - in case of success.
+     * @return false - in case of periodic mode is not supported by comparator.
+     */
+    bool set_periodic(uint32_t timer, uint32_t ticks) noexcept;
+
+    /**
+     * @brief Disable interrupts of comparator.
+     *
+     * @param [in] timer - given comparator.
+     */
+    void stop(uint32_t timer) noexcept;
+};
+
+extern hpet_t hpet;
+
+} // namespace driver
+} // namespace kernel
+
+#endif // _KERNEL_DRIVER_HPET_HPP_
@@ -27,12 +27,15 @@
 #ifndef _KERNEL_DRIVER_KEYBOARD_HPP_
 #define _KERNEL_DRIVER_KEYBOARD_HPP_
 
-#include <kernel/types.hpp>
+#include <kernel/kstd/ring.hpp>
+#include <kernel/sched.hpp>
 
 
 namespace kernel {
 namespace driver {
 
+inline const uint32_t KEYBOARD_BUFFER_SIZE {128}; // buffered scan codes (power of two)
+
 /** @brief Keyboard special keys enumeration.*/
 enum class key : uint8_t {
     esc         = 0x01,
@@ -42,34 +45,52 @@ enum class key : uint8_t {
     lctrl       = 0x1D,
     lshft       = 0x2A,
     backslash   = 0x2B,
+    slash       = 0x35,
+    rshft       = 0x36,
     lalt        = 0x38,
     space       = 0x39,
     caps_lock   = 0x3A,
     left_arrow  = 0x4B,
     right_arrow = 0x4D,
     up_arrow    = 0x48,
-    down_arrow  = 0x50
+    down_arrow  = 0x50,
+    extended    = 0xE0  // prefix of the next scan code
 };
 
 struct keyboard_t
 {
 private:
-    mutable bool m_is_caps;
-    mutable bool m_is_caps_lock;
+    kstd::ring_t<uint8_t, KEYBOARD_BUFFER_SIZE> m_codes; // scan codes pushed by IRQ handler
+    bool m_is_caps;
+    bool m_is_caps_lock;
+    bool m_is_extended;                                 // previous scan code was prefix
+    core::task_t *m_reader;                             // task sleeping until scan code arrives
 
     /** @brief Keyboard wait for user to press a key.*/
-    inline void wait(void) const noexcept;
+    inline void wait(void) noexcept;
+
+    /**
+     * @brief Convert scan code to character.
+     *
+     * @param [in] code - given scan code.
+     * @return character - in case of printable key press.
+     * @return 0 - in case of key release, modifier or special key.
+     */
+    uint8_t decode(uint8_t code) noexcept;
 
 public:
     /** @brief Initialize keyboard.*/
     void set(void) noexcept;
 
+    /** @brief Buffer scan code received from controller (IRQ context).*/
+    void receive(void) noexcept;
+
     /**
      * @brief Keyboard get character on key press.
      *
      * @return Character read from the keyboard.
      */
-    uint8_t getchar(void) const noexcept;
+    uint8_t getchar(void) noexcept;
 };
 
 extern keyboard_t keyboard;
@@ -0,0 +1,126 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  zram.hpp
+ * @brief Contains compressed RAM swap device declaration.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_DRIVER_ZRAM_HPP_
+#define _KERNEL_DRIVER_ZRAM_HPP_
+
+#include <kernel/kstd/lz4.hpp>
+#include <kernel/zsmalloc.hpp>
+#include <kernel/mempool.hpp>
+
+
+namespace kernel {
+namespace driver {
+
+inline const uint32_t ZRAM_PAGES        {16384};   // 64 MB of swapped pages
+inline const int32_t  ZRAM_PRIO         {100};     // preferred over disk swap
+inline const uint32_t ZRAM_HUGE_RESERVE {16};      // reserved pages for incompressible data
+
+// zram slot flags enumeration
+enum ZRAM : uint8_t {
+    SAME = 0b01,    // page is filled with single word value
+    HUGE = 0b10     // page is incompressible & stored as is
+};
+
+/** @brief Stored page.*/
+struct zram_slot_t
+{
+    uint32_t m_handle;  // compressed object, page address or fill value
+    uint16_t m_size;    // stored data size (0 - empty slot)
+    uint8_t  m_flags;   // ZRAM flags
+};
+
+/** @brief Compressed RAM device counters.*/
+struct zram_stats_t
+{
+    uint32_t m_stored;          // stored pages
+    uint32_t m_same;            // same-filled pages stored as single value
+    uint32_t m_huge;            // incompressible pages
+    uint32_t m_compr_bytes;     // compressed data size of the rest of pages
+    uint32_t m_writes;          // compressed pages
+    uint32_t m_reads;           // decompressed pages
+    uint32_t m_failed;          // writes without memory & reads of corrupted data
+    uint64_t m_compr_cycles;    // cycles spent in compression
+    uint64_t m_decompr_cycles;  // cycles spent in decompression
+};
+
+/** @brief Swap device keeping pages LZ4-compressed in memory.*/
+struct zram_t
+{
+    zram_slot_t               *m_table;   // stored pages indexed by slot
+    uint32_t                   m_pages;   // device size in pages
+    core::memory::zs_pool_t    m_pool;    // compressed data
+    core::memory::mempool_t    m_huge_pool; // incompressible data pages
+    zram_stats_t               m_stats;
+    uint8_t m_wrkmem[kstd::LZ4_WORKMEM];  // compressor hash table
+    uint8_t m_buf[core::memory::ZS_MAX_ALLOC]; // compressor output
+
+    /**
+     * @brief Create device and add it as swap device.
+     *
+     * @param [in] pages - given device size in pages.
+     * @return true - in case of success.
+     * @return false - in case of allocation error.
+     */
+    bool set(uint32_t pages) noexcept;
+
+    /**
+     * @brief Read page.
+     *
+     * @param [in] index - given slot.
+     * @param [out] buf - given page sized buffer to fill.
+     * @return true - in case of success.
+     * @return false - in case of empty slot or corrupted data.
+     */
+    bool read(uint32_t index, void *buf) noexcept;
+
+    /**
+     * @brief Compress & store page.
+     *
+     * @param [in] index - given slot.
+     * @param [in] buf - given page sized buffer.
+     * @return true - in case of success.
+     * @return false - in case of allocation error.
+     */
+    bool write(uint32_t index, const void *buf) noexcept;
+
+    /**
+     * @brief Free stored page.
+     *
+     * @param [in] index - given slot.
+     */
+    void discard(uint32_t index) noexcept;
+
+    /** @brief Display device counters.*/
+    void stat(void) const noexcept;
+};
+
+extern zram_t zram;
+
+} // namespace driver
+} // namespace kernel
+
+#endif // _KERNEL_DRIVER_ZRAM_HPP_
@@ -37,7 +37,8 @@ using gfp_t = uint8_t;
 
 enum GFP : gfp_t {
     KERNEL = 0b00000001,    // for kernel-internal allocation
-    ZERO   = 0b00000010     // set allocated pages payload with zeros
+    ZERO   = 0b00000010,    // set allocated pages payload with zeros
+    ATOMIC = 0b00000100     // caller cannot wait (no reclaim detour)
 };
 
 } // namespace kernel
@@ -0,0 +1,178 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  hrtimer.hpp
+ * @brief Declares per-CPU high-resolution timers.
+ *
+ * @details Timers are kept in red-black tree ordered by expiry in
+ * nanoseconds of monotonic clock, with cached leftmost node. Clockevent
+ * device is programmed for the earliest timer only, so expiry is not
+ * rounded to jiffies. Timer functions run in interrupt context and may
+ * forward timer & restart it. Periodic tick is one of these timers.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#ifndef _KERNEL_HRTIMER_HPP_
+#define _KERNEL_HRTIMER_HPP_
+
+#include <kernel/kstd/rbtree.hpp>
+#include <kernel/clockevent.hpp>
+#include <kernel/percpu.hpp>
+
+
+namespace kernel {
+namespace core {
+
+// hrtimer expiry mode
+enum class hrtimer_mode : uint8_t {
+    ABS,    // expiry is monotonic time
+    REL     // expiry is relative to current time
+};
+
+// hrtimer function result
+enum class hrtimer_restart : uint8_t {
+    NORESTART,  // timer is done
+    RESTART     // timer is queued again with forwarded expiry
+};
+
+// hrtimer states
+inline const uint8_t HRTIMER_INACTIVE {0};
+inline const uint8_t HRTIMER_ENQUEUED {1 << 0};
+inline const uint8_t HRTIMER_CALLBACK {1 << 1};  // function is running
+
+/** @brief High-resolution timer.*/
+struct hrtimer_t
+{
+    kstd::rb_node_t   m_node;
+    uint64_t          m_expires;    // monotonic time (ns)
+    uint32_t          m_cpu;        // base timer is queued on
+    uint8_t           m_state;      // HRTIMER_*
+    hrtimer_restart (*m_func)(hrtimer_t *timer) noexcept;
+};
+
+/** @brief Per-CPU queue of high-resolution timers.*/
+struct hrtimer_base_t
+{
+    kstd::rb_root_cached_t m_active;        // timers ordered by expiry
+    uint64_t               m_next_event;    // expiry device is programmed for (KTIME_MAX - none)
+    bool                   m_in_interrupt;  // expired timers are being run
+};
+
+struct hrtimer_stats_t
+{
+    uint32_t m_started;     // timers queued
+    uint32_t m_cancelled;   // timers removed before expiry
+    uint32_t m_expired;     // timer functions called
+    uint32_t m_interrupts;  // clockevent interrupts handled
+    uint32_t m_reprograms;  // clockevent programmings
+    uint64_t m_max_late;    // the longest delay of timer function (ns)
+};
+
+extern percpu_t<hrtimer_stats_t> hrtimer_stats;
+
+/**
+ * @brief Check whether timer is queued or its function is running.
+ *
+ * @param [in] timer - given timer.
+ * @return true - if timer is active.
+ * @return false - otherwise.
+ */
+inline bool hrtimer_active(const hrtimer_t *timer) noexcept
+{
+    return timer->m_state != HRTIMER_INACTIVE;
+}
+
+/**
+ * @brief Take over clockevent device.
+ *
+ * @return true - in case of success.
+ * @return false - in case of there is no clockevent device.
+ */
+bool hrtimers_init(void) noexcept;
+
+/**
+ * @brief Initialize timer.
+ *
+ * @param [out] timer - given timer.
+ * @param [in] func - given function called with interrupts disabled on expiry.
+ */
+void hrtimer_init(hrtimer_t *timer, hrtimer_restart (*func)(hrtimer_t *timer) noexcept) noexcept;
+
+/**
+ * @brief Queue timer or change its expiry.
+ *
+ * @details Timer is moved to current CPU. When called from timer
+ * function of the same timer, it is restarted whatever function returns.
+ *
+ * @param [in] timer - given initialized timer.
+ * @param [in] time - given expiry (ns).
+ * @param [in] mode - given expiry mode.
+ * @return true - if timer was queued.
+ * @return false - otherwise.
+ */
+bool hrtimer_start(hrtimer_t *timer, uint64_t time, hrtimer_mode mode) noexcept;
+
+/**
+ * @brief Cancel timer.
+ *
+ * @details Timer function that is running is not waited for.
+ *
+ * @param [in] timer - given timer.
+ * @return true - if timer was queued.
+ * @return false - otherwise.
+ */
+bool hrtimer_cancel(hrtimer_t *timer) noexcept;
+
+/**
+ * @brief Move expiry forward by whole periods past given time.
+ *
+ * @details Used by timer functions to restart periodic timers without
+ * accumulating drift.
+ *
+ * @param [in] timer - given timer that is not queued.
+ * @param [in] now - given current time.
+ * @param [in] interval - given period (ns).
+ * @return number of periods expiry was moved by (0 - not expired yet).
+ */
+uint32_t hrtimer_forward(hrtimer_t *timer, uint64_t now, uint64_t interval) noexcept;
+
+/**
+ * @brief Get time left until timer expires.
+ *
+ * @param [in] timer - given timer.
+ * @return remaining time (ns, 0 - expired).
+ */
+uint64_t hrtimer_get_remaining(const hrtimer_t *timer) noexcept;
+
+/**
+ * @brief Run expired timers & program device for the next one.
+ *
+ * @param [in] evt - given clockevent device.
+ */
+void hrtimer_interrupt(clockevent_t& evt) noexcept;
+
+/** @brief Display high-resolution timer counters.*/
+void hrtimerstat(void) noexcept;
+
+} // namespace core
+} // namespace kernel
+
+#endif // _KERNEL_HRTIMER_HPP_
@@ -0,0 +1,118 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  irq.hpp
+ * @brief Declares hardware interrupt dispatch layer.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_IRQ_HPP_
+#define _KERNEL_IRQ_HPP_
+
+#include <kernel/arch/x86/idt.hpp>
+#include <kernel/percpu.hpp>
+
+
+namespace kernel {
+namespace core {
+
+inline const uint32_t NR_IRQS {arch::x86::idt::IRQ_LINES};
+
+// interrupt handler type (called with interrupts disabled)
+using irq_handler_t = void (*)(uint32_t irq, void *dev) noexcept;
+
+/** @brief Interrupt controller operations.*/
+struct irq_chip_t
+{
+    const char *m_name;
+    uint32_t    m_nr_irqs;  // number of supported lines
+
+    void (*m_mask)(uint32_t irq) noexcept;
+    void (*m_unmask)(uint32_t irq) noexcept;
+    void (*m_eoi)(uint32_t irq) noexcept;
+    bool (*m_is_spurious)(uint32_t irq) noexcept;               // optional
+    bool (*m_set_affinity)(uint32_t irq, uint32_t cpu) noexcept; // optional
+};
+
+/** @brief IRQ line descriptor.*/
+struct irq_desc_t
+{
+    irq_handler_t      m_handler;   // nullptr - line is free
+    void              *m_dev;       // device passed to handler
+    const char        *m_name;      // device name
+    uint32_t           m_cpu;       // CPU the line is routed to
+    percpu_t<uint32_t> m_count;     // interrupts handled by each CPU
+};
+
+struct irq_stats_t
+{
+    uint32_t m_spurious;    // interrupts raised without being in service
+    uint32_t m_unhandled;   // interrupts of lines without handler
+};
+
+extern irq_desc_t        irq_desc[NR_IRQS];
+extern irq_stats_t       irq_stats;
+extern const irq_chip_t *irq_chip;  // active interrupt controller
+
+/**
+ * @brief Initialize interrupt controller & dispatch of IRQ vectors.
+ *
+ * @details I/O APIC described by ACPI MADT is preferred, 8259 PIC
+ * is used in case of APIC or ACPI is not available.
+ */
+void irq_init(void) noexcept;
+
+/**
+ * @brief Register IRQ line handler and enable line.
+ *
+ * @param [in] irq - given IRQ line.
+ * @param [in] handler - given interrupt handler.
+ * @param [in] name - given device name.
+ * @param [in] dev - given device passed to handler.
+ * @return true - in case of success.
+ * @return false - in case of invalid or already requested line.
+ */
+bool request_irq(uint32_t irq, irq_handler_t handler, const char *name, void *dev) noexcept;
+
+/**
+ * @brief Disable IRQ line and remove its handler.
+ *
+ * @param [in] irq - given IRQ line.
+ */
+void free_irq(uint32_t irq) noexcept;
+
+/**
+ * @brief Route IRQ line to CPU.
+ *
+ * @param [in] irq - given IRQ line.
+ * @param [in] cpu - given CPU number.
+ * @return true - in case of success.
+ * @return false - in case of invalid line or CPU, or controller cannot route lines.
+ */
+bool irq_set_affinity(uint32_t irq, uint32_t cpu) noexcept;
+
+/** @brief Display interrupt counters.*/
+void irqstat(void) noexcept;
+
+} // namespace core
+} // namespace kernel
+
+#endif // _KERNEL_IRQ_HPP_
@@ -0,0 +1,88 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  irqtrace.hpp
+ * @brief Declares interrupt handler time & interrupts-off section tracing.
+ *
+ * @details Enabled by CONFIG_IRQ_TRACE. Otherwise hooks are not compiled
+ * into interrupt entry & interrupt flag helpers at all.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#ifndef _KERNEL_IRQTRACE_HPP_
+#define _KERNEL_IRQTRACE_HPP_
+
+#include <kernel/types.hpp>
+
+
+namespace kernel {
+namespace core {
+
+#ifdef CONFIG_IRQ_TRACE
+inline const uint32_t IRQ_TRACE_VECTORS {256};  // all IDT vectors (LAPIC & I/O APIC included)
+inline const uint32_t IRQ_TRACE_BUCKETS {24};   // log2(cycles) histogram buckets
+
+/** @brief Handler time statistics of interrupt vector.*/
+struct irq_trace_t
+{
+    uint32_t m_count;
+    uint32_t m_max;                         // the longest run in cycles
+    uint64_t m_total;                       // cycles spent in handler
+    uint32_t m_hist[IRQ_TRACE_BUCKETS];     // handler time histogram
+};
+
+/** @brief Interrupts-off section tracker of CPU.*/
+struct irqsoff_trace_t
+{
+    uint64_t m_start;       // timestamp of current section start
+    uint32_t m_start_ip;    // current section start address
+    bool     m_off;         // interrupts are disabled
+    uint32_t m_max;         // the longest section in cycles
+    uint32_t m_max_start;   // address the longest section started at
+    uint32_t m_max_end;     // address the longest section ended at
+};
+
+/** @brief Start interrupts-off section (interrupts disabled).*/
+void trace_irqs_off(void) noexcept;
+
+/** @brief End interrupts-off section (before interrupts are enabled).*/
+void trace_irqs_on(void) noexcept;
+
+/**
+ * @brief Account interrupt handler run.
+ *
+ * @param [in] vector - given interrupt vector.
+ * @param [in] cycles - given handler run time.
+ */
+void trace_irq_vector(uint32_t vector, uint64_t cycles) noexcept;
+#endif // CONFIG_IRQ_TRACE
+
+/**
+ * @brief Display handler times & the longest interrupts-off section.
+ *
+ * @param [in] reset - given flag to clear statistics afterwards.
+ */
+void irqtrace(bool reset) noexcept;
+
+} // namespace core
+} // namespace kernel
+
+#endif // _KERNEL_IRQTRACE_HPP_
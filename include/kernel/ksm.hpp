@@ -0,0 +1,141 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  ksm.hpp
+ * @brief Declares same-page merging of anonymous memory.
+ *
+ * @details Scanner walks mergeable areas of registered address spaces
+ * and looks up every page by contents hash in two trees. Stable tree
+ * holds write-protected frames that are already shared. Unstable tree
+ * holds pages seen unchanged during the current full scan; it is rebuilt
+ * after each full scan, since its pages may be written at any time. On
+ * hash match contents are compared in full and the page is replaced by
+ * the shared frame, which is copied on the next write.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_KSM_HPP_
+#define _KERNEL_KSM_HPP_
+
+#include <kernel/kstd/rbtree.hpp>
+#include <kernel/mm_types.hpp>
+
+
+namespace kernel {
+namespace core {
+namespace memory {
+
+inline const uint32_t KSM_SLEEP_MS {20};   // ksmd sleep between scanner runs
+
+struct ksm_mm_t;
+
+/** @brief Shared write-protected frame.*/
+struct ksm_stable_t
+{
+    kstd::rb_node_t m_rb;           // stable tree node ordered by checksum
+    page_t         *m_page;         // frame referenced by the tree
+    uint32_t        m_checksum;     // frame contents hash
+    uint32_t        m_rmap_count;   // number of merged addresses
+};
+
+/** @brief Scanned address of anonymous page.*/
+struct ksm_item_t
+{
+    ksm_item_t     *m_next;         // next scanned address of address space
+    ksm_mm_t       *m_slot;         // address space
+    uint32_t        m_addr;         // page address
+    uint32_t        m_checksum;     // contents hash at the last scan
+    uint32_t        m_seqnr;        // full scan the item was added to unstable tree during
+    bool            m_unstable;     // item is in unstable tree of scan m_seqnr
+    ksm_stable_t   *m_stable;       // frame the address is merged into (nullptr - not merged)
+    kstd::rb_node_t m_rb;           // unstable tree node ordered by checksum
+};
+
+/** @brief Address space registered for merging.*/
+struct ksm_mm_t
+{
+    mm_t       *m_mm;
+    ksm_mm_t   *m_next;     // next registered address space
+    ksm_item_t *m_items;    // scanned addresses in address order
+};
+
+/** @brief Same-page merging counters.*/
+struct ksm_stats_t
+{
+    uint32_t m_pages_shared;    // frames in stable tree
+    uint32_t m_pages_sharing;   // additional addresses mapping them (saved pages)
+    uint32_t m_pages_unshared;  // unique pages in unstable tree
+    uint32_t m_pages_volatile;  // pages skipped since they changed after the last scan
+    uint32_t m_scanned;         // scanned pages
+    uint32_t m_merged;          // pages freed by merging
+    uint32_t m_full_scans;      // completed passes over all registered address spaces
+};
+
+extern bool        ksm_run;             // scanner is enabled
+extern uint32_t    ksm_pages_to_scan;   // pages scanned per scanner run
+extern ksm_stats_t ksm_stats;
+
+/**
+ * @brief Register address space for merging.
+ *
+ * @param [in] mm - given address space.
+ * @return true - in case of success.
+ * @return false - in case of allocation error.
+ */
+bool ksm_enter(mm_t *mm) noexcept;
+
+/**
+ * @brief Unregister address space dropping its merging state.
+ *
+ * @param [in] mm - given address space.
+ */
+void ksm_exit(mm_t *mm) noexcept;
+
+/**
+ * @brief Scan pages of registered address spaces.
+ *
+ * @param [in] nr_pages - given number of pages to scan.
+ */
+void ksm_scan(uint32_t nr_pages) noexcept;
+
+/**
+ * @brief Start ksmd thread scanning ksm_pages_to_scan pages per run.
+ *
+ * @return true - in case of success.
+ * @return false - in case of allocation error.
+ */
+bool ksm_init(void) noexcept;
+
+/**
+ * @brief Enable or disable scanner.
+ *
+ * @param [in] run - given flag whether ksmd has to scan.
+ */
+void ksm_set_run(bool run) noexcept;
+
+/** @brief Display same-page merging counters.*/
+void ksmstat(void) noexcept;
+
+} // namespace memory
+} // namespace core
+} // namespace kernel
+
+#endif // _KERNEL_KSM_HPP_
@@ -0,0 +1,115 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  arena.hpp
+ * @brief Declares arena (region) allocator.
+ *
+ * @details Arena bump-allocates memory from a chain of page chunks taken
+ * from the physical memory manager. Objects are never freed one by one:
+ * the arena is either rewound to a previously taken mark or released
+ * entirely, which makes it suitable for allocations with a clear common
+ * lifetime (boot-time setup, a single shell command etc.).
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_KSTD_ARENA_HPP_
+#define _KERNEL_KSTD_ARENA_HPP_
+
+#include <kernel/types.hpp>
+
+
+namespace kernel {
+namespace kstd {
+
+struct arena_chunk_t
+{
+    arena_chunk_t *m_prev;      // previous chunk in the chain
+    uint8_t       *m_end;       // end of the chunk memory
+    uint32_t       m_order;     // chunk size in pages (2^order)
+    bool           m_is_pages;  // checks if chunk was allocated from PMM
+};
+
+/** @brief Arena position to rewind to.*/
+struct arena_mark_t
+{
+    arena_chunk_t *m_chunk;     // current chunk at the moment of mark
+    uint8_t       *m_ptr;       // current pointer at the moment of mark
+};
+
+struct arena_t
+{
+    arena_chunk_t *m_chunk;     // current chunk
+    uint8_t       *m_ptr;       // first free byte in the current chunk
+
+private:
+    /**
+     * @brief Chain a new chunk to the arena.
+     *
+     * @param [in] size - given minimum number of free bytes in the chunk.
+     * @return true - in case of success.
+     * @return false - in case of pages cannot be allocated.
+     */
+    bool grow(size_t size) noexcept;
+
+    /** @brief Free current chunk and make previous chunk current.*/
+    void pop_chunk(void) noexcept;
+
+public:
+    /**
+     * @brief Initialize arena.
+     *
+     * @param [in] buf - given optional initial buffer (e.g. on the stack).
+     * @param [in] size - given initial buffer size.
+     */
+    void init(void *buf = nullptr, size_t size = 0) noexcept;
+
+    /**
+     * @brief Allocate memory from the arena.
+     *
+     * @param [in] size - given size of memory block to allocate.
+     * @param [in] align - given alignment (power of two).
+     * @return pointer to the allocated memory in case of success.
+     * @return nullptr in case of failure.
+     */
+    void *alloc(size_t size, size_t align = sizeof(void*)) noexcept;
+
+    /**
+     * @brief Get current arena position.
+     *
+     * @return arena mark.
+     */
+    arena_mark_t mark(void) const noexcept;
+
+    /**
+     * @brief Free everything allocated after the mark.
+     *
+     * @param [in] mark - given arena mark.
+     */
+    void rewind(const arena_mark_t& mark) noexcept;
+
+    /** @brief Free all arena memory except the initial buffer.*/
+    void release(void) noexcept;
+};
+
+} // namespace kstd
+} // namespace kernel
+
+#endif // _KERNEL_KSTD_ARENA_HPP_
@@ -106,6 +106,57 @@ constexpr inline float64_t ceil(float64_t x) noexcept
         return int_part;
 }
 
+// Integer Functions ------------------------------------------------
+
+/**
+ * @brief Divide 64-bit integer by 32-bit integer.
+ *
+ * @details Kernel is not linked with libgcc, so 64-bit division has
+ * to be done by shift & subtract.
+ *
+ * @param [in] n - given dividend.
+ * @param [in] d - given non-zero divisor.
+ * @return quotient.
+ */
+constexpr inline uint64_t div_u64(uint64_t n, uint32_t d) noexcept
+{
+    uint64_t q = 0;
+    uint64_t r = 0;
+
+    for (int32_t i = 63; i >= 0; i--) {
+        r = (r << 1) | ((n >> i) & 1);
+
+        if (r >= d) {
+            r -= d;
+            q |= uint64_t(1) << i;
+        }
+    }
+
+    return q;
+}
+
+/**
+ * @brief Multiply 64-bit integer by 32-bit integer & shift the 96-bit product.
+ *
+ * @details Used for cycles to nanoseconds conversion, where the product
+ * does not fit in 64 bits.
+ *
+ * @param [in] a - given multiplicand.
+ * @param [in] mul - given multiplier.
+ * @param [in] shift - given right shift (up to 32).
+ * @return (a * mul) >> shift.
+ */
+constexpr inline uint64_t mul_u64_u32_shr(uint64_t a, uint32_t mul, uint32_t shift) noexcept
+{
+    uint64_t low  = (a & 0xFFFFFFFF) * mul;
+    uint64_t high = (a >> 32) * mul;
+
+    if (!shift)
+        return low + (high << 32);
+
+    return (low >> shift) + (high << (32 - shift));
+}
+
 } // namespace kstd
 } // namespace kernel
 
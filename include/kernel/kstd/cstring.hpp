@@ -47,6 +47,31 @@ namespace kstd {
  */
 void *memset(void *s, int32_t c, size_t n) noexcept;
 
+/**
+ * @brief Copies n bytes from memory area src to memory area dest.
+ *
+ * @details The memory areas must not overlap. Bulk of the data is
+ * moved a double word at a time, the remaining tail byte by byte.
+ *
+ * @param [out] dest - given destination buffer pointer.
+ * @param [in] src - given source buffer pointer.
+ * @param [in] n - given number of bytes to copy.
+ * @return destination buffer pointer.
+ */
+void *memcpy(void *dest, const void *src, size_t n) noexcept;
+
+/**
+ * @brief Compares the first n bytes of the memory areas s1 and s2.
+ *
+ * @param [in] s1 - first given buffer pointer.
+ * @param [in] s2 - second given buffer pointer.
+ * @param [in] n - given number of bytes for comparison.
+ * @return 0, if s1 and s2 are equal;
+ * @return a negative value if s1 is less than s2;
+ * @return a positive value if s1 is greater than s2.
+ */
+int32_t memcmp(const void *s1, const void *s2, size_t n) noexcept;
+
 /**
  * @brief Compares the two strings s1 and s2.
  *
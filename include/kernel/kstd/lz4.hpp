@@ -0,0 +1,73 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  lz4.hpp
+ * @brief Declares LZ4 block format compression.
+ *
+ * @details Blocks are sequences of literals followed by back-references
+ * into already produced output, so decompression is a plain copy loop.
+ * Compressor finds matches through a hash table of recent positions and
+ * favours speed over ratio.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_KSTD_LZ4_HPP_
+#define _KERNEL_KSTD_LZ4_HPP_
+
+#include <kernel/types.hpp>
+
+
+namespace kernel {
+namespace kstd {
+
+inline const uint32_t LZ4_HASH_LOG   {12};
+inline const uint32_t LZ4_MAX_INPUT  {0xFFFF};                // positions are stored in 16 bits
+inline const uint32_t LZ4_WORKMEM    {(1 << LZ4_HASH_LOG) * sizeof(uint16_t)};
+
+/**
+ * @brief Compress block.
+ *
+ * @param [in] src - given data to compress.
+ * @param [in] size - given data size (up to LZ4_MAX_INPUT).
+ * @param [out] dst - given output buffer.
+ * @param [in] capacity - given output buffer size.
+ * @param [in] wrkmem - given scratch memory of LZ4_WORKMEM bytes.
+ * @return compressed size - in case of success.
+ * @return 0 - in case of output buffer is too small.
+ */
+uint32_t lz4_compress(const void *src, uint32_t size, void *dst, uint32_t capacity, void *wrkmem) noexcept;
+
+/**
+ * @brief Decompress block.
+ *
+ * @param [in] src - given compressed data.
+ * @param [in] size - given compressed data size.
+ * @param [out] dst - given output buffer.
+ * @param [in] capacity - given output buffer size.
+ * @return decompressed size - in case of success.
+ * @return -1 - in case of malformed data or output buffer is too small.
+ */
+int32_t lz4_decompress(const void *src, uint32_t size, void *dst, uint32_t capacity) noexcept;
+
+} // namespace kstd
+} // namespace kernel
+
+#endif // _KERNEL_KSTD_LZ4_HPP_
@@ -0,0 +1,198 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  rbtree.hpp
+ * @brief Declares intrusive red-black tree.
+ *
+ * @details Tree nodes are embedded into user structures, so the tree
+ * never allocates memory. Users descend the tree themselves to find the
+ * insertion point and then link and rebalance the node. Optional augment
+ * callback keeps per-node data computed from children (e.g. subtree
+ * maximum) up to date during rebalancing. Cached tree additionally keeps
+ * its leftmost node, so the minimum is found in O(1).
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_KSTD_RBTREE_HPP_
+#define _KERNEL_KSTD_RBTREE_HPP_
+
+#include <kernel/types.hpp>
+
+
+namespace kernel {
+namespace kstd {
+
+struct rb_node_t
+{
+    rb_node_t *m_parent;
+    rb_node_t *m_left;
+    rb_node_t *m_right;
+    bool       m_red;
+};
+
+/**
+ * @brief Recompute augmented data of node from its children.
+ *
+ * @param [in] node - given tree node.
+ */
+using rb_augment_t = void (*)(rb_node_t *node) noexcept;
+
+// get structure that contains tree node
+#define rb_entry(ptr, type, member) \
+    reinterpret_cast<type*>(reinterpret_cast<char*>(ptr) - __builtin_offsetof(type, member))
+
+struct rb_root_t
+{
+    rb_node_t *m_node;  // root node (nullptr - empty tree)
+
+private:
+    /**
+     * @brief Replace child of parent node.
+     *
+     * @param [in] parent - given parent node (nullptr - root).
+     * @param [in] old - given old child.
+     * @param [in] node - given new child.
+     */
+    void replace_child(rb_node_t *parent, rb_node_t *old, rb_node_t *node) noexcept;
+
+    /**
+     * @brief Rotate subtree to the left.
+     *
+     * @param [in] node - given subtree root.
+     * @param [in] augment - given augment callback.
+     */
+    void rotate_left(rb_node_t *node, rb_augment_t augment) noexcept;
+
+    /**
+     * @brief Rotate subtree to the right.
+     *
+     * @param [in] node - given subtree root.
+     * @param [in] augment - given augment callback.
+     */
+    void rotate_right(rb_node_t *node, rb_augment_t augment) noexcept;
+
+public:
+    /**
+     * @brief Link node at the insertion point and rebalance the tree.
+     *
+     * @param [in] node - given node to insert.
+     * @param [in] parent - given parent found by descent (nullptr - empty tree).
+     * @param [in] link - given parent child pointer to link node to.
+     * @param [in] augment - given optional augment callback.
+     */
+    void insert(rb_node_t *node, rb_node_t *parent, rb_node_t **link, rb_augment_t augment = nullptr) noexcept;
+
+    /**
+     * @brief Remove node and rebalance the tree.
+     *
+     * @param [in] node - given node to remove.
+     * @param [in] augment - given optional augment callback.
+     */
+    void erase(rb_node_t *node, rb_augment_t augment = nullptr) noexcept;
+
+    /**
+     * @brief Get the leftmost node.
+     *
+     * @return first node - in case of tree is not empty.
+     * @return nullptr - otherwise.
+     */
+    rb_node_t *first(void) const noexcept;
+
+    /**
+     * @brief Get the rightmost node.
+     *
+     * @return last node - in case of tree is not empty.
+     * @return nullptr - otherwise.
+     */
+    rb_node_t *last(void) const noexcept;
+};
+
+/** @brief Red-black tree with cached leftmost node.*/
+struct rb_root_cached_t
+{
+    rb_root_t  m_root;
+    rb_node_t *m_leftmost;  // nullptr - empty tree
+
+    /**
+     * @brief Link node at the insertion point and rebalance the tree.
+     *
+     * @param [in] node - given node to insert.
+     * @param [in] parent - given parent found by descent (nullptr - empty tree).
+     * @param [in] link - given parent child pointer to link node to.
+     * @param [in] leftmost - given flag whether descent has only gone left.
+     * @param [in] augment - given optional augment callback.
+     */
+    void insert(rb_node_t *node, rb_node_t *parent, rb_node_t **link, bool leftmost,
+        rb_augment_t augment = nullptr) noexcept;
+
+    /**
+     * @brief Remove node and rebalance the tree.
+     *
+     * @param [in] node - given node to remove.
+     * @param [in] augment - given optional augment callback.
+     */
+    void erase(rb_node_t *node, rb_augment_t augment = nullptr) noexcept;
+
+    /**
+     * @brief Get the leftmost node.
+     *
+     * @return first node - in case of tree is not empty.
+     * @return nullptr - otherwise.
+     */
+    inline rb_node_t *first(void) const noexcept
+    {
+        return m_leftmost;
+    }
+};
+
+/**
+ * @brief Get in-order successor.
+ *
+ * @param [in] node - given tree node.
+ * @return next node - in case of success.
+ * @return nullptr - in case of node is the last one.
+ */
+rb_node_t *rb_next(const rb_node_t *node) noexcept;
+
+/**
+ * @brief Get in-order predecessor.
+ *
+ * @param [in] node - given tree node.
+ * @return previous node - in case of success.
+ * @return nullptr - in case of node is the first one.
+ */
+rb_node_t *rb_prev(const rb_node_t *node) noexcept;
+
+/**
+ * @brief Recompute augmented data from node up to the root.
+ *
+ * @details Must be called after changing data the augmented value
+ * depends on without changing tree structure.
+ *
+ * @param [in] node - given tree node.
+ * @param [in] augment - given augment callback.
+ */
+void rb_propagate(rb_node_t *node, rb_augment_t augment) noexcept;
+
+} // namespace kstd
+} // namespace kernel
+
+#endif // _KERNEL_KSTD_RBTREE_HPP_
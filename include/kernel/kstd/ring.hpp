@@ -0,0 +1,115 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  ring.hpp
+ * @brief Declares single-producer/single-consumer ring buffer.
+ *
+ * @details Producer only writes the head index and consumer only writes
+ * the tail index, so an interrupt handler can push elements while the
+ * interrupted code pops them without any lock. Element is stored before
+ * the head is published and read before the tail is released; x86 keeps
+ * stores & loads in program order, so compiler barriers are sufficient.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#ifndef _KERNEL_KSTD_RING_HPP_
+#define _KERNEL_KSTD_RING_HPP_
+
+#include <kernel/arch/x86/atomic.hpp>
+
+
+namespace kernel {
+namespace kstd {
+
+template <typename T, uint32_t N>
+struct ring_t
+{
+    static_assert(N && !(N & (N - 1)), "ring size must be a power of two");
+
+    T                 m_buf[N];
+    volatile uint32_t m_head;   // next slot written by producer
+    volatile uint32_t m_tail;   // next slot read by consumer
+
+    /** @brief Initialize empty ring.*/
+    inline void init(void) noexcept
+    {
+        m_head = 0;
+        m_tail = 0;
+    }
+
+    /**
+     * @brief Check whether ring has no elements.
+     *
+     * @return true - in case of ring is empty.
+     * @return false - otherwise.
+     */
+    inline bool empty(void) const noexcept
+    {
+        return m_head == m_tail;
+    }
+
+    /**
+     * @brief Add element (producer only).
+     *
+     * @param [in] value - given element.
+     * @return true - in case of success.
+     * @return false - in case of ring is full.
+     */
+    inline bool push(const T& value) noexcept
+    {
+        uint32_t head = m_head;
+
+        if (head - m_tail == N)
+            return false;
+
+        m_buf[head & (N - 1)] = value;
+        arch::x86::barrier();
+        m_head = head + 1;
+
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest element (consumer only).
+     *
+     * @param [out] value - given removed element.
+     * @return true - in case of success.
+     * @return false - in case of ring is empty.
+     */
+    inline bool pop(T& value) noexcept
+    {
+        uint32_t tail = m_tail;
+
+        if (tail == m_head)
+            return false;
+
+        value = m_buf[tail & (N - 1)];
+        arch::x86::barrier();
+        m_tail = tail + 1;
+
+        return true;
+    }
+};
+
+} // namespace kstd
+} // namespace kernel
+
+#endif // _KERNEL_KSTD_RING_HPP_
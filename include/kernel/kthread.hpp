@@ -0,0 +1,71 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  kthread.hpp
+ * @brief Declares kernel threads creation.
+ *
+ * @details Thread has its own stack & runs its function in kernel mode
+ * with interrupts enabled. Thread exits when function returns, its stack
+ * is freed by the next kthread_create() after the last switch from it.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#ifndef _KERNEL_KTHREAD_HPP_
+#define _KERNEL_KTHREAD_HPP_
+
+#include <kernel/sched.hpp>
+
+
+namespace kernel {
+namespace core {
+
+// kernel thread function type
+using kthread_func_t = void (*)(void *data) noexcept;
+
+/**
+ * @brief Create sleeping kernel thread.
+ *
+ * @param [in] func - given thread function.
+ * @param [in] data - given data passed to function.
+ * @param [in] name - given thread name.
+ * @return new task - in case of success.
+ * @return nullptr - in case of allocation error.
+ */
+task_t *kthread_create(kthread_func_t func, void *data, const char *name) noexcept;
+
+/**
+ * @brief Create kernel thread & wake it up.
+ *
+ * @param [in] func - given thread function.
+ * @param [in] data - given data passed to function.
+ * @param [in] name - given thread name.
+ * @return new task - in case of success.
+ * @return nullptr - in case of allocation error.
+ */
+task_t *kthread_run(kthread_func_t func, void *data, const char *name) noexcept;
+
+/** @brief Terminate current kernel thread.*/
+void kthread_exit(void) noexcept;
+
+} // namespace core
+} // namespace kernel
+
+#endif // _KERNEL_KTHREAD_HPP_
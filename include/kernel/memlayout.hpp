@@ -31,21 +31,54 @@
 
 extern kernel::uint32_t kernel_phys_start;
 extern kernel::uint32_t kernel_phys_end;
+extern kernel::uint32_t kernel_virt_start;
+extern kernel::uint32_t kernel_virt_end;
 
 namespace kernel {
 namespace core {
 namespace memory {
 
+// Kernel virtual memory layout:
+// 0xC0000000 - 0xEFFFFFFF  direct map of physical memory (kernel image included)
+// 0xF0000000 - 0xFFBFFFFF  ioremap area
+// 0xFFC00000 - 0xFFFFFFFF  page tables of active address space (recursive mapping)
+inline const uint32_t PAGE_OFFSET    {0xC0000000}; // kernel virtual base address
+inline const uint32_t LOWMEM_SIZE    {0x30000000}; // max size of the direct map
+inline const uint32_t IOREMAP_START  {0xF0000000}; // ioremap area start
+inline const uint32_t IOREMAP_END    {0xFFC00000}; // ioremap area end
+
 inline const auto      KERNEL_START_PADDR {phys_addr_t(&kernel_phys_start)};
 inline const auto      KERNEL_END_PADDR   {phys_addr_t(&kernel_phys_end)};
-inline const uint32_t *KERNEL_START_PTR   {reinterpret_cast<uint32_t*>(KERNEL_START_PADDR)};
-inline const uint32_t *KERNEL_END_PTR     {reinterpret_cast<uint32_t*>(KERNEL_END_PADDR)};
+inline const uint32_t *KERNEL_START_PTR   {&kernel_virt_start};
+inline const uint32_t *KERNEL_END_PTR     {&kernel_virt_end};
 
 inline const phys_addr_t MEM_START_PADDR    {0x00000};
 inline const uint32_t    STACK_SIZE         {64_KB};
 
 #define KERNEL_SIZE ((KERNEL_END_PADDR) - (KERNEL_START_PADDR))
 
+/**
+ * @brief Convert physical address to direct-mapped virtual address.
+ *
+ * @param [in] addr - given physical address.
+ * @return virtual address.
+ */
+inline void *phys_to_virt(phys_addr_t addr) noexcept
+{
+    return reinterpret_cast<void*>(addr + PAGE_OFFSET);
+}
+
+/**
+ * @brief Convert direct-mapped virtual address to physical address.
+ *
+ * @param [in] addr - given virtual address.
+ * @return physical address.
+ */
+inline phys_addr_t virt_to_phys(const void *addr) noexcept
+{
+    return reinterpret_cast<phys_addr_t>(addr) - PAGE_OFFSET;
+}
+
 } // namespace memory
 } // namespace core
 } // namespace kernel
@@ -0,0 +1,178 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  mempool.hpp
+ * @brief Declares memory pools with reserved elements.
+ *
+ * @details Memory pool guarantees that a minimum number of elements
+ * can be allocated even if the underlying allocator fails. Elements are
+ * served from the reserve only when the normal path fails and the
+ * reserve is refilled later, outside of the critical path.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_MEMPOOL_HPP_
+#define _KERNEL_MEMPOOL_HPP_
+
+#include <kernel/slab.hpp>
+#include <kernel/gfp.hpp>
+
+
+namespace kernel {
+namespace core {
+namespace memory {
+
+// pool element allocation & free functions types
+using mempool_alloc_t = void *(*)(gfp_t flags, void *pool_data);
+using mempool_free_t  = void (*)(void *element, void *pool_data);
+
+struct mempool_t
+{
+    void          **m_elements;     // reserved elements
+    uint32_t        m_min_nr;       // minimum number of reserved elements
+    uint32_t        m_curr_nr;      // current number of reserved elements
+    mempool_alloc_t m_alloc;        // element allocation function
+    mempool_free_t  m_free;         // element free function
+    void           *m_pool_data;    // allocation function argument
+    mempool_t      *m_next_refill;  // next pool in the refill queue
+    bool            m_is_queued;    // checks if pool is in the refill queue
+    uint32_t        m_reserve_hits; // number of elements served from the reserve
+
+private:
+    /**
+     * @brief Add element to the reserve.
+     *
+     * @param [in] element - given element to add.
+     */
+    inline void add_element(void *element) noexcept;
+
+    /**
+     * @brief Remove element from the reserve.
+     *
+     * @return reserved element.
+     */
+    inline void *remove_element(void) noexcept;
+
+public:
+    /**
+     * @brief Create a memory pool.
+     *
+     * @param [in] min_nr - given minimum number of reserved elements.
+     * @param [in] alloc - given element allocation function.
+     * @param [in] free - given element free function.
+     * @param [in] pool_data - given allocation function argument.
+     * @return true - in case of success.
+     * @return false - in case of reserve cannot be allocated.
+     */
+    bool create(uint32_t min_nr, mempool_alloc_t alloc, mempool_free_t free, void *pool_data) noexcept;
+
+    /**
+     * @brief Create a memory pool of slab cache objects.
+     *
+     * @param [in] min_nr - given minimum number of reserved elements.
+     * @param [in] cache - given slab cache.
+     * @return true - in case of success.
+     * @return false - in case of reserve cannot be allocated.
+     */
+    bool create_slab_pool(uint32_t min_nr, kmem::cache_t *cache) noexcept;
+
+    /**
+     * @brief Create a memory pool of kmalloc() objects.
+     *
+     * @param [in] min_nr - given minimum number of reserved elements.
+     * @param [in] size - given size of each element.
+     * @return true - in case of success.
+     * @return false - in case of reserve cannot be allocated.
+     */
+    bool create_kmalloc_pool(uint32_t min_nr, size_t size) noexcept;
+
+    /**
+     * @brief Create a memory pool of pages.
+     *
+     * @param [in] min_nr - given minimum number of reserved elements.
+     * @param [in] order - given power of two (2^order pages per element).
+     * @return true - in case of success.
+     * @return false - in case of reserve cannot be allocated.
+     */
+    bool create_page_pool(uint32_t min_nr, uint32_t order) noexcept;
+
+    /** @brief Free all reserved elements.*/
+    void destroy(void) noexcept;
+
+    /**
+     * @brief Allocate an element from the pool.
+     *
+     * @details The underlying allocator is tried first with GFP::ATOMIC,
+     * so it never takes a slow detour. If it fails the element is taken
+     * from the reserve and the pool is queued for refill.
+     *
+     * @param [in] flags - given allocation flags.
+     * @return allocated element - in case of success.
+     * @return nullptr - in case of both allocator and reserve are empty.
+     */
+    void *alloc(gfp_t flags) noexcept;
+
+    /**
+     * @brief Free an element.
+     *
+     * @details The element is returned to the reserve if it is not full.
+     *
+     * @param [in] element - given element to free.
+     */
+    void free(void *element) noexcept;
+
+    /**
+     * @brief Refill the reserve up to the minimum number of elements.
+     *
+     * @return true - if the reserve is full.
+     * @return false - if the underlying allocator failed.
+     */
+    bool refill(void) noexcept;
+
+    /**
+     * @brief Put pool into the refill queue.
+     *
+     * @warning Interrupts must be disabled by the caller.
+     */
+    void queue_refill(void) noexcept;
+};
+
+/**
+ * @brief Refill pools that have used their reserve.
+ *
+ * @return true - in case of all queued pools were refilled.
+ * @return false - in case of allocator could not satisfy a pool.
+ */
+bool mempool_refill_pending(void) noexcept;
+
+/**
+ * @brief Start kmempoold thread refilling pools in background.
+ *
+ * @return true - in case of success.
+ * @return false - in case of allocation error.
+ */
+bool mempool_init(void) noexcept;
+
+} // namespace memory
+} // namespace core
+} // namespace kernel
+
+#endif // _KERNEL_MEMPOOL_HPP_
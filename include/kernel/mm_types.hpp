@@ -27,6 +27,7 @@
 #ifndef _KERNEL_MM_TYPES_HPP_
 #define _KERNEL_MM_TYPES_HPP_
 
+#include <kernel/memlayout.hpp>
 #include <kernel/slab.hpp>
 
 
@@ -42,9 +43,16 @@ inline const uint8_t    PAGE_SHIFT  {0xC};
 // page flags enumeration
 enum PG : uint8_t {
     RESERVED = 0b10000000,   // empty pages or pages that do not even exist
-    SLAB     = 0b01000000    // page frame is included in a slab
+    SLAB     = 0b01000000,   // page frame is included in a slab
+    LARGE    = 0b00100000,   // page frame heads a large kmalloc allocation
+    LRU      = 0b00010000,   // page frame is on reclaim list
+    ACTIVE   = 0b00001000,   // page frame is on active reclaim list
+    SWAP     = 0b00000100,   // page frame is in swap cache
+    KSM      = 0b00000010    // page frame is shared by same-page merging
 };
 
+struct mm_t;
+
 /**
  * @brief Convert page frame number to physical address.
  *
@@ -67,15 +75,42 @@ constexpr inline size_t PHYS_PFN(phys_addr_t addr) noexcept
     return addr >> PAGE_SHIFT;
 }
 
+/**
+ * @brief Get the smallest order of pages that fit given size.
+ *
+ * @param [in] size - given size in bytes.
+ * @return power of two (2^order pages).
+ */
+constexpr inline uint32_t get_order(size_t size) noexcept
+{
+    uint32_t order = 0;
+
+    size = (size - 1) >> PAGE_SHIFT;
+
+    while (size) {
+        size >>= 1;
+        order++;
+    }
+
+    return order;
+}
+
 struct page_t
 {
-    kmem::cache_t *m_cache; // memory allocator cache (only if PG::SLAB is set)
-    kmem::slab_t  *m_slab;  // memory allocator slab (only if PG::SLAB is set)
-    size_t         m_pfn;   // page frame number - position in bitmap & memory map
-    uint8_t        m_flags; // describes page status
+    kmem::cache_t    *m_cache; // memory allocator cache (only if PG::SLAB is set)
+    kmem::slab_t     *m_slab;  // memory allocator slab (only if PG::SLAB is set)
+    size_t            m_pfn;   // page frame number - position in bitmap & memory map
+    uint8_t           m_flags; // describes page status
+    uint8_t           m_order; // allocation order (only if PG::LARGE is set)
+    volatile uint32_t m_count; // reference count (0 - page is free)
+    mm_t             *m_mm;    // address space mapping anonymous page (nullptr - unknown)
+    uint32_t          m_vaddr; // virtual address in m_mm
+    uint32_t          m_swap;  // swap entry of cached slot (only if PG::SWAP is set)
+    page_t           *m_prev;  // previous page on reclaim list
+    page_t           *m_next;  // next page on reclaim list
 
     /**
-     * @brief Get page memory address.
+     * @brief Get page direct-mapped virtual address.
      *
      * @return page memory address.
      */
@@ -84,7 +119,7 @@ struct page_t
 
 inline void *page_t::addr(void) const noexcept
 {
-    return reinterpret_cast<void*>(PFN_PHYS(m_pfn));
+    return phys_to_virt(PFN_PHYS(m_pfn));
 }
 
 } // namespace memory
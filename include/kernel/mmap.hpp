@@ -0,0 +1,341 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  mmap.hpp
+ * @brief Declares virtual memory areas & demand paging.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_MMAP_HPP_
+#define _KERNEL_MMAP_HPP_
+
+#include <kernel/kstd/rbtree.hpp>
+#include <kernel/mm_types.hpp>
+#include <kernel/vmm.hpp>
+
+
+namespace kernel {
+namespace core {
+namespace memory {
+
+inline const uint32_t MMAP_START {0x40000000};  // lazily mapped areas start
+inline const uint32_t MMAP_END   {PAGE_OFFSET}; // lazily mapped areas end
+
+inline const uint32_t VMACACHE_SIZE {4};        // recently found areas per task (power of two)
+
+// virtual memory area flags enumeration
+enum VM : uint32_t {
+    READ      = 0b00001,    // pages can be read
+    WRITE     = 0b00010,    // pages can be written
+    EXEC      = 0b00100,    // pages can be executed
+    SHARED    = 0b01000,    // writes are visible to other mappings (no copy-on-write)
+    MERGEABLE = 0b10000     // identical anonymous pages can be merged
+};
+
+struct vm_file_t;
+struct ksm_mm_t;
+
+/**
+ * @brief Read file page from backing store.
+ *
+ * @param [in] file - given file.
+ * @param [in] pgoff - given page offset in file.
+ * @param [out] buf - given page sized buffer to fill.
+ * @return true - in case of success.
+ * @return false - in case of I/O error.
+ */
+using readpage_t = bool (*)(vm_file_t *file, size_t pgoff, void *buf) noexcept;
+
+/** @brief Backing object of file mappings with its page cache.*/
+struct vm_file_t
+{
+    page_t   **m_cache;     // resident pages indexed by page offset
+    size_t     m_npages;    // file size in pages
+    readpage_t m_readpage;  // backing store read callback
+    void      *m_private;   // backing store private data
+
+    /**
+     * @brief Initialize file.
+     *
+     * @param [in] npages - given file size in pages.
+     * @param [in] readpage - given backing store read callback.
+     * @param [in] priv - given backing store private data.
+     * @return true - in case of success.
+     * @return false - in case of page cache allocation error.
+     */
+    bool init(size_t npages, readpage_t readpage, void *priv) noexcept;
+
+    /** @brief Free page cache. File must not be mapped.*/
+    void destroy(void) noexcept;
+
+    /**
+     * @brief Find resident page.
+     *
+     * @param [in] pgoff - given page offset in file.
+     * @return page struct - in case of page is resident.
+     * @return nullptr - otherwise.
+     */
+    page_t *find_page(size_t pgoff) const noexcept;
+
+    /**
+     * @brief Get page reading it from backing store if needed.
+     *
+     * @param [in] pgoff - given page offset in file.
+     * @return page struct - in case of success.
+     * @return nullptr - in case of errors.
+     */
+    page_t *read_page(size_t pgoff) noexcept;
+};
+
+/** @brief Contiguous range of lazily mapped virtual memory.*/
+struct vm_area_t
+{
+    uint32_t        m_start;        // first address
+    uint32_t        m_end;          // first address after the end
+    uint32_t        m_flags;        // VM flags
+    vm_file_t      *m_file;         // backing file (nullptr for anonymous memory)
+    size_t          m_pgoff;        // page offset in file of the first page
+    vm_area_t      *m_prev;         // previous area in address order
+    vm_area_t      *m_next;         // next area in address order
+    kstd::rb_node_t m_rb;           // address space tree node
+    uint32_t        m_subtree_gap;  // largest free gap before areas of subtree
+};
+
+/** @brief Page fault counters of address space.*/
+struct fault_stats_t
+{
+    uint32_t m_faults;  // handled page faults
+    uint32_t m_anon;    // anonymous pages allocated on fault
+    uint32_t m_file;    // file pages mapped on fault
+    uint32_t m_major;   // file pages read from backing store
+    uint32_t m_around;  // file pages mapped by fault-around
+    uint32_t m_zero;    // zero page mappings of anonymous memory
+    uint32_t m_cow;     // pages copied on write
+    uint32_t m_reuse;   // write-protected pages reused without copying
+    uint32_t m_swapin;  // pages mapped back from swap
+    uint32_t m_errors;  // invalid accesses
+};
+
+/** @brief Address space.*/
+struct mm_t
+{
+    pde_t          *m_pgdir;            // page directory
+    kstd::rb_root_t m_mm_rb;            // areas tree sorted by address
+    vm_area_t      *m_mmap;             // areas list sorted by address
+    size_t          m_map_count;        // number of areas
+    uint32_t        m_vmacache_seqnum;  // invalidates cached areas of tasks
+    ksm_mm_t       *m_ksm;              // same-page merging registration (nullptr - not registered)
+    fault_stats_t   m_stats;
+
+    /**
+     * @brief Initialize empty address space sharing kernel mappings.
+     *
+     * @return true - in case of success.
+     * @return false - in case of page directory allocation error.
+     */
+    bool init(void) noexcept;
+
+    /** @brief Remove all areas and free page tables. Must not be active.*/
+    void destroy(void) noexcept;
+
+    /**
+     * @brief Duplicate address space.
+     *
+     * @details Private areas share physical pages that are write-protected
+     * in both address spaces and copied on the first write.
+     *
+     * @param [out] child - given uninitialized address space.
+     * @return true - in case of success.
+     * @return false - in case of allocation errors.
+     */
+    bool dup(mm_t *child) noexcept;
+
+    /**
+     * @brief Find the first area that ends after address.
+     *
+     * @param [in] addr - given virtual address.
+     * @return area - in case of success.
+     * @return nullptr - in case of there are no areas above address.
+     */
+    vm_area_t *find_vma(uint32_t addr) const noexcept;
+
+    /**
+     * @brief Create lazily mapped area.
+     *
+     * @param [in] addr - given page aligned address (0 - choose address).
+     * @param [in] len - given area size in bytes.
+     * @param [in] flags - given VM flags.
+     * @param [in] file - given backing file (nullptr - anonymous memory).
+     * @param [in] pgoff - given page offset in file.
+     * @return area start address - in case of success.
+     * @return nullptr - in case of errors.
+     */
+    void *mmap(uint32_t addr, size_t len, uint32_t flags, vm_file_t *file, size_t pgoff) noexcept;
+
+    /**
+     * @brief Remove mappings in range.
+     *
+     * @param [in] addr - given page aligned address.
+     * @param [in] len - given range size in bytes.
+     * @return true - in case of success.
+     * @return false - in case of invalid range.
+     */
+    bool munmap(uint32_t addr, size_t len) noexcept;
+
+    /**
+     * @brief Handle page fault.
+     *
+     * @param [in] addr - given faulting address.
+     * @param [in] err - given page fault error code.
+     * @return true - in case of fault was resolved.
+     * @return false - in case of invalid access.
+     */
+    bool handle_fault(uint32_t addr, uint32_t err) noexcept;
+
+private:
+    /**
+     * @brief Insert area into list & tree.
+     *
+     * @param [in] vma - given area.
+     * @param [in] prev - given previous area (nullptr - first area).
+     */
+    void link_vma(vm_area_t *vma, vm_area_t *prev) noexcept;
+
+    /**
+     * @brief Remove area from list & tree.
+     *
+     * @param [in] vma - given area.
+     */
+    void unlink_vma(vm_area_t *vma) noexcept;
+
+    /**
+     * @brief Change area bounds.
+     *
+     * @param [in] vma - given area.
+     * @param [in] start - given new first address.
+     * @param [in] end - given new end address.
+     */
+    void adjust_vma(vm_area_t *vma, uint32_t start, uint32_t end) noexcept;
+
+    /**
+     * @brief Find the lowest free range.
+     *
+     * @param [in] size - given page aligned range size.
+     * @return range start address - in case of success.
+     * @return 0 - in case of there is no free range of that size.
+     */
+    uint32_t get_unmapped_area(uint32_t size) const noexcept;
+
+    /**
+     * @brief Map resident file pages around faulting address.
+     *
+     * @param [in] vma - given faulting area.
+     * @param [in] addr - given faulting page address.
+     * @param [in] prot - given page table entry flags.
+     */
+    void fault_around(const vm_area_t *vma, uint32_t addr, uint32_t prot) noexcept;
+
+    /**
+     * @brief Handle write to write-protected page.
+     *
+     * @param [in] addr - given faulting page address.
+     * @param [in] pte - given page table entry.
+     * @return true - in case of fault was resolved.
+     * @return false - in case of allocation error.
+     */
+    bool do_wp_page(uint32_t addr, pte_t *pte) noexcept;
+
+    /**
+     * @brief Handle access to swapped out page.
+     *
+     * @param [in] vma - given faulting area.
+     * @param [in] addr - given faulting page address.
+     * @param [in] pte - given page table entry holding swap entry.
+     * @param [in] write - given write access flag.
+     * @return true - in case of fault was resolved.
+     * @return false - in case of allocation or I/O error.
+     */
+    bool do_swap_page(const vm_area_t *vma, uint32_t addr, pte_t *pte, bool write) noexcept;
+
+    /**
+     * @brief Unmap pages in range dropping their references.
+     *
+     * @param [in] start - given range start.
+     * @param [in] end - given range end.
+     * @param [in,out] tlb - given gather of unmapped entries.
+     */
+    void zap_range(uint32_t start, uint32_t end, tlb_gather_t& tlb) noexcept;
+};
+
+/** @brief Recently found areas of task.*/
+struct vmacache_t
+{
+    const mm_t *m_mm;                       // address space of cached areas
+    uint32_t    m_seqnum;                   // address space seqnum at the moment of caching
+    vm_area_t  *m_vmas[VMACACHE_SIZE];      // areas indexed by page number hash
+};
+
+/**
+ * @brief Get areas cache of current task.
+ *
+ * @return areas cache.
+ */
+vmacache_t *current_vmacache(void) noexcept;
+
+// page fault error code bits
+inline const uint32_t PF_PRESENT {0b001}; // protection violation on present page
+inline const uint32_t PF_WRITE   {0b010}; // write access
+inline const uint32_t PF_USER    {0b100}; // access from user mode
+
+// number of pages mapped around file page fault (power of two, 1 - disabled)
+extern uint32_t fault_around_pages;
+
+// kernel address space
+extern mm_t init_mm;
+
+// address space loaded into CR3
+extern mm_t *active_mm;
+
+/**
+ * @brief Get current address space.
+ *
+ * @return address space of current task.
+ */
+inline mm_t *current_mm(void) noexcept
+{
+    return active_mm;
+}
+
+/**
+ * @brief Load address space.
+ *
+ * @param [in] mm - given address space.
+ */
+void switch_mm(mm_t *mm) noexcept;
+
+/** @brief Initialize kernel address space & page fault handler.*/
+void mm_init(void) noexcept;
+
+} // namespace memory
+} // namespace core
+} // namespace kernel
+
+#endif // _KERNEL_MMAP_HPP_
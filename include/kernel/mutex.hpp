@@ -0,0 +1,75 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  mutex.hpp
+ * @brief Declares sleeping lock of kernel threads.
+ *
+ * @details Task that finds mutex locked sleeps until owner releases it,
+ * so owner may be preempted while holding it. Mutex must not be taken
+ * in interrupt context.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#ifndef _KERNEL_MUTEX_HPP_
+#define _KERNEL_MUTEX_HPP_
+
+#include <kernel/sched.hpp>
+
+
+namespace kernel {
+namespace core {
+
+struct mutex_t
+{
+    task_t  *m_owner;       // nullptr - mutex is unlocked
+    task_t  *m_waiters;     // tasks sleeping on mutex in FIFO order
+    task_t **m_tail;
+    uint32_t m_contended;   // times lock had to sleep
+
+    /** @brief Initialize mutex.*/
+    void init(void) noexcept;
+
+    /** @brief Acquire mutex sleeping while it is held.*/
+    void lock(void) noexcept;
+
+    /**
+     * @brief Try to acquire mutex without sleeping.
+     *
+     * @return true - in case of success.
+     * @return false - in case of mutex is held.
+     */
+    bool trylock(void) noexcept;
+
+    /** @brief Release mutex & wake up the first waiter.*/
+    void unlock(void) noexcept;
+};
+
+/**
+ * Serializes threads using subsystems without their own locking
+ * (memory management, swap, drivers). Shell holds it while it runs
+ * command, background threads hold it for each batch of work.
+ */
+extern mutex_t kernel_lock;
+
+} // namespace core
+} // namespace kernel
+
+#endif // _KERNEL_MUTEX_HPP_
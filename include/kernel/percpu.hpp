@@ -0,0 +1,108 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  percpu.hpp
+ * @brief Contains per-CPU data declarations.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_PERCPU_HPP_
+#define _KERNEL_PERCPU_HPP_
+
+#include <kernel/types.hpp>
+
+
+namespace kernel {
+
+inline const uint32_t NR_CPUS         {8};  // maximum number of supported CPUs
+inline const uint32_t CACHE_LINE_SIZE {64}; // x86 cache line size in bytes
+
+/**
+ * @brief Get current CPU number.
+ *
+ * @return current CPU number.
+ */
+inline uint32_t smp_processor_id(void) noexcept
+{
+    return 0; // only the bootstrap processor is running
+}
+
+/**
+ * @brief Get number of running CPUs.
+ *
+ * @return number of running CPUs.
+ */
+inline uint32_t num_online_cpus(void) noexcept
+{
+    return 1;
+}
+
+/**
+ * @brief Per-CPU variable.
+ *
+ * @details Each CPU copy is placed in its own cache line to prevent
+ * false sharing between CPUs updating their copies.
+ */
+template <typename T>
+struct percpu_t
+{
+    struct alignas(CACHE_LINE_SIZE) slot_t {
+        T m_value;
+    };
+
+    slot_t m_slots[NR_CPUS];
+
+    /**
+     * @brief Get CPU copy of the variable.
+     *
+     * @param [in] cpu - given CPU number.
+     * @return CPU copy of the variable.
+     */
+    inline T& operator[](uint32_t cpu) noexcept
+    {
+        return m_slots[cpu].m_value;
+    }
+
+    /**
+     * @brief Get CPU copy of the variable.
+     *
+     * @param [in] cpu - given CPU number.
+     * @return CPU copy of the variable.
+     */
+    inline const T& operator[](uint32_t cpu) const noexcept
+    {
+        return m_slots[cpu].m_value;
+    }
+
+    /**
+     * @brief Get current CPU copy of the variable.
+     *
+     * @return current CPU copy of the variable.
+     */
+    inline T& this_cpu(void) noexcept
+    {
+        return m_slots[smp_processor_id()].m_value;
+    }
+};
+
+} // namespace kernel
+
+#endif // _KERNEL_PERCPU_HPP_
@@ -27,9 +27,12 @@
 #ifndef _KERNEL_PMM_HPP_
 #define _KERNEL_PMM_HPP_
 
+#include <kernel/arch/x86/atomic.hpp>
 #include <kernel/kstd/bitmap.hpp>
 #include <kernel/multiboot.hpp>
 #include <kernel/mm_types.hpp>
+#include <kernel/spinlock.hpp>
+#include <kernel/swap.hpp>
 #include <kernel/gfp.hpp>
 
 
@@ -48,6 +51,7 @@ struct phys_mman_t
     size_t m_max_pages;                 // total number of pages
     size_t m_used_pages;
     size_t m_free_pages;
+    spinlock_t m_lock;                  // protects bitmap & counters against other tasks
 
 private:
     /** @brief Get information about memory regions.*/
@@ -117,6 +121,29 @@ public:
      */
     void free_pages(phys_addr_t addr, uint32_t order) noexcept;
 
+    /**
+     * @brief Grow allocated pages in place.
+     *
+     * @details Succeeds only if all pages following the allocated
+     * block up to the new order are free.
+     *
+     * @param [in] addr - given first page address.
+     * @param [in] order - given current power of two (2^order pages).
+     * @param [in] new_order - given new power of two (2^new_order pages).
+     * @return true - in case of success.
+     * @return false - in case of adjacent pages are used.
+     */
+    bool grow_pages(phys_addr_t addr, uint32_t order, uint32_t new_order) noexcept;
+
+    /**
+     * @brief Shrink allocated pages in place freeing the tail.
+     *
+     * @param [in] addr - given first page address.
+     * @param [in] order - given current power of two (2^order pages).
+     * @param [in] new_order - given new power of two (2^new_order pages).
+     */
+    void shrink_pages(phys_addr_t addr, uint32_t order, uint32_t new_order) noexcept;
+
     /**
      * @brief Get the page struct.
      *
@@ -128,6 +155,54 @@ public:
 
 extern phys_mman_t pmm;
 
+/**
+ * @brief Get the page struct of direct-mapped virtual address.
+ *
+ * @param [in] addr - given virtual address.
+ * @return page struct.
+ */
+inline page_t *virt_to_page(const void *addr) noexcept
+{
+    return pmm.get_page(virt_to_phys(addr));
+}
+
+/**
+ * @brief Get number of page users.
+ *
+ * @param [in] page - given page struct.
+ * @return page reference count.
+ */
+inline uint32_t page_count(const page_t *page) noexcept
+{
+    return page->m_count;
+}
+
+/**
+ * @brief Take reference to allocated page.
+ *
+ * @param [in] page - given page struct.
+ */
+inline void get_page(page_t *page) noexcept
+{
+    arch::x86::fetch_add(&page->m_count, 1);
+}
+
+/**
+ * @brief Drop reference to single page and free it after the last one.
+ *
+ * @param [in] page - given page struct.
+ */
+inline void put_page(page_t *page) noexcept
+{
+    if (arch::x86::fetch_add(&page->m_count, -1) == 1) {
+        // freed page must not be found by reclaim
+        if (page->m_flags & PG::LRU)
+            lru_del(page);
+
+        pmm.free_pages(PFN_PHYS(page->m_pfn), 0);
+    }
+}
+
 } // namespace memory
 } // namespace core
 } // namespace kernel
@@ -0,0 +1,226 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  sched.hpp
+ * @brief Declares kernel threads scheduler.
+ *
+ * @details Each CPU runs its runnable threads round-robin from FIFO run
+ * queue, the idle thread runs when the queue is empty. Tick preempts
+ * thread whose time slice has expired: it sets need_resched flag that is
+ * checked on interrupt exit. Context switch saves only callee-saved
+ * registers, since it is an ordinary function call for both threads.
+ * Kernel threads run in lazy TLB mode, so user mappings flushes are
+ * deferred until the boot thread that uses them is switched to.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#ifndef _KERNEL_SCHED_HPP_
+#define _KERNEL_SCHED_HPP_
+
+#include <kernel/arch/x86/system.hpp>
+#include <kernel/arch/x86/atomic.hpp>
+#include <kernel/percpu.hpp>
+#include <kernel/mmap.hpp>
+
+
+namespace kernel {
+namespace core {
+
+inline const uint32_t THREAD_SIZE      {8192};          // kernel stack of thread
+inline const uint32_t SCHED_SLICE      {2};             // ticks thread runs before it is preempted
+inline const uint32_t TASK_COMM_LEN    {16};
+inline const uint32_t STACK_END_MAGIC  {0x57AC6E9D};    // canary at the lowest stack word
+
+// task states
+enum class task_state : uint8_t {
+    RUNNING,    // running or queued to run
+    SLEEPING,   // waits for wake_up_process()
+    DEAD        // thread function has returned
+};
+
+/** @brief Kernel thread.*/
+struct task_t
+{
+    uint32_t    m_esp;                  // saved stack pointer (callee-saved registers on top)
+    uint32_t   *m_stack;                // lowest stack address (nullptr - boot stack)
+    task_state  m_state;
+    bool        m_on_rq;                // task is queued in run queue
+    bool        m_kthread;              // task borrows loaded address space (no user mappings)
+    uint32_t    m_pid;
+    uint32_t    m_cpu;                  // CPU task runs on
+    uint32_t    m_slice;                // ticks left until preemption
+    uint32_t    m_switches;             // times task was switched to
+    uint32_t    m_preempted;            // times task was switched from on interrupt exit
+    uint64_t    m_runtime;              // time spent on CPU (ns)
+    uint64_t    m_exec_start;           // time task was switched to
+    task_t     *m_run_next;             // run queue link
+    task_t     *m_wait_next;            // mutex waiters link
+    task_t     *m_next;                 // all tasks list link
+    void      (*m_func)(void *data) noexcept;
+    void       *m_data;
+    char        m_comm[TASK_COMM_LEN];  // thread name
+    memory::vmacache_t m_vmacache;      // recently found areas
+};
+
+/** @brief Per-CPU run queue.*/
+struct runqueue_t
+{
+    task_t   *m_head;           // the next task to run
+    task_t   *m_tail;
+    uint32_t  m_nr_running;     // queued tasks
+    task_t   *m_curr;           // running task
+    task_t   *m_idle;           // task run when queue is empty
+    task_t   *m_prev;           // task switched from (finished by the next one)
+    bool      m_need_resched;   // current task has to be switched
+    uint32_t  m_preempt_count;  // preemption is disabled if not 0
+    uint32_t  m_switches;       // context switches
+};
+
+extern percpu_t<runqueue_t> runqueues;
+extern task_t              *task_list;  // all live tasks
+
+/**
+ * @brief Get task running on current CPU.
+ *
+ * @return current task (nullptr - scheduler is not initialized).
+ */
+inline task_t *current(void) noexcept
+{
+    return runqueues.this_cpu().m_curr;
+}
+
+/**
+ * @brief Set state of current task before it calls schedule() to sleep.
+ *
+ * @param [in] state - given task state.
+ */
+inline void set_current_state(task_state state) noexcept
+{
+    current()->m_state = state;
+}
+
+/**
+ * @brief Check whether current task has to be switched.
+ *
+ * @return true - if scheduler has been requested to run.
+ * @return false - otherwise.
+ */
+inline bool need_resched(void) noexcept
+{
+    return runqueues.this_cpu().m_need_resched;
+}
+
+/**
+ * @brief Turn boot thread into task & create idle task.
+ *
+ * @details Kernel heap has to be initialized.
+ *
+ * @param [in] name - given boot thread name.
+ * @return true - in case of success.
+ * @return false - in case of allocation error.
+ */
+bool sched_init(const char *name) noexcept;
+
+/**
+ * @brief Switch to the next runnable task.
+ *
+ * @details Running task is queued again, task in other state is not
+ * until it is woken up.
+ */
+void schedule(void) noexcept;
+
+/**
+ * @brief Finish context switch in the next task (interrupts disabled).
+ *
+ * @details Called by schedule() & by new thread before its function.
+ */
+void schedule_tail(void) noexcept;
+
+/**
+ * @brief Free stacks & structures of exited tasks.
+ *
+ * @details Exited task is only unlinked by schedule_tail(), since the
+ * switch can interrupt allocator.
+ */
+void sched_reap_dead(void) noexcept;
+
+/** @brief Preempt interrupted task if it was requested (interrupts disabled).*/
+void preempt_schedule_irq(void) noexcept;
+
+/** @brief Account tick to current task & request preemption when its slice expires.*/
+void scheduler_tick(void) noexcept;
+
+/**
+ * @brief Make sleeping task runnable.
+ *
+ * @details Idle CPU is rescheduled on interrupt exit.
+ *
+ * @param [in] task - given task.
+ * @return true - if task was sleeping.
+ * @return false - otherwise.
+ */
+bool wake_up_process(task_t *task) noexcept;
+
+/**
+ * @brief Sleep until timeout or wakeup.
+ *
+ * @param [in] timeout - given timeout in jiffies.
+ * @return jiffies left until timeout (0 - timeout has expired).
+ */
+uint32_t schedule_timeout(uint32_t timeout) noexcept;
+
+/** @brief Give CPU to the next runnable task.*/
+void yield(void) noexcept;
+
+/**
+ * @brief Set up scheduler state of new task & add it to task list.
+ *
+ * @details Task is created sleeping, so wake_up_process() starts it.
+ *
+ * @param [out] task - given task.
+ * @param [in] name - given task name.
+ */
+void sched_fork(task_t *task, const char *name) noexcept;
+
+/** @brief Prevent current task from being preempted on interrupt exit.*/
+inline void preempt_disable(void) noexcept
+{
+    runqueues.this_cpu().m_preempt_count++;
+    arch::x86::barrier();
+}
+
+/** @brief Allow preemption & switch task if it was requested meanwhile.*/
+inline void preempt_enable(void) noexcept
+{
+    arch::x86::barrier();
+    runqueue_t& rq = runqueues.this_cpu();
+
+    if (!--rq.m_preempt_count && rq.m_need_resched && (arch::x86::read_eflags() & arch::x86::EFLAGS_IF))
+        schedule();
+}
+
+/** @brief Display tasks & context switch counters.*/
+void ps(void) noexcept;
+
+} // namespace core
+} // namespace kernel
+
+#endif // _KERNEL_SCHED_HPP_
@@ -27,16 +27,19 @@
 #ifndef _KERNEL_SHELL_HPP_
 #define _KERNEL_SHELL_HPP_
 
-#include <kernel/types.hpp>
+#include <kernel/kstd/arena.hpp>
 
 
 namespace kernel {
 
-inline const auto SHELL_BUFFER_SIZE {128};
+inline const auto SHELL_BUFFER_SIZE  {128};
+inline const auto SHELL_SCRATCH_SIZE {1_KB};
 
 struct shell_t
 {
-    char m_buffer[SHELL_BUFFER_SIZE];
+    char          m_buffer[SHELL_BUFFER_SIZE];
+    uint8_t       m_scratch[SHELL_SCRATCH_SIZE]; // initial arena buffer
+    kstd::arena_t m_arena;                       // command transient allocations
 
 private:
     /** @brief Display kernel shell prompt.*/
@@ -48,9 +51,12 @@ private:
     /**
      * @brief Execute command.
      *
+     * @details Memory allocated by command from the shell arena
+     * is released after command execution.
+     *
      * @param [in] cmd - given command to execute.
      */
-    void exec(const char *cmd) const noexcept;
+    void exec(const char *cmd) noexcept;
 
 public:
     /** @brief Initialize kernel shell.*/
@@ -27,6 +27,8 @@
 #ifndef _KERNEL_SLAB_HPP_
 #define _KERNEL_SLAB_HPP_
 
+#include <kernel/spinlock.hpp>
+#include <kernel/percpu.hpp>
 #include <kernel/types.hpp>
 #include <kernel/gfp.hpp>
 
@@ -34,28 +36,71 @@
 namespace kernel {
 namespace kmem {
 
-inline const uint32_t CACHE_NAMELEN {16};
+inline const uint32_t CACHE_NAMELEN      {16};
+inline const uint32_t KMALLOC_MAX_CACHE  {2048}; // larger sizes are page-backed
+inline const uint32_t LATENCY_BUCKETS    {16};   // log2(cycles) histogram buckets
 
 struct slab_t
 {
     slab_t   *m_next;    // next slab
     slab_t   *m_prev;    // previous slab
     void     *m_s_mem;   // starting address of the first object
-    void     *m_free;    // starting address of the first free object
+    void     *m_free;    // first free object (objects are linked through their first word)
     uint32_t  m_inuse;   // number of active objects in the slab
     bool      m_is_free; // checks if this slab is not used by cache
+    bool      m_frozen;  // checks if this slab is a CPU active slab
 };
 
 struct slab_list_t
 {
-    slab_t *m_next_free; // starting address of the next free slab
     slab_t *m_head;      // list head pointer
+    slab_t *m_tail;      // list tail pointer
     size_t  m_size;      // number of elements
 };
 
+/**
+ * @brief CPU active slab.
+ *
+ * @details The CPU owns all free objects of its active slab. They are
+ * popped and pushed by cmpxchg8b on the (freelist, tid) pair, so the
+ * common alloc/free path takes no lock and is safe against interrupts.
+ * Every operation increments the transaction id, so an interrupt that
+ * changed the freelist in the middle makes the cmpxchg8b fail.
+ */
+struct alignas(8) cpu_slab_t
+{
+    union {
+        struct {
+            void    *m_freelist; // first free object of the active slab
+            uint32_t m_tid;      // transaction id
+        };
+        uint64_t m_pair;         // (freelist, tid) pair for cmpxchg8b
+    };
+    slab_t *m_slab;              // CPU active slab
+};
+
+/** @brief Cache statistics, kept per CPU.*/
+struct cache_stats_t
+{
+    uint32_t m_allocs;          // number of allocated objects
+    uint32_t m_frees;           // number of freed objects
+    uint32_t m_grows;           // number of slabs added to the cache
+    uint32_t m_shrinks;         // number of slabs moved to the freelist
+    uint32_t m_freelist_hits;   // number of slabs reused from the freelist
+    uint32_t m_alloc_slowpath;  // number of allocations that took the lock
+    uint32_t m_free_slowpath;   // number of frees that took the lock
+#ifdef CONFIG_SLAB_LATENCY
+    uint32_t m_alloc_lat[LATENCY_BUCKETS]; // alloc() latency histogram
+    uint32_t m_free_lat[LATENCY_BUCKETS];  // free() latency histogram
+#endif // CONFIG_SLAB_LATENCY
+};
+
 struct cache_t
 {
-    slab_list_t m_list;                // list of partial and full slabs
+    percpu_t<cpu_slab_t> m_cpu_slab;   // CPU active slabs
+    spinlock_t  m_lock;                // protects slab lists
+    slab_list_t m_partial;             // list of partial slabs
+    slab_list_t m_full;                // list of full slabs
     slab_list_t m_freelist;            // list of free slabs
     uint32_t    m_gfporder;            // size of slab in pages (2^gfporder)
     uint32_t    m_objsize;             // object size
@@ -63,9 +108,42 @@ struct cache_t
     uint8_t     m_flags;               // cache flags
     char        m_name[CACHE_NAMELEN]; // cache name
 
+    percpu_t<cache_stats_t> m_stats;   // cache statistics
+
 private:
-    /** @brief Allocate a single slab.*/
-    void alloc_slab(void) noexcept;
+    /**
+     * @brief Get an empty slab for the cache.
+     *
+     * @warning Cache lock must be held.
+     * @return slab pointer - in case of success.
+     * @return nullptr - in case of there are no free slabs left.
+     */
+    slab_t *alloc_slab(void) noexcept;
+
+    /**
+     * @brief Return CPU active slab to the slab lists.
+     *
+     * @warning Cache lock must be held & interrupts disabled.
+     * @param [in,out] cpu_slab - given CPU active slab.
+     */
+    void deactivate_slab(cpu_slab_t& cpu_slab) noexcept;
+
+    /**
+     * @brief Allocate object after CPU freelist is exhausted.
+     *
+     * @param [in,out] cpu_slab - given CPU active slab.
+     * @return allocated object pointer - in case of success.
+     * @return nullptr - in case of there are no free slabs left.
+     */
+    void *alloc_slow(cpu_slab_t& cpu_slab) noexcept;
+
+    /**
+     * @brief Free object that doesn't belong to CPU active slab.
+     *
+     * @param [in] slab - given object slab.
+     * @param [in] objp - given object to free.
+     */
+    void free_slow(slab_t *slab, void *objp) noexcept;
 
 public:
     /**
@@ -81,28 +159,32 @@ public:
      * @brief Allocate a single object from the cache.
      *
      * @param [in] flags - given allocation flags.
-     * @return allocated object pointer.
+     * @return allocated object pointer - in case of success.
+     * @return nullptr - in case of there are no free slabs left.
      */
     void *alloc(uint8_t flags) noexcept;
 
     /**
-     * @brief Free a single slab.
+     * @brief Free cache object.
      *
-     * @param [in] slab - given slab to free.
+     * @param [in] objp - given object to free.
      */
-    void free_slab(slab_t *slab) noexcept;
+    void free(void *objp) noexcept;
 
     /**
-     * @brief Free cache object.
+     * @brief Get cache statistics summed over all CPUs.
      *
-     * @param [in] objp - given object to free.
+     * @param [out] stats - given statistics to fill.
      */
-    void free(void *objp) noexcept;
+    void stats(cache_stats_t& stats) const noexcept;
 };
 
 /** @brief Initialize SLAB allocator.*/
 void init(void) noexcept;
 
+/** @brief Display statistics of the predefined caches.*/
+void slabinfo(void) noexcept;
+
 } // namespace kmem
 
 /**
@@ -122,6 +204,22 @@ void *kmalloc(size_t size, gfp_t flags) noexcept;
  */
 void kfree(const void *objp) noexcept;
 
+/**
+ * @brief Reallocate memory allocated by kmalloc().
+ *
+ * @details Returns the same pointer if @a new_size still fits the
+ * current allocation size class. Page-backed allocations are grown
+ * in place if adjacent pages are free and shrunk in place otherwise.
+ * Only if neither works the memory is moved to a new allocation.
+ *
+ * @param [in] objp - given object to reallocate.
+ * @param [in] new_size - given new size of memory block.
+ * @param [in] flags - given allocation flags.
+ * @return pointer to the reallocated memory in case of success.
+ * @return nullptr in case of failure (@a objp is left untouched).
+ */
+void *krealloc(const void *objp, size_t new_size, gfp_t flags) noexcept;
+
 /**
  * @brief Get actual allocation size of associated object.
  *
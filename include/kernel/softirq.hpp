@@ -0,0 +1,136 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  softirq.hpp
+ * @brief Declares softirq & tasklet bottom halves.
+ *
+ * @details Interrupt handlers raise softirqs to defer work that does not
+ * have to run with interrupts disabled. Pending softirqs run on interrupt
+ * exit with interrupts enabled. Work raised again while they run is
+ * restarted within a budget, the rest is left to ksoftirqd.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#ifndef _KERNEL_SOFTIRQ_HPP_
+#define _KERNEL_SOFTIRQ_HPP_
+
+#include <kernel/percpu.hpp>
+
+
+namespace kernel {
+namespace core {
+
+inline const uint32_t MAX_SOFTIRQ_RESTART   {10};       // passes over pending softirqs on interrupt exit
+inline const uint64_t SOFTIRQ_BUDGET_CYCLES {2000000};  // time spent on interrupt exit (~1 ms at 2 GHz)
+
+// softirq vectors enumeration (lower runs first)
+enum SOFTIRQ : uint32_t {
+    TIMER,
+    NET_RX,
+    BLOCK,
+    TASKLET,
+    NR_SOFTIRQS
+};
+
+// softirq handler type (called with interrupts enabled)
+using softirq_action_t = void (*)(void) noexcept;
+
+struct softirq_stats_t
+{
+    uint32_t m_count[NR_SOFTIRQS];  // handler runs
+    uint32_t m_deferred;            // times budget was exceeded
+    uint32_t m_ksoftirqd;           // ksoftirqd runs
+};
+
+extern percpu_t<uint32_t>        softirq_pending;  // raised vectors mask
+extern percpu_t<softirq_stats_t> softirq_stats;
+
+/** @brief Initialize tasklet queues & handler.*/
+void softirq_init(void) noexcept;
+
+/**
+ * @brief Set softirq handler.
+ *
+ * @param [in] nr - given softirq vector.
+ * @param [in] action - given handler.
+ */
+void open_softirq(uint32_t nr, softirq_action_t action) noexcept;
+
+/**
+ * @brief Mark softirq pending on current CPU (interrupts disabled).
+ *
+ * @param [in] nr - given softirq vector.
+ */
+inline void raise_softirq_irqoff(uint32_t nr) noexcept
+{
+    softirq_pending.this_cpu() |= (1 << nr);
+}
+
+/**
+ * @brief Mark softirq pending on current CPU.
+ *
+ * @param [in] nr - given softirq vector.
+ */
+void raise_softirq(uint32_t nr) noexcept;
+
+/** @brief Run pending softirqs on interrupt exit (interrupts disabled).*/
+void irq_exit(void) noexcept;
+
+/**
+ * @brief Start ksoftirqd thread of current CPU.
+ *
+ * @return true - in case of success.
+ * @return false - in case of allocation error.
+ */
+bool spawn_ksoftirqd(void) noexcept;
+
+/** @brief Tasklet: softirq work item that never runs on two CPUs at once.*/
+struct tasklet_t
+{
+    tasklet_t         *m_next;
+    void             (*m_func)(void *data) noexcept;
+    void              *m_data;
+    volatile uint32_t  m_scheduled;  // 1 - tasklet is queued
+};
+
+/**
+ * @brief Initialize tasklet.
+ *
+ * @param [out] t - given tasklet.
+ * @param [in] func - given tasklet function.
+ * @param [in] data - given data passed to function.
+ */
+void tasklet_init(tasklet_t *t, void (*func)(void *data) noexcept, void *data) noexcept;
+
+/**
+ * @brief Queue tasklet on current CPU unless it is already queued.
+ *
+ * @param [in] t - given tasklet.
+ */
+void tasklet_schedule(tasklet_t *t) noexcept;
+
+/** @brief Display softirq counters.*/
+void softirqstat(void) noexcept;
+
+} // namespace core
+} // namespace kernel
+
+#endif // _KERNEL_SOFTIRQ_HPP_
@@ -0,0 +1,89 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  spinlock.hpp
+ * @brief Contains spinlock declaration.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_SPINLOCK_HPP_
+#define _KERNEL_SPINLOCK_HPP_
+
+#include <kernel/arch/x86/system.hpp>
+#include <kernel/arch/x86/atomic.hpp>
+
+
+namespace kernel {
+
+struct spinlock_t
+{
+    volatile uint32_t m_locked; // 1 if lock is held
+
+    /** @brief Initialize spinlock.*/
+    inline void init(void) noexcept
+    {
+        m_locked = 0;
+    }
+
+    /** @brief Acquire spinlock.*/
+    inline void lock(void) noexcept
+    {
+        while (arch::x86::xchg(&m_locked, 1)) {
+            // wait with plain reads to keep the cache line shared
+            while (m_locked)
+                arch::x86::cpu_relax();
+        }
+    }
+
+    /** @brief Release spinlock.*/
+    inline void unlock(void) noexcept
+    {
+        arch::x86::barrier();
+        m_locked = 0;
+    }
+
+    /**
+     * @brief Disable interrupts and acquire spinlock.
+     *
+     * @return saved EFLAGS register value.
+     */
+    inline uint32_t lock_irqsave(void) noexcept
+    {
+        auto flags = arch::x86::irq_save();
+        lock();
+        return flags;
+    }
+
+    /**
+     * @brief Release spinlock and restore interrupts.
+     *
+     * @param [in] flags - given saved EFLAGS register value.
+     */
+    inline void unlock_irqrestore(uint32_t flags) noexcept
+    {
+        unlock();
+        arch::x86::irq_restore(flags);
+    }
+};
+
+} // namespace kernel
+
+#endif // _KERNEL_SPINLOCK_HPP_
@@ -0,0 +1,343 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  swap.hpp
+ * @brief Declares anonymous memory swapping & page reclaim.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_SWAP_HPP_
+#define _KERNEL_SWAP_HPP_
+
+#include <kernel/mm_types.hpp>
+#include <kernel/vmm.hpp>
+
+
+namespace kernel {
+namespace core {
+namespace memory {
+
+inline const uint32_t MAX_SWAPFILES      {4};   // number of swap devices
+inline const uint32_t SWAP_CLUSTER_PAGES {8};   // slots read around swapped in one (power of two)
+inline const uint32_t SWAP_SCAN_BATCH    {32};  // pages scanned per list per reclaim pass
+inline const uint32_t SWAP_MAP_MAX       {0xFFFF};
+
+// non-present page table entry holds swap entry (bit is ignored by CPU)
+inline const uint32_t PTE_SWAP {0b10};
+
+// swap header (Linux mkswap format) occupies slot 0 of swap disk
+inline const char     SWAP_MAGIC[]       {"SWAPSPACE2"};
+inline const uint32_t SWAP_MAGIC_LEN     {10};
+inline const uint32_t SWAP_MAGIC_OFFSET  {PAGE_SIZE - SWAP_MAGIC_LEN};
+inline const uint32_t SWAP_HEADER_OFFSET {1024};    // boot sector space is skipped
+
+/** @brief Swap header info following boot sector space.*/
+struct swap_header_t
+{
+    uint32_t m_version;     // header version (1)
+    uint32_t m_last_page;   // the last usable slot
+    uint32_t m_nr_badpages;
+    uint8_t  m_uuid[16];
+    char     m_volume_name[16];
+} __attribute__((packed));
+
+/** @brief Swap slot identifier: slot offset & swap device index.*/
+struct swp_entry_t
+{
+    uint32_t m_val; // (offset << 2) | type (0 - no entry)
+};
+
+/**
+ * @brief Make swap entry.
+ *
+ * @param [in] type - given swap device index.
+ * @param [in] offset - given slot offset.
+ * @return swap entry.
+ */
+constexpr inline swp_entry_t swp_entry(uint32_t type, uint32_t offset) noexcept
+{
+    return {(offset << 2) | type};
+}
+
+/**
+ * @brief Get swap device index of entry.
+ *
+ * @param [in] entry - given swap entry.
+ * @return swap device index.
+ */
+constexpr inline uint32_t swp_type(swp_entry_t entry) noexcept
+{
+    return entry.m_val & 0b11;
+}
+
+/**
+ * @brief Get slot offset of entry.
+ *
+ * @param [in] entry - given swap entry.
+ * @return slot offset.
+ */
+constexpr inline uint32_t swp_offset(swp_entry_t entry) noexcept
+{
+    return entry.m_val >> 2;
+}
+
+/**
+ * @brief Convert swap entry to non-present page table entry.
+ *
+ * @param [in] entry - given swap entry.
+ * @return page table entry.
+ */
+constexpr inline pte_t swp_entry_to_pte(swp_entry_t entry) noexcept
+{
+    return (entry.m_val << 2) | PTE_SWAP;
+}
+
+/**
+ * @brief Convert non-present page table entry to swap entry.
+ *
+ * @param [in] pte - given page table entry.
+ * @return swap entry.
+ */
+constexpr inline swp_entry_t pte_to_swp_entry(pte_t pte) noexcept
+{
+    return {pte >> 2};
+}
+
+/**
+ * @brief Check whether page table entry refers to swapped out page.
+ *
+ * @param [in] pte - given page table entry.
+ * @return true - in case of entry holds swap entry.
+ * @return false - otherwise.
+ */
+constexpr inline bool is_swap_pte(pte_t pte) noexcept
+{
+    return !(pte & PTE_PRESENT) && (pte & PTE_SWAP);
+}
+
+/** @brief Swap device operations.*/
+struct swap_ops_t
+{
+    /**
+     * @brief Read page from slot.
+     *
+     * @param [in] priv - given device private data.
+     * @param [in] offset - given slot offset.
+     * @param [out] buf - given page sized buffer to fill.
+     * @return true - in case of success.
+     * @return false - in case of I/O error.
+     */
+    bool (*m_read)(void *priv, uint32_t offset, void *buf) noexcept;
+
+    /**
+     * @brief Write page to slot.
+     *
+     * @param [in] priv - given device private data.
+     * @param [in] offset - given slot offset.
+     * @param [in] buf - given page sized buffer.
+     * @return true - in case of success.
+     * @return false - in case of I/O error or device is full.
+     */
+    bool (*m_write)(void *priv, uint32_t offset, const void *buf) noexcept;
+
+    /**
+     * @brief Release slot contents (nullptr - nothing to release).
+     *
+     * @param [in] priv - given device private data.
+     * @param [in] offset - given slot offset.
+     */
+    void (*m_discard)(void *priv, uint32_t offset) noexcept;
+};
+
+/** @brief Swap device.*/
+struct swap_info_t
+{
+    const char       *m_name;
+    const swap_ops_t *m_ops;
+    void             *m_private;    // device private data
+    int32_t           m_prio;       // devices with higher priority are used first
+    uint32_t          m_pages;      // number of slots (slot 0 is never used)
+    uint32_t          m_inuse;      // number of used slots
+    uint32_t          m_next;       // next slot to allocate
+    uint16_t         *m_swap_map;   // number of entries referring to slot (0 - free)
+    page_t          **m_cache;      // swap cache indexed by slot offset
+};
+
+/** @brief Swapping & reclaim counters.*/
+struct swap_stats_t
+{
+    uint32_t m_pswpin;      // pages read from swap devices
+    uint32_t m_pswpout;     // pages written to swap devices
+    uint32_t m_readahead;   // pages read around faulting slot
+    uint32_t m_cache_hits;  // swap-ins served by swap cache
+    uint32_t m_scanned;     // inactive pages scanned
+    uint32_t m_activated;   // referenced inactive pages moved to active list
+    uint32_t m_deactivated; // unreferenced active pages moved to inactive list
+    uint32_t m_reclaimed;   // pages freed by reclaim
+    uint32_t m_failed;      // swap-outs failed due to full devices or I/O errors
+};
+
+/** @brief Reclaim list of pages ordered by last reference check.*/
+struct lru_list_t
+{
+    page_t  *m_head;    // most recently added page
+    page_t  *m_tail;    // least recently added page
+    uint32_t m_count;
+};
+
+extern swap_info_t  swap_info[MAX_SWAPFILES];
+extern uint32_t     nr_swapfiles;
+extern swap_stats_t swap_stats;
+extern lru_list_t   lru_active;
+extern lru_list_t   lru_inactive;
+
+/**
+ * @brief Add page to inactive reclaim list.
+ *
+ * @param [in] page - given page struct.
+ */
+void lru_add(page_t *page) noexcept;
+
+/**
+ * @brief Remove page from reclaim list.
+ *
+ * @param [in] page - given page struct.
+ */
+void lru_del(page_t *page) noexcept;
+
+/**
+ * @brief Record address space mapping anonymous page.
+ *
+ * @details Reclaim finds page table entry of the page through it,
+ * so only pages recorded this way can be swapped out.
+ *
+ * @param [in] page - given page struct.
+ * @param [in] mm - given address space.
+ * @param [in] addr - given virtual address.
+ */
+void page_add_anon_rmap(page_t *page, mm_t *mm, uint32_t addr) noexcept;
+
+/**
+ * @brief Forget address space that stopped mapping anonymous page.
+ *
+ * @param [in] page - given page struct.
+ * @param [in] mm - given address space.
+ */
+inline void page_remove_rmap(page_t *page, const mm_t *mm) noexcept
+{
+    if (page->m_mm == mm)
+        page->m_mm = nullptr;
+}
+
+/**
+ * @brief Free memory by swapping out least recently used anonymous pages.
+ *
+ * @param [in] nr_pages - given number of pages to free.
+ * @return number of freed pages.
+ */
+uint32_t shrink_memory(uint32_t nr_pages) noexcept;
+
+/**
+ * @brief Add swap device.
+ *
+ * @param [in] name - given device name.
+ * @param [in] ops - given device operations.
+ * @param [in] priv - given device private data.
+ * @param [in] pages - given device size in pages.
+ * @param [in] prio - given device priority.
+ * @return true - in case of success.
+ * @return false - in case of too many devices or allocation error.
+ */
+bool swapon(const char *name, const swap_ops_t *ops, void *priv, uint32_t pages, int32_t prio) noexcept;
+
+/**
+ * @brief Allocate swap slot on device with the highest priority.
+ *
+ * @return swap entry - in case of success.
+ * @return empty entry - in case of all devices are full.
+ */
+swp_entry_t get_swap_page(void) noexcept;
+
+/**
+ * @brief Take another reference to swap slot.
+ *
+ * @param [in] entry - given swap entry.
+ * @return true - in case of success.
+ * @return false - in case of slot reference count overflow.
+ */
+bool swap_duplicate(swp_entry_t entry) noexcept;
+
+/**
+ * @brief Drop reference to swap slot and free it after the last one.
+ *
+ * @param [in] entry - given swap entry.
+ */
+void swap_free(swp_entry_t entry) noexcept;
+
+/**
+ * @brief Write page to swap slot.
+ *
+ * @param [in] entry - given swap entry.
+ * @param [in] page - given page struct.
+ * @return true - in case of success.
+ * @return false - in case of I/O error.
+ */
+bool swap_writepage(swp_entry_t entry, page_t *page) noexcept;
+
+/**
+ * @brief Remove unmapped page from swap cache freeing it.
+ *
+ * @param [in] page - given page struct.
+ */
+void delete_from_swap_cache(page_t *page) noexcept;
+
+/**
+ * @brief Get swap slot page reading it & neighbouring slots if needed.
+ *
+ * @details Slots of the aligned cluster around the entry are read into
+ * swap cache too, since pages swapped out together are likely to be
+ * swapped in together.
+ *
+ * @param [in] entry - given swap entry.
+ * @return swap cache page - in case of success.
+ * @return nullptr - in case of allocation or I/O error.
+ */
+page_t *swapin_readahead(swp_entry_t entry) noexcept;
+
+/**
+ * @brief Add swap partition of primary IDE disk.
+ *
+ * @details Disk is used only if it carries swap header in slot 0,
+ * which is never allocated.
+ *
+ * @return true - in case of disk with swap header is present.
+ * @return false - otherwise.
+ */
+bool swap_init(void) noexcept;
+
+/** @brief Display swap devices & swapping counters.*/
+void swapinfo(void) noexcept;
+
+} // namespace memory
+} // namespace core
+} // namespace kernel
+
+#endif // _KERNEL_SWAP_HPP_
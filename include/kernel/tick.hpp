@@ -0,0 +1,119 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  tick.hpp
+ * @brief Declares periodic tick stopped while CPU is idle.
+ *
+ * @details Tick is high-resolution timer, so it is emulated by one-shot
+ * events of the best clockevent device. Idle CPU programs device for the next expiring event only,
+ * or stops it entirely if there is none.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#ifndef _KERNEL_TICK_HPP_
+#define _KERNEL_TICK_HPP_
+
+#include <kernel/arch/x86/system.hpp>
+#include <kernel/clocksource.hpp>
+#include <kernel/hrtimer.hpp>
+#include <kernel/percpu.hpp>
+
+
+namespace kernel {
+namespace core {
+
+inline const uint32_t HZ        {100};              // ticks per second of busy CPU
+inline const uint32_t TICK_NSEC {NSEC_PER_SEC / HZ};
+
+/** @brief Per-CPU tick state.*/
+struct tick_sched_t
+{
+    hrtimer_t m_timer;          // tick timer
+    bool      m_stopped;        // tick is stopped in idle
+    uint64_t  m_next_tick;      // expiry of the next tick (ns)
+    uint64_t  m_idle_start;     // time CPU went idle
+    uint64_t  m_idle_ns;        // total idle time
+    uint32_t  m_ticks;          // tick interrupts
+    uint32_t  m_wakeups;        // idle periods ended by interrupt
+    uint32_t  m_rate;           // wakeups per second of the last sample
+    uint32_t  m_rate_wakeups;   // wakeups at sample start
+    uint64_t  m_rate_start;     // sample start time
+};
+
+extern volatile uint64_t       jiffies;            // ticks since boot
+extern bool                    tick_nohz_active;   // tick is stopped in idle
+extern percpu_t<tick_sched_t>  tick_sched;
+
+/**
+ * @brief Get number of ticks since boot.
+ *
+ * @return jiffies.
+ */
+inline uint64_t get_jiffies(void) noexcept
+{
+    // 64-bit value is updated by two stores
+    auto     flags = arch::x86::irq_save();
+    uint64_t ret   = jiffies;
+    arch::x86::irq_restore(flags);
+
+    return ret;
+}
+
+/**
+ * @brief Convert milliseconds to jiffies rounding up.
+ *
+ * @param [in] ms - given number of milliseconds.
+ * @return number of jiffies.
+ */
+inline uint32_t msecs_to_jiffies(uint32_t ms) noexcept
+{
+    return (ms * HZ + MSEC_PER_SEC - 1) / MSEC_PER_SEC;
+}
+
+/**
+ * @brief Start tick timer.
+ *
+ * @return true - in case of success.
+ * @return false - in case of hrtimers have no clockevent device.
+ */
+bool tick_init(void) noexcept;
+
+/** @brief Stop tick before CPU goes idle (interrupts disabled).*/
+void tick_nohz_idle_enter(void) noexcept;
+
+/** @brief Restart tick & account idle time (interrupts disabled).*/
+void tick_nohz_idle_exit(void) noexcept;
+
+/**
+ * @brief Halt CPU until interrupt with tick stopped.
+ *
+ * @details Called with interrupts disabled, returns with interrupts
+ * enabled after the wakeup interrupt has been handled.
+ */
+void cpu_idle(void) noexcept;
+
+/** @brief Print tick & idle statistics.*/
+void tickstat(void) noexcept;
+
+} // namespace core
+} // namespace kernel
+
+#endif // _KERNEL_TICK_HPP_
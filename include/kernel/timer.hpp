@@ -0,0 +1,162 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  timer.hpp
+ * @brief Declares per-CPU hierarchical timer wheel.
+ *
+ * @details Timeout is put into one of 256 per-jiffy slots or into a
+ * coarser slot of 4 levels of 64 slots, so adding & cancelling timers
+ * is O(1). Coarse slots are cascaded into finer ones when time reaches
+ * them. Expired timers run in batches from the timer softirq.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#ifndef _KERNEL_TIMER_HPP_
+#define _KERNEL_TIMER_HPP_
+
+#include <kernel/percpu.hpp>
+
+
+namespace kernel {
+namespace core {
+
+inline const uint32_t TVR_BITS   {8};   // per-jiffy level
+inline const uint32_t TVN_BITS   {6};   // each cascading level
+inline const uint32_t TVN_LEVELS {4};
+inline const uint32_t TVR_SIZE   {1 << TVR_BITS};
+inline const uint32_t TVN_SIZE   {1 << TVN_BITS};
+inline const uint32_t TVR_MASK   {TVR_SIZE - 1};
+inline const uint32_t TVN_MASK   {TVN_SIZE - 1};
+
+inline const int32_t  TIMER_SLACK_AUTO {-1};    // timer may be delayed by 0.4% of timeout
+
+/** @brief Timeout on timer wheel.*/
+struct timer_list_t
+{
+    timer_list_t  *m_next;
+    timer_list_t **m_pprev;     // nullptr - timer is not pending
+    uint32_t       m_expires;   // jiffies
+    int32_t        m_slack;     // jiffies expiry may be delayed by to coalesce timers
+    uint32_t       m_cpu;       // wheel timer is queued on
+    void         (*m_func)(void *data) noexcept;
+    void          *m_data;
+};
+
+/** @brief Per-CPU timer wheel.*/
+struct timer_base_t
+{
+    uint32_t      m_jiffies;                    // the next jiffy to be processed
+    uint32_t      m_pending;                    // number of queued timers
+    timer_list_t *m_tv1[TVR_SIZE];
+    timer_list_t *m_tvn[TVN_LEVELS][TVN_SIZE];
+};
+
+struct timer_stats_t
+{
+    uint32_t m_added;       // timers queued
+    uint32_t m_cancelled;   // timers deleted before expiry
+    uint32_t m_expired;     // timer functions called
+    uint32_t m_cascaded;    // timers moved to finer level
+    uint32_t m_batches;     // jiffies that expired at least one timer
+};
+
+extern percpu_t<timer_stats_t> timer_stats;
+
+/**
+ * @brief Check whether timer is queued.
+ *
+ * @param [in] t - given timer.
+ * @return true - if timer is pending.
+ * @return false - otherwise.
+ */
+inline bool timer_pending(const timer_list_t *t) noexcept
+{
+    return t->m_pprev;
+}
+
+/** @brief Initialize timer wheels & timer softirq.*/
+void timers_init(void) noexcept;
+
+/**
+ * @brief Initialize timer.
+ *
+ * @param [out] t - given timer.
+ * @param [in] func - given function called in softirq context on expiry.
+ * @param [in] data - given data passed to function.
+ */
+void timer_init(timer_list_t *t, void (*func)(void *data) noexcept, void *data) noexcept;
+
+/**
+ * @brief Set how late timer is allowed to fire.
+ *
+ * @details Expiry is rounded up within slack to a jiffy with more low
+ * bits cleared, so nearby timeouts fire together.
+ *
+ * @param [out] t - given timer.
+ * @param [in] slack - given slack in jiffies (TIMER_SLACK_AUTO - 0.4% of timeout).
+ */
+void set_timer_slack(timer_list_t *t, int32_t slack) noexcept;
+
+/**
+ * @brief Queue timer or change its expiry.
+ *
+ * @param [in] t - given initialized timer.
+ * @param [in] expires - given expiry in jiffies.
+ * @return true - if timer was pending.
+ * @return false - otherwise.
+ */
+bool mod_timer(timer_list_t *t, uint32_t expires) noexcept;
+
+/**
+ * @brief Queue timer with expiry already set.
+ *
+ * @param [in] t - given initialized timer.
+ */
+void add_timer(timer_list_t *t) noexcept;
+
+/**
+ * @brief Cancel timer.
+ *
+ * @param [in] t - given timer.
+ * @return true - if timer was pending.
+ * @return false - otherwise.
+ */
+bool del_timer(timer_list_t *t) noexcept;
+
+/** @brief Raise timer softirq if timers of current CPU are due (interrupts disabled).*/
+void run_local_timers(void) noexcept;
+
+/**
+ * @brief Get expiry of the earliest timer of current CPU (interrupts disabled).
+ *
+ * @param [out] expires - given expiry in jiffies since boot.
+ * @return true - in case of pending timer.
+ * @return false - in case of there are no timers.
+ */
+bool next_timer_expiry(uint64_t& expires) noexcept;
+
+/** @brief Display timer wheel counters.*/
+void timerstat(void) noexcept;
+
+} // namespace core
+} // namespace kernel
+
+#endif // _KERNEL_TIMER_HPP_
@@ -0,0 +1,134 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  tlb.hpp
+ * @brief Declares batched TLB invalidation.
+ *
+ * @details Page table updates record changed entries into a gather and
+ * invalidate TLB once at the end: page by page for a few entries and by
+ * reloading CR3 above the flush ceiling. Flushes of user mappings are
+ * deferred while CPU runs a kernel thread that does not touch them.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_TLB_HPP_
+#define _KERNEL_TLB_HPP_
+
+#include <kernel/mm_types.hpp>
+#include <kernel/percpu.hpp>
+#include <kernel/vmm.hpp>
+
+
+namespace kernel {
+namespace core {
+namespace memory {
+
+inline const uint32_t TLB_GATHER_PAGES {32}; // pages released after flush per batch
+inline const uint32_t TLB_GATHER_ADDRS {64}; // addresses recorded for invalidation one by one
+
+// max number of entries invalidated one by one, up to TLB_GATHER_ADDRS (more reload CR3)
+extern uint32_t tlb_flush_ceiling;
+
+/** @brief TLB flush counters by reason.*/
+struct tlb_stats_t
+{
+    uint32_t m_pages;       // pages invalidated with invlpg
+    uint32_t m_ranges;      // gathers invalidated page by page
+    uint32_t m_full;        // gathers above ceiling invalidated by CR3 reload
+    uint32_t m_global;      // gathers with global entries above ceiling
+    uint32_t m_skipped;     // ranges of address spaces not loaded on CPU
+    uint32_t m_lazy;        // flushes deferred in lazy TLB mode
+    uint32_t m_lazy_done;   // deferred flushes done on leaving lazy TLB mode
+    uint32_t m_switch;      // address space switches
+};
+
+/** @brief CPU TLB state.*/
+struct tlb_state_t
+{
+    bool m_lazy;        // kernel thread borrows loaded address space
+    bool m_need_flush;  // user mappings flush was deferred
+};
+
+extern percpu_t<tlb_stats_t> tlb_stats;
+extern percpu_t<tlb_state_t> tlb_state;
+
+/** @brief Changed page table entries waiting for TLB invalidation.*/
+struct tlb_gather_t
+{
+    pde_t   *m_pgdir;   // page directory of gathered entries
+    uint32_t m_start;   // lowest gathered address
+    uint32_t m_end;     // end of the highest gathered page
+    uint32_t m_count;   // number of gathered entries
+    bool     m_global;  // global entry was gathered
+    uint32_t m_addrs[TLB_GATHER_ADDRS]; // first gathered addresses
+    uint32_t m_nr_pages;                // number of pages to release
+    page_t  *m_pages[TLB_GATHER_PAGES]; // unmapped pages released after flush
+
+    /**
+     * @brief Start gathering.
+     *
+     * @param [in] pgdir - given page directory to update.
+     */
+    void init(pde_t *pgdir) noexcept;
+
+    /**
+     * @brief Record changed page table entry.
+     *
+     * @param [in] addr - given virtual address.
+     * @param [in] old - given entry value before the change.
+     */
+    void add(uint32_t addr, pte_t old) noexcept;
+
+    /**
+     * @brief Drop page reference after gathered entries are invalidated.
+     *
+     * @details Page cannot be reused while stale TLB entries may
+     * still point to it.
+     *
+     * @param [in] page - given unmapped page.
+     */
+    void release(page_t *page) noexcept;
+
+    /** @brief Invalidate gathered entries and start gathering again.*/
+    void finish(void) noexcept;
+};
+
+/**
+ * @brief Invalidate single page of active address space.
+ *
+ * @param [in] addr - given virtual address.
+ */
+void flush_tlb_page(uint32_t addr) noexcept;
+
+/** @brief Enter lazy TLB mode before running kernel thread.*/
+void enter_lazy_tlb(void) noexcept;
+
+/** @brief Leave lazy TLB mode performing deferred flush.*/
+void leave_lazy_tlb(void) noexcept;
+
+/** @brief Display TLB flush counters.*/
+void tlbstat(void) noexcept;
+
+} // namespace memory
+} // namespace core
+} // namespace kernel
+
+#endif // _KERNEL_TLB_HPP_
@@ -0,0 +1,186 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  vmm.hpp
+ * @brief Declares virtual memory manager.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_VMM_HPP_
+#define _KERNEL_VMM_HPP_
+
+#include <kernel/multiboot.hpp>
+#include <kernel/memlayout.hpp>
+#include <kernel/types.hpp>
+
+
+namespace kernel {
+namespace core {
+namespace memory {
+
+using pde_t = uint32_t; // page directory entry
+using pte_t = uint32_t; // page table entry
+
+// Page directory/table entry flags:
+inline const uint32_t PTE_PRESENT  {0b000000001};
+inline const uint32_t PTE_WRITE    {0b000000010};
+inline const uint32_t PTE_USER     {0b000000100};
+inline const uint32_t PTE_PWT      {0b000001000}; // write-through
+inline const uint32_t PTE_PCD      {0b000010000}; // cache disabled
+inline const uint32_t PTE_ACCESSED {0b000100000};
+inline const uint32_t PTE_DIRTY    {0b001000000};
+inline const uint32_t PTE_LARGE    {0b010000000}; // 4 MB page (PDE only)
+inline const uint32_t PTE_GLOBAL   {0b100000000};
+
+inline const uint32_t PGDIR_ENTRIES   {1024};
+inline const uint32_t PTRS_PER_PTE    {1024};
+inline const uint8_t  PGDIR_SHIFT     {22};
+inline const uint32_t PTE_ADDR_MASK   {0xFFFFF000};
+inline const uint32_t LARGE_PAGE_SIZE {0x400000};
+inline const uint32_t LARGE_PAGE_MASK {~(LARGE_PAGE_SIZE - 1)};
+
+// the last page directory entry maps page directory itself, so page
+// tables of active address space are visible as a 4 MB array of PTEs
+inline const uint32_t RECURSIVE_PDE {PGDIR_ENTRIES - 1};
+inline const uint32_t PTE_BASE      {RECURSIVE_PDE << PGDIR_SHIFT};         // page tables window
+inline const uint32_t PDE_BASE      {PTE_BASE | (RECURSIVE_PDE << 12)};    // page directory window
+
+/**
+ * @brief Get page table entry of active address space.
+ *
+ * @warning Page table of the address must be present.
+ *
+ * @param [in] vaddr - given virtual address.
+ * @return page table entry pointer.
+ */
+inline pte_t *pte_for(uint32_t vaddr) noexcept
+{
+    return reinterpret_cast<pte_t*>(PTE_BASE + (vaddr >> 12) * sizeof(pte_t));
+}
+
+/**
+ * @brief Get page directory entry of active address space.
+ *
+ * @param [in] vaddr - given virtual address.
+ * @return page directory entry pointer.
+ */
+inline pde_t *pde_for(uint32_t vaddr) noexcept
+{
+    return reinterpret_cast<pde_t*>(PDE_BASE + (vaddr >> PGDIR_SHIFT) * sizeof(pde_t));
+}
+
+struct tlb_gather_t;
+
+/**
+ * @brief Handle page table entry removed by unmap_range().
+ *
+ * @param [in] addr - given virtual address.
+ * @param [in] pte - given removed page table entry.
+ * @param [in,out] tlb - given gather the entry was added to.
+ */
+using unmap_fn_t = void (*)(uint32_t addr, pte_t pte, tlb_gather_t *tlb) noexcept;
+
+struct virt_mman_t
+{
+    pde_t      *m_pgdir;        // kernel page directory
+    pde_t      *m_active;       // page directory loaded into CR3
+    phys_addr_t m_lowmem_end;   // end of direct-mapped physical memory
+    uint32_t    m_ioremap_next; // next free ioremap area address
+    uint32_t    m_global;       // PTE_GLOBAL if supported by CPU
+
+    /**
+     * @brief Initialize the virtual memory manager.
+     *
+     * @details Maps physical memory at PAGE_OFFSET and drops
+     * identity mapping set by bootloader code.
+     *
+     * @param [in] mboot - given multiboot information structure.
+     */
+    void init(const multiboot_t& mboot) noexcept;
+
+    /**
+     * @brief Map device memory into the kernel address space.
+     *
+     * @param [in] addr - given physical address of the region.
+     * @param [in] size - given size of the region in bytes.
+     * @return virtual address of the region - in case of success.
+     * @return nullptr - in case of ioremap area is exhausted.
+     */
+    void *ioremap(phys_addr_t addr, size_t size) noexcept;
+
+    /**
+     * @brief Load page directory into CR3.
+     *
+     * @param [in] pgdir - given page directory.
+     */
+    void load(pde_t *pgdir) noexcept;
+
+    /**
+     * @brief Map physical range into active address space.
+     *
+     * @details Page tables are walked once per 4 MB and TLB is flushed
+     * once at the end if present entries were replaced.
+     *
+     * @param [in] virt - given page aligned virtual address.
+     * @param [in] phys - given page aligned physical address.
+     * @param [in] size - given range size in bytes.
+     * @param [in] flags - given page table entry flags.
+     * @return true - in case of success.
+     * @return false - in case of page table allocation error.
+     */
+    bool map_range(uint32_t virt, phys_addr_t phys, size_t size, uint32_t flags) noexcept;
+
+    /**
+     * @brief Unmap range of active address space.
+     *
+     * @details Missing page tables are skipped entirely and TLB is
+     * flushed once at the end. Non-present entries that are not empty
+     * (swap entries) are removed and passed to callback too.
+     *
+     * @param [in] virt - given page aligned virtual address.
+     * @param [in] size - given range size in bytes.
+     * @param [in] fn - given optional callback for each removed entry.
+     * @param [in,out] tlb - given optional gather to defer flush to (nullptr - flush now).
+     */
+    void unmap_range(uint32_t virt, size_t size, unmap_fn_t fn = nullptr, tlb_gather_t *tlb = nullptr) noexcept;
+};
+
+extern virt_mman_t vmm;
+
+/**
+ * @brief Get page table entry of virtual address.
+ *
+ * @details Page tables of active address space are accessed through the
+ * recursive mapping, other ones through the direct map.
+ *
+ * @param [in] pgdir - given page directory.
+ * @param [in] addr - given virtual address.
+ * @param [in] alloc - given flag to allocate missing page table.
+ * @return page table entry pointer - in case of success.
+ * @return nullptr - in case of page table is missing or mapped by 4 MB page.
+ */
+pte_t *get_pte(pde_t *pgdir, uint32_t addr, bool alloc) noexcept;
+
+} // namespace memory
+} // namespace core
+} // namespace kernel
+
+#endif // _KERNEL_VMM_HPP_
@@ -0,0 +1,99 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  zsmalloc.hpp
+ * @brief Declares compressed objects memory pool.
+ *
+ * @details Objects of arbitrary size up to half a page are packed into
+ * pages of fine-grained size classes, so that compressed data wastes less
+ * memory than in power of two kmalloc caches. Every pool page starts with
+ * a header, so freeing needs only the object address.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   18.10.2026
+ */
+
+#ifndef _KERNEL_ZSMALLOC_HPP_
+#define _KERNEL_ZSMALLOC_HPP_
+
+#include <kernel/mm_types.hpp>
+#include <kernel/gfp.hpp>
+
+
+namespace kernel {
+namespace core {
+namespace memory {
+
+/** @brief Header at the start of pool page.*/
+struct zspage_t
+{
+    zspage_t *m_prev;   // previous page of class with free objects
+    zspage_t *m_next;   // next page of class with free objects
+    void     *m_free;   // first free object (objects are linked through their first word)
+    uint16_t  m_inuse;  // number of allocated objects
+    uint16_t  m_class;  // size class index
+};
+
+inline const uint32_t ZS_ALIGN      {32};                           // size classes granularity
+inline const uint32_t ZS_MAX_ALLOC  {2048 - ZS_ALIGN};              // the largest object size
+inline const uint32_t ZS_NR_CLASSES {ZS_MAX_ALLOC / ZS_ALIGN};
+
+static_assert(sizeof(zspage_t) + 2 * ZS_MAX_ALLOC <= PAGE_SIZE);
+
+/** @brief Pages holding objects of the same size.*/
+struct zs_class_t
+{
+    uint32_t  m_size;       // object size
+    uint32_t  m_objs;       // objects per page
+    zspage_t *m_partial;    // pages with free objects
+    uint32_t  m_pages;      // number of pages
+    uint32_t  m_inuse;      // number of allocated objects
+};
+
+struct zs_pool_t
+{
+    zs_class_t m_classes[ZS_NR_CLASSES];
+    uint32_t   m_pages;     // number of pages of all classes
+
+    /** @brief Initialize empty pool.*/
+    void init(void) noexcept;
+
+    /**
+     * @brief Allocate object.
+     *
+     * @param [in] size - given object size (up to ZS_MAX_ALLOC).
+     * @param [in] flags - given allocation flags of new pages.
+     * @return object pointer - in case of success.
+     * @return nullptr - in case of allocation error.
+     */
+    void *alloc(uint32_t size, gfp_t flags) noexcept;
+
+    /**
+     * @brief Free object.
+     *
+     * @param [in] objp - given object pointer.
+     */
+    void free(void *objp) noexcept;
+};
+
+} // namespace memory
+} // namespace core
+} // namespace kernel
+
+#endif // _KERNEL_ZSMALLOC_HPP_
@@ -0,0 +1,246 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/acpi.hpp>
+#include <kernel/kstd/cstring.hpp>
+#include <kernel/vmm.hpp>
+
+
+namespace kernel {
+namespace arch {
+namespace x86 {
+namespace acpi {
+
+inline const phys_addr_t EBDA_PTR   {0x40E};    // real mode segment of Extended BIOS Data Area
+inline const phys_addr_t BIOS_START {0xE0000};
+inline const phys_addr_t BIOS_END   {0x100000};
+
+madt_info_t madt;
+
+static const sdt_header_t *root;    // RSDT or XSDT
+static uint32_t entry_size;         // size of root table entry
+
+/**
+ * @brief Get virtual address of firmware memory.
+ *
+ * @param [in] addr - given physical address.
+ * @param [in] size - given region size.
+ * @return virtual address - in case of success.
+ * @return nullptr - in case of region cannot be mapped.
+ */
+static const void *map_phys(phys_addr_t addr, size_t size) noexcept
+{
+    using namespace core::memory;
+
+    // tables are usually placed at the end of RAM
+    if (uint64_t(addr) + size <= vmm.m_lowmem_end)
+        return phys_to_virt(addr);
+
+    return vmm.ioremap(addr, size);
+}
+
+/**
+ * @brief Check that sum of bytes is zero.
+ *
+ * @param [in] ptr - given region.
+ * @param [in] size - given region size.
+ * @return true - in case of valid checksum.
+ * @return false - otherwise.
+ */
+static bool checksum(const void *ptr, size_t size) noexcept
+{
+    auto bytes  = static_cast<const uint8_t*>(ptr);
+    uint8_t sum = 0;
+
+    for (size_t i = 0; i < size; i++)
+        sum += bytes[i];
+
+    return sum == 0;
+}
+
+/**
+ * @brief Search RSDP in physical range.
+ *
+ * @param [in] start - given range start (16 bytes aligned).
+ * @param [in] end - given range end.
+ * @return RSDP - in case of success.
+ * @return nullptr - in case of RSDP is not found.
+ */
+static const rsdp_t *scan_rsdp(phys_addr_t start, phys_addr_t end) noexcept
+{
+    for (phys_addr_t addr = start; addr + sizeof(rsdp_t) <= end; addr += 16) {
+        auto rsdp = static_cast<const rsdp_t*>(core::memory::phys_to_virt(addr));
+
+        if (!kstd::memcmp(rsdp->m_signature, "RSD PTR ", 8) && checksum(rsdp, 20))
+            return rsdp;
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Map table with valid checksum.
+ *
+ * @param [in] addr - given table physical address.
+ * @return table - in case of success.
+ * @return nullptr - in case of table is corrupted.
+ */
+static const sdt_header_t *map_table(phys_addr_t addr) noexcept
+{
+    auto header = static_cast<const sdt_header_t*>(map_phys(addr, sizeof(sdt_header_t)));
+
+    if (!header)
+        return nullptr;
+
+    auto table = static_cast<const sdt_header_t*>(map_phys(addr, header->m_length));
+
+    if (!table || !checksum(table, table->m_length))
+        return nullptr;
+
+    return table;
+}
+
+const sdt_header_t *find_table(const char *signature) noexcept
+{
+    if (!root)
+        return nullptr;
+
+    uint32_t count = (root->m_length - sizeof(sdt_header_t)) / entry_size;
+    auto entries   = reinterpret_cast<const uint8_t*>(root + 1);
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t addr = 0;
+        kstd::memcpy(&addr, entries + i * entry_size, entry_size);
+
+        // tables above 4 GB are unreachable
+        if (addr >> 32)
+            continue;
+
+        auto header = static_cast<const sdt_header_t*>(map_phys(addr, sizeof(sdt_header_t)));
+
+        if (header && !kstd::memcmp(header->m_signature, signature, 4))
+            return map_table(addr);
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Fill interrupt controllers configuration from MADT.
+ *
+ * @param [in] table - given MADT.
+ */
+static void parse_madt(const madt_t *table) noexcept
+{
+    madt.m_present    = true;
+    madt.m_has_pic    = table->m_flags & MADT_PCAT_COMPAT;
+    madt.m_lapic_addr = table->m_lapic_addr;
+
+    // ISA interrupts are identity mapped, edge triggered & active high by default
+    for (uint32_t i = 0; i < ISA_IRQS; i++)
+        madt.m_isa_gsi[i] = i;
+
+    auto ptr = reinterpret_cast<const uint8_t*>(table + 1);
+    auto end = reinterpret_cast<const uint8_t*>(table) + table->m_header.m_length;
+
+    while (ptr + sizeof(madt_entry_t) <= end) {
+        auto entry = reinterpret_cast<const madt_entry_t*>(ptr);
+
+        if (entry->m_length < sizeof(madt_entry_t) || ptr + entry->m_length > end)
+            break;
+
+        switch (entry->m_type) {
+        case MADT::LAPIC: {
+            auto lapic = reinterpret_cast<const madt_lapic_t*>(entry);
+
+            if ((lapic->m_flags & 0x1) && madt.m_nr_cpus < NR_CPUS)
+                madt.m_apic_ids[madt.m_nr_cpus++] = lapic->m_apic_id;
+            break;
+        }
+
+        case MADT::IOAPIC: {
+            auto ioapic = reinterpret_cast<const madt_ioapic_t*>(entry);
+
+            if (madt.m_nr_ioapics < MAX_IOAPICS)
+                madt.m_ioapics[madt.m_nr_ioapics++] = {ioapic->m_id, ioapic->m_addr, ioapic->m_gsi_base};
+            break;
+        }
+
+        case MADT::ISO: {
+            auto iso = reinterpret_cast<const madt_iso_t*>(entry);
+
+            if (iso->m_source < ISA_IRQS) {
+                madt.m_isa_gsi[iso->m_source]   = iso->m_gsi;
+                madt.m_isa_flags[iso->m_source] = iso->m_flags;
+            }
+            break;
+        }
+
+        case MADT::LAPIC_OVERRIDE: {
+            auto override = reinterpret_cast<const madt_lapic_override_t*>(entry);
+
+            if (!(override->m_addr >> 32))
+                madt.m_lapic_addr = override->m_addr;
+            break;
+        }
+
+        default:
+            break;
+        }
+
+        ptr += entry->m_length;
+    }
+}
+
+bool init(void) noexcept
+{
+    using namespace core::memory;
+
+    auto ebda         = *static_cast<const uint16_t*>(phys_to_virt(EBDA_PTR)) << 4;
+    const rsdp_t *ptr = ebda ? scan_rsdp(ebda, ebda + 1_KB) : nullptr;
+
+    if (!ptr)
+        ptr = scan_rsdp(BIOS_START, BIOS_END);
+
+    if (!ptr)
+        return false;
+
+    // XSDT supersedes RSDT since ACPI 2.0
+    if (ptr->m_revision >= 2 && ptr->m_xsdt_addr && !(ptr->m_xsdt_addr >> 32) && checksum(ptr, ptr->m_length)) {
+        root       = map_table(ptr->m_xsdt_addr);
+        entry_size = sizeof(uint64_t);
+    }
+
+    if (!root) {
+        root       = map_table(ptr->m_rsdt_addr);
+        entry_size = sizeof(uint32_t);
+    }
+
+    auto table = find_table("APIC");
+
+    if (!table)
+        return false;
+
+    parse_madt(reinterpret_cast<const madt_t*>(table));
+    return true;
+}
+
+} // namespace acpi
+} // namespace x86
+} // namespace arch
+} // namespace kernel
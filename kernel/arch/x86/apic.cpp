@@ -0,0 +1,227 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/system.hpp>
+#include <kernel/arch/x86/cpuid.hpp>
+#include <kernel/arch/x86/acpi.hpp>
+#include <kernel/arch/x86/apic.hpp>
+#include <kernel/arch/x86/idt.hpp>
+#include <kernel/mm_types.hpp>
+#include <kernel/vmm.hpp>
+
+
+namespace kernel {
+namespace arch {
+namespace x86 {
+namespace apic {
+
+inline const uint32_t IOREGSEL       {0x00 >> 2};  // I/O APIC register select
+inline const uint32_t IOWIN          {0x10 >> 2};  // I/O APIC register data
+inline const uint32_t IOAPIC_VERSION {0x01};
+inline const uint32_t IOAPIC_REDTBL  {0x10};       // the first redirection entry
+
+// redirection entry bits:
+inline const uint32_t REDIR_ACTIVE_LOW {1 << 13};
+inline const uint32_t REDIR_LEVEL      {1 << 15};
+inline const uint32_t REDIR_MASKED     {1 << 16};
+
+/** @brief I/O APIC.*/
+struct ioapic_t
+{
+    volatile uint32_t *m_regs;
+    uint32_t           m_gsi_base;  // GSI of the first pin
+    uint32_t           m_nr_pins;
+};
+
+volatile uint32_t *lapic;
+
+static ioapic_t ioapics[acpi::MAX_IOAPICS];
+static uint32_t nr_ioapics;
+
+/**
+ * @brief Read I/O APIC register.
+ *
+ * @param [in] io - given I/O APIC.
+ * @param [in] reg - given register index.
+ * @return register value.
+ */
+static uint32_t io_read(const ioapic_t& io, uint32_t reg) noexcept
+{
+    io.m_regs[IOREGSEL] = reg;
+    return io.m_regs[IOWIN];
+}
+
+/**
+ * @brief Write I/O APIC register.
+ *
+ * @param [in] io - given I/O APIC.
+ * @param [in] reg - given register index.
+ * @param [in] value - given register value.
+ */
+static void io_write(const ioapic_t& io, uint32_t reg, uint32_t value) noexcept
+{
+    io.m_regs[IOREGSEL] = reg;
+    io.m_regs[IOWIN]    = value;
+}
+
+/**
+ * @brief Find I/O APIC pin of GSI.
+ *
+ * @param [in] gsi - given global system interrupt.
+ * @param [out] pin - given pin of found I/O APIC.
+ * @return I/O APIC - in case of success.
+ * @return nullptr - in case of GSI is not connected.
+ */
+static ioapic_t *find_ioapic(uint32_t gsi, uint32_t& pin) noexcept
+{
+    for (uint32_t i = 0; i < nr_ioapics; i++) {
+        ioapic_t& io = ioapics[i];
+
+        if (gsi >= io.m_gsi_base && gsi < io.m_gsi_base + io.m_nr_pins) {
+            pin = gsi - io.m_gsi_base;
+            return &io;
+        }
+    }
+
+    return nullptr;
+}
+
+/** @brief Enable local APIC of current CPU.*/
+static void lapic_init(void) noexcept
+{
+    wrmsr(MSR_APIC_BASE, rdmsr(MSR_APIC_BASE) | APIC_BASE_ENABLE);
+
+    // external interrupts of 8259 arrive through I/O APIC instead of LINT0
+    lapic_write(LAPIC_LVT_TIMER, LVT_MASKED);
+    lapic_write(LAPIC_LVT_ERROR, LVT_MASKED);
+    lapic_write(LAPIC_LVT_LINT0, LVT_MASKED);
+    lapic_write(LAPIC_LVT_LINT1, LVT_NMI);
+
+    lapic_write(LAPIC_TPR, 0);
+    lapic_write(LAPIC_SVR, SVR_ENABLE | idt::VEC_SPURIOUS);
+    lapic_eoi();
+}
+
+bool init(void) noexcept
+{
+    using namespace core::memory;
+
+    if (!has_feature(CPUID_EDX_APIC) || !acpi::madt.m_present || !acpi::madt.m_nr_ioapics)
+        return false;
+
+    lapic = static_cast<volatile uint32_t*>(vmm.ioremap(acpi::madt.m_lapic_addr, PAGE_SIZE));
+
+    if (!lapic)
+        return false;
+
+    for (uint32_t i = 0; i < acpi::madt.m_nr_ioapics; i++) {
+        const acpi::ioapic_info_t& info = acpi::madt.m_ioapics[i];
+        ioapic_t& io = ioapics[nr_ioapics];
+
+        io.m_regs = static_cast<volatile uint32_t*>(vmm.ioremap(info.m_addr, PAGE_SIZE));
+
+        if (!io.m_regs)
+            continue;
+
+        io.m_gsi_base = info.m_gsi_base;
+        io.m_nr_pins  = ((io_read(io, IOAPIC_VERSION) >> 16) & 0xFF) + 1;
+
+        for (uint32_t pin = 0; pin < io.m_nr_pins; pin++)
+            io_write(io, IOAPIC_REDTBL + pin * 2, REDIR_MASKED);
+
+        nr_ioapics++;
+    }
+
+    // local APIC is used only together with I/O APIC
+    if (!nr_ioapics) {
+        lapic = nullptr;
+        return false;
+    }
+
+    lapic_init();
+    return true;
+}
+
+uint32_t nr_gsis(void) noexcept
+{
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < nr_ioapics; i++) {
+        uint32_t end = ioapics[i].m_gsi_base + ioapics[i].m_nr_pins;
+
+        if (end > count)
+            count = end;
+    }
+
+    return count;
+}
+
+void route(uint32_t gsi, uint8_t vector, uint16_t inti, bool level, uint8_t dest) noexcept
+{
+    uint32_t pin;
+    ioapic_t *io = find_ioapic(gsi, pin);
+
+    if (!io)
+        return;
+
+    uint32_t polarity = inti & acpi::INTI_POLARITY_MASK;
+    uint32_t trigger  = inti & acpi::INTI_TRIGGER_MASK;
+    uint32_t entry    = REDIR_MASKED | vector;
+
+    // zero flags conform to bus: ISA is edge/high, PCI is level/low
+    if (polarity ? polarity == acpi::INTI_ACTIVE_LOW : level)
+        entry |= REDIR_ACTIVE_LOW;
+
+    if (trigger ? trigger == acpi::INTI_LEVEL : level)
+        entry |= REDIR_LEVEL;
+
+    io_write(*io, IOAPIC_REDTBL + pin * 2 + 1, uint32_t(dest) << 24);
+    io_write(*io, IOAPIC_REDTBL + pin * 2, entry);
+}
+
+void mask(uint32_t gsi) noexcept
+{
+    uint32_t pin;
+    ioapic_t *io = find_ioapic(gsi, pin);
+
+    if (io)
+        io_write(*io, IOAPIC_REDTBL + pin * 2, io_read(*io, IOAPIC_REDTBL + pin * 2) | REDIR_MASKED);
+}
+
+void unmask(uint32_t gsi) noexcept
+{
+    uint32_t pin;
+    ioapic_t *io = find_ioapic(gsi, pin);
+
+    if (io)
+        io_write(*io, IOAPIC_REDTBL + pin * 2, io_read(*io, IOAPIC_REDTBL + pin * 2) & ~REDIR_MASKED);
+}
+
+void set_dest(uint32_t gsi, uint8_t dest) noexcept
+{
+    uint32_t pin;
+    ioapic_t *io = find_ioapic(gsi, pin);
+
+    if (io)
+        io_write(*io, IOAPIC_REDTBL + pin * 2 + 1, uint32_t(dest) << 24);
+}
+
+} // namespace apic
+} // namespace x86
+} // namespace arch
+} // namespace kernel
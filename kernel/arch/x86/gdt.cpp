@@ -17,6 +17,7 @@
  */
 
 #include <kernel/arch/x86/gdt.hpp>
+#include <kernel/memlayout.hpp>
 #include <kernel/linkage.hpp>
 
 
@@ -40,7 +41,7 @@ inline const uint8_t USER_ACCESS_STACK     {0xF7};
 inline const auto ENTRIES {7};
 
 entry_t GDT[ENTRIES];
-ptr_t   *gdt_ptr = reinterpret_cast<ptr_t*>(GDT_BASE);
+ptr_t   *gdt_ptr = reinterpret_cast<ptr_t*>(GDT_BASE + core::memory::PAGE_OFFSET);
 
 /**
  * @brief Set the GDT entry.
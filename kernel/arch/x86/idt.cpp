@@ -0,0 +1,174 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/system.hpp>
+#include <kernel/arch/x86/idt.hpp>
+#include <kernel/arch/x86/tsc.hpp>
+#include <kernel/softirq.hpp>
+#include <kernel/sched.hpp>
+#include <kernel/linkage.hpp>
+#include <kernel/panic.hpp>
+
+
+extern kernel::uint32_t isr_stub_table[];
+
+namespace kernel {
+namespace arch {
+namespace x86 {
+namespace idt {
+
+inline const uint16_t KERNEL_CODE_SELECTOR {0x08};
+inline const uint8_t  GATE_FLAGS           {0x8E}; // present, ring 0, 32-bit interrupt gate
+
+static gate_t    IDT[ENTRIES];
+static ptr_t     idt_ptr;
+static handler_t handlers[ENTRIES];
+
+static const char *exceptions[EXCEPTIONS] = {
+    "division error",
+    "debug",
+    "non-maskable interrupt",
+    "breakpoint",
+    "overflow",
+    "bound range exceeded",
+    "invalid opcode",
+    "device not available",
+    "double fault",
+    "coprocessor segment overrun",
+    "invalid TSS",
+    "segment not present",
+    "stack-segment fault",
+    "general protection fault",
+    "page fault",
+    "reserved",
+    "x87 floating-point exception",
+    "alignment check",
+    "machine check",
+    "SIMD floating-point exception",
+    "virtualization exception",
+    "control protection exception",
+    "reserved",
+    "reserved",
+    "reserved",
+    "reserved",
+    "reserved",
+    "reserved",
+    "hypervisor injection exception",
+    "VMM communication exception",
+    "security exception",
+    "reserved"
+};
+
+/**
+ * @brief Set the IDT gate.
+ *
+ * @param [in] vector - given interrupt vector.
+ * @param [in] base - given handler address.
+ */
+static void set_gate(uint8_t vector, uint32_t base) noexcept
+{
+    IDT[vector].m_base_low  = (base & 0xFFFF);
+    IDT[vector].m_base_high = ((base >> 0x10) & 0xFFFF);
+    IDT[vector].m_selector  = KERNEL_CODE_SELECTOR;
+    IDT[vector].m_zero      = 0;
+    IDT[vector].m_flags     = GATE_FLAGS;
+}
+
+/**
+ * @brief Load the new IDT.
+ *
+ * @param [in] ptr - new IDT pointer to load.
+ */
+asmlinkage void idt_flush(uint32_t ptr);
+
+/** @brief Local APIC spurious interrupt stub.*/
+asmlinkage void isr_spurious(void);
+
+/** @brief Local APIC timer interrupt stub.*/
+asmlinkage void isr_lapic_timer(void);
+
+/**
+ * @brief Common interrupt handler called from ISR stubs.
+ *
+ * @param [in] regs - given saved registers.
+ */
+asmlinkage void isr_handler(regs_t *regs) noexcept
+{
+    auto handler = handlers[regs->m_vector];
+
+    if (!handler) {
+        if (regs->m_vector < EXCEPTIONS)
+            panic("%s (err: %#X) at <%08p>\n", exceptions[regs->m_vector], regs->m_err_code, regs->m_eip);
+
+        return;
+    }
+
+#ifdef CONFIG_IRQ_TRACE
+    // interrupt gate has disabled interrupts
+    bool irqs_on = regs->m_eflags & EFLAGS_IF;
+
+    if (irqs_on)
+        core::trace_irqs_off();
+
+    uint64_t start = rdtsc();
+#endif // CONFIG_IRQ_TRACE
+
+    handler(regs);
+
+#ifdef CONFIG_IRQ_TRACE
+    core::trace_irq_vector(regs->m_vector, rdtsc() - start);
+#endif // CONFIG_IRQ_TRACE
+
+    // bottom halves are not accounted to handler
+    if (regs->m_vector >= IRQ_BASE) {
+        core::irq_exit();
+
+        // interrupted task is resumed by iret when it is switched back
+        if (regs->m_eflags & EFLAGS_IF)
+            core::preempt_schedule_irq();
+    }
+
+#ifdef CONFIG_IRQ_TRACE
+    if (irqs_on)
+        core::trace_irqs_on();
+#endif // CONFIG_IRQ_TRACE
+}
+
+void init(void) noexcept
+{
+    for (uint32_t i = 0; i < EXCEPTIONS + IRQ_LINES; i++)
+        set_gate(i, isr_stub_table[i]);
+
+    set_gate(VEC_LAPIC_TIMER, reinterpret_cast<uint32_t>(isr_lapic_timer));
+    set_gate(VEC_SPURIOUS, reinterpret_cast<uint32_t>(isr_spurious));
+
+    idt_ptr.m_size   = sizeof(IDT) - 1;
+    idt_ptr.m_offset = reinterpret_cast<uint32_t>(&IDT);
+
+    idt_flush(reinterpret_cast<uint32_t>(&idt_ptr));
+}
+
+void set_handler(uint8_t vector, handler_t handler) noexcept
+{
+    handlers[vector] = handler;
+}
+
+} // namespace idt
+} // namespace x86
+} // namespace arch
+} // namespace kernel
@@ -0,0 +1,137 @@
+; Monolithic Unix-like kernel from scratch.
+; Copyright (C) 2024 Alexander (@alkuzin).
+;
+; This program is free software: you can redistribute it and/or modify
+; it under the terms of the GNU General Public License as published by
+; the Free Software Foundation, either version 3 of the License, or
+; (at your option) any later version.
+;
+; This program is distributed in the hope that it will be useful,
+; but WITHOUT ANY WARRANTY; without even the implied warranty of
+; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+; GNU General Public License for more details.
+;
+; You should have received a copy of the GNU General Public License
+; along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+; exception stub for vectors without error code pushed by CPU
+%macro ISR_NOERR 1
+isr%1:
+    push 0              ; dummy error code
+    push %1             ; interrupt vector
+    jmp isr_common
+%endmacro
+
+; exception stub for vectors with error code pushed by CPU
+%macro ISR_ERR 1
+isr%1:
+    push %1             ; interrupt vector
+    jmp isr_common
+%endmacro
+
+section .text
+
+ISR_NOERR 0
+ISR_NOERR 1
+ISR_NOERR 2
+ISR_NOERR 3
+ISR_NOERR 4
+ISR_NOERR 5
+ISR_NOERR 6
+ISR_NOERR 7
+ISR_ERR   8
+ISR_NOERR 9
+ISR_ERR   10
+ISR_ERR   11
+ISR_ERR   12
+ISR_ERR   13
+ISR_ERR   14
+ISR_NOERR 15
+ISR_NOERR 16
+ISR_ERR   17
+ISR_NOERR 18
+ISR_NOERR 19
+ISR_NOERR 20
+ISR_ERR   21
+ISR_NOERR 22
+ISR_NOERR 23
+ISR_NOERR 24
+ISR_NOERR 25
+ISR_NOERR 26
+ISR_NOERR 27
+ISR_NOERR 28
+ISR_ERR   29
+ISR_ERR   30
+ISR_NOERR 31
+
+; hardware interrupt stubs (vectors 32-55)
+%assign i 32
+%rep 24
+isr%+i:
+    push 0              ; dummy error code
+    push i              ; interrupt vector
+    jmp isr_common
+%assign i i + 1
+%endrep
+
+extern isr_handler
+
+isr_common:
+    pusha               ; save general purpose registers
+    push ds
+    push es
+    push fs
+    push gs
+
+    mov ax, 0x10        ; kernel data segment selector
+    mov ds, ax
+    mov es, ax
+    mov fs, ax
+    mov gs, ax
+
+    push esp            ; pointer to saved registers (idt::regs_t)
+    cld                 ; C++ code expects direction flag to be clear
+    call isr_handler
+    add esp, 4
+
+    pop gs
+    pop fs
+    pop es
+    pop ds
+    popa                ; restore general purpose registers
+    add esp, 8          ; remove vector & error code
+    iret
+
+; local APIC timer is dispatched as other interrupts
+global isr_lapic_timer
+
+isr_lapic_timer:
+    push 0              ; dummy error code
+    push 0xEF           ; interrupt vector (idt::VEC_LAPIC_TIMER)
+    jmp isr_common
+
+; local APIC spurious interrupt is neither handled nor acknowledged
+global isr_spurious
+
+isr_spurious:
+    iret
+
+global idt_flush
+
+idt_flush:
+    mov eax, [esp + 4]  ; get function argument from stack (IDT pointer from idt::init())
+    lidt [eax]          ; load Interrupt Descriptor Table
+    ret
+
+section .data
+
+; table of exception & IRQ stubs addresses used by idt::init()
+global isr_stub_table
+
+isr_stub_table:
+%assign i 0
+%rep 56
+    dd isr%+i
+%assign i i + 1
+%endrep
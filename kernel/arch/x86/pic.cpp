@@ -0,0 +1,132 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/pic.hpp>
+#include <kernel/arch/x86/io.hpp>
+
+
+namespace kernel {
+namespace arch {
+namespace x86 {
+namespace pic {
+
+inline const uint8_t ICW1_INIT {0x11}; // start initialization, ICW4 follows
+inline const uint8_t ICW4_8086 {0x01}; // 8086 mode
+inline const uint8_t OCW2_EOI  {0x20}; // non-specific End Of Interrupt
+inline const uint8_t OCW3_ISR  {0x0B}; // read In-Service Register
+
+static uint16_t irq_mask {0xFFFF};      // cached mask of both controllers
+
+/** @brief Wait for controller to handle command on old hardware.*/
+static inline void io_wait(void) noexcept
+{
+    outb(0x80, 0); // unused POST code port
+}
+
+/**
+ * @brief Write cached mask of controller that handles IRQ line.
+ *
+ * @param [in] irq - given IRQ line.
+ */
+static void write_mask(uint8_t irq) noexcept
+{
+    if (irq < 8)
+        outb(MASTER_DATA, irq_mask & 0xFF);
+    else
+        outb(SLAVE_DATA, irq_mask >> 8);
+}
+
+void init(uint8_t base) noexcept
+{
+    outb(MASTER_CMD, ICW1_INIT);
+    io_wait();
+    outb(SLAVE_CMD, ICW1_INIT);
+    io_wait();
+
+    // ICW2: vector offsets
+    outb(MASTER_DATA, base);
+    io_wait();
+    outb(SLAVE_DATA, base + 8);
+    io_wait();
+
+    // ICW3: master has slave on line 2, slave cascade identity is 2
+    outb(MASTER_DATA, 1 << CASCADE_IRQ);
+    io_wait();
+    outb(SLAVE_DATA, CASCADE_IRQ);
+    io_wait();
+
+    outb(MASTER_DATA, ICW4_8086);
+    io_wait();
+    outb(SLAVE_DATA, ICW4_8086);
+    io_wait();
+
+    // slave interrupts pass through cascade line only
+    irq_mask = 0xFFFF & ~(1 << CASCADE_IRQ);
+    outb(MASTER_DATA, irq_mask & 0xFF);
+    outb(SLAVE_DATA, irq_mask >> 8);
+}
+
+void disable(void) noexcept
+{
+    irq_mask = 0xFFFF;
+    outb(MASTER_DATA, 0xFF);
+    outb(SLAVE_DATA, 0xFF);
+}
+
+void mask(uint8_t irq) noexcept
+{
+    irq_mask |= (1 << irq);
+    write_mask(irq);
+}
+
+void unmask(uint8_t irq) noexcept
+{
+    irq_mask &= ~(1 << irq);
+    write_mask(irq);
+}
+
+void eoi(uint8_t irq) noexcept
+{
+    if (irq >= 8)
+        outb(SLAVE_CMD, OCW2_EOI);
+
+    outb(MASTER_CMD, OCW2_EOI);
+}
+
+bool is_spurious(uint8_t irq) noexcept
+{
+    if (irq != 7 && irq != 15)
+        return false;
+
+    uint16_t port = irq == 7 ? MASTER_CMD : SLAVE_CMD;
+    outb(port, OCW3_ISR);
+
+    if (inb(port) & 0x80)
+        return false;
+
+    // master has forwarded spurious interrupt of slave as real one
+    if (irq == 15)
+        outb(MASTER_CMD, OCW2_EOI);
+
+    return true;
+}
+
+} // namespace pic
+} // namespace x86
+} // namespace arch
+} // namespace kernel
@@ -0,0 +1,126 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/system.hpp>
+#include <kernel/arch/x86/pit.hpp>
+#include <kernel/arch/x86/tsc.hpp>
+#include <kernel/arch/x86/io.hpp>
+#include <kernel/kstd/cmath.hpp>
+
+
+namespace kernel {
+namespace arch {
+namespace x86 {
+namespace pit {
+
+inline const uint16_t CHANNEL0 {0x40};
+inline const uint16_t CHANNEL2 {0x42};
+inline const uint16_t COMMAND  {0x43};
+inline const uint16_t GATE     {0x61};  // NMI status & control port
+
+// command byte fields:
+inline const uint8_t CMD_CHANNEL0 {0x00};
+inline const uint8_t CMD_CHANNEL2 {0x80};
+inline const uint8_t CMD_LATCH    {0x00};   // latch counter value
+inline const uint8_t CMD_LOHI     {0x30};   // access low byte, then high byte
+inline const uint8_t CMD_MODE0    {0x00};   // interrupt on terminal count
+inline const uint8_t CMD_MODE2    {0x04};   // rate generator
+
+// port 0x61 bits:
+inline const uint8_t GATE_CH2     {0x01};   // channel 2 counts while set
+inline const uint8_t GATE_SPEAKER {0x02};   // channel 2 output drives speaker
+inline const uint8_t GATE_OUT2    {0x20};   // channel 2 output state
+
+// longest countdown poll (about 1 us per port read)
+inline const uint32_t CALIBRATE_SPIN {1000000};
+
+void init(void) noexcept
+{
+    // reload value 0 is treated as 65536
+    outb(COMMAND, CMD_CHANNEL0 | CMD_LOHI | CMD_MODE2);
+    outb(CHANNEL0, 0);
+    outb(CHANNEL0, 0);
+}
+
+void set_oneshot(uint16_t ticks) noexcept
+{
+    outb(COMMAND, CMD_CHANNEL0 | CMD_LOHI | CMD_MODE0);
+    outb(CHANNEL0, ticks & 0xFF);
+    outb(CHANNEL0, ticks >> 8);
+}
+
+void set_periodic(uint16_t ticks) noexcept
+{
+    outb(COMMAND, CMD_CHANNEL0 | CMD_LOHI | CMD_MODE2);
+    outb(CHANNEL0, ticks & 0xFF);
+    outb(CHANNEL0, ticks >> 8);
+}
+
+void stop(void) noexcept
+{
+    // counting starts only after count is written
+    outb(COMMAND, CMD_CHANNEL0 | CMD_LOHI | CMD_MODE0);
+}
+
+uint16_t read(void) noexcept
+{
+    auto flags = irq_save();
+
+    outb(COMMAND, CMD_CHANNEL0 | CMD_LATCH);
+    uint16_t count = inb(CHANNEL0);
+    count |= inb(CHANNEL0) << 8;
+
+    irq_restore(flags);
+
+    // counter goes down, clock has to go up
+    return -count;
+}
+
+uint32_t calibrate_tsc(uint32_t ms) noexcept
+{
+    uint32_t latch = FREQUENCY * ms / 1000;
+    auto     flags = irq_save();
+
+    // enable channel 2 gate with speaker disconnected
+    outb(GATE, (inb(GATE) & ~GATE_SPEAKER) | GATE_CH2);
+
+    outb(COMMAND, CMD_CHANNEL2 | CMD_LOHI | CMD_MODE0);
+    outb(CHANNEL2, latch & 0xFF);
+    outb(CHANNEL2, latch >> 8);
+
+    uint64_t start = rdtsc();
+    uint32_t spin  = 0;
+
+    // OUT2 goes high on terminal count
+    while (!(inb(GATE) & GATE_OUT2) && ++spin < CALIBRATE_SPIN)
+        ;
+
+    uint64_t cycles = rdtsc() - start;
+    irq_restore(flags);
+
+    if (spin == CALIBRATE_SPIN)
+        return 0;
+
+    // scale by exact countdown length, not by rounded milliseconds
+    return kstd::div_u64(cycles * FREQUENCY, latch * 1000);
+}
+
+} // namespace pit
+} // namespace x86
+} // namespace arch
+} // namespace kernel
@@ -0,0 +1,41 @@
+; Monolithic Unix-like kernel from scratch.
+; Copyright (C) 2024 Alexander (@alkuzin).
+;
+; This program is free software: you can redistribute it and/or modify
+; it under the terms of the GNU General Public License as published by
+; the Free Software Foundation, either version 3 of the License, or
+; (at your option) any later version.
+;
+; This program is distributed in the hope that it will be useful,
+; but WITHOUT ANY WARRANTY; without even the implied warranty of
+; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+; GNU General Public License for more details.
+;
+; You should have received a copy of the GNU General Public License
+; along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+global switch_to
+
+; void switch_to(uint32_t *prev_esp, uint32_t next_esp)
+;
+; Both tasks call it as an ordinary function, so only registers that
+; cdecl callee must preserve are saved. New thread stack is prepared
+; by kthread_create() to look like it has been switched from here.
+
+switch_to:
+    mov eax, [esp + 4]  ; where to save stack pointer of previous task
+    mov edx, [esp + 8]  ; saved stack pointer of the next task
+
+    push ebp            ; save callee-saved registers of previous task
+    push ebx
+    push esi
+    push edi
+    mov [eax], esp      ; previous task is suspended here
+
+    mov esp, edx        ; switch to stack of the next task
+    pop edi             ; restore callee-saved registers of the next task
+    pop esi
+    pop ebx
+    pop ebp
+    ret                 ; return to schedule() or kthread_entry() of the next task
@@ -18,6 +18,7 @@
 
 #include <kernel/kstd/cstring.hpp>
 #include <kernel/kstd/cctype.hpp>
+#include <kernel/clocksource.hpp>
 #include <kernel/printk.hpp>
 
 
@@ -40,6 +41,43 @@ inline const auto LOG_ERR_MSG     {"ERROR"};
 inline const auto LOG_EMERG_MSG   {"EMERG"};
 inline const auto LOG_DEBUG_MSG   {"DEBUG"};
 
+/**
+ * @brief Print time since clocksource initialization.
+ *
+ * @details Time is formatted as "[seconds.microseconds] ".
+ */
+static void print_time(void) noexcept
+{
+    if (!core::clocksource)
+        return;
+
+    uint64_t ns   = core::clock_monotonic_ns();
+    uint32_t sec  = kstd::div_u64(ns, core::NSEC_PER_SEC);
+    uint32_t nsec = ns - static_cast<uint64_t>(sec) * core::NSEC_PER_SEC;
+    uint32_t usec = nsec / core::NSEC_PER_USEC;
+
+    // vsnprintk does not support field width
+    char   str[24];
+    size_t i = sizeof(str);
+
+    str[--i] = '\0';
+    str[--i] = ' ';
+    str[--i] = ']';
+
+    for (uint32_t digit = 0; digit < 6; digit++, usec /= 10)
+        str[--i] = '0' + usec % 10;
+
+    str[--i] = '.';
+
+    do {
+        str[--i] = '0' + sec % 10;
+        sec /= 10;
+    } while (sec);
+
+    str[--i] = '[';
+    kstd::putk(str + i, gfx::color::gray);
+}
+
 /**
  * @brief Print log info.
  *
@@ -57,6 +95,8 @@ static int32_t print_log(const char *fmt) noexcept
     if (type == LOG_DEFAULT)
         return 0;
 
+    print_time();
+
     // print log type
     kstd::putchar('[');
     switch (type) {
@@ -0,0 +1,783 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/tsc.hpp>
+#include <kernel/clocksource.hpp>
+#include <kernel/clockevent.hpp>
+#include <kernel/hrtimer.hpp>
+#include <kernel/kthread.hpp>
+#include <kernel/timer.hpp>
+#include <kernel/tick.hpp>
+#include <kernel/percpu.hpp>
+#include <kernel/mmap.hpp>
+#include <kernel/swap.hpp>
+#include <kernel/ksm.hpp>
+#include <kernel/pmm.hpp>
+#include <kernel/printk.hpp>
+#include <kernel/debug.hpp>
+#include <kernel/slab.hpp>
+
+
+namespace kernel {
+namespace debug {
+
+inline const uint32_t BENCH_BATCH  {64};   // objects allocated per pass
+inline const uint32_t BENCH_PASSES {256};  // passes per size class
+
+void slab_bench(kstd::arena_t& arena) noexcept
+{
+    auto objects = static_cast<void**>(arena.alloc(BENCH_BATCH * sizeof(void*), alignof(void*)));
+
+    if (!objects) {
+        printk("%s\n", "slab benchmark: out of memory");
+        return;
+    }
+
+    printk("slab benchmark on CPU %u: %u passes of %u objects\n",
+        smp_processor_id(), BENCH_PASSES, BENCH_BATCH
+    );
+
+    for (uint32_t size = 8; size <= kmem::KMALLOC_MAX_CACHE; size <<= 1) {
+        uint64_t alloc_cycles = 0;
+        uint64_t free_cycles  = 0;
+        uint32_t failed       = 0;
+
+        for (uint32_t pass = 0; pass < BENCH_PASSES; pass++) {
+            auto start = arch::x86::rdtsc();
+
+            for (uint32_t i = 0; i < BENCH_BATCH; i++)
+                objects[i] = kmalloc(size, GFP::KERNEL);
+
+            alloc_cycles += arch::x86::rdtsc() - start;
+            start         = arch::x86::rdtsc();
+
+            // free odd objects first to interleave freelists
+            for (uint32_t i = 1; i < BENCH_BATCH; i += 2)
+                kfree(objects[i]);
+
+            for (uint32_t i = BENCH_BATCH; i > 0; i -= 2)
+                kfree(objects[i - 2]);
+
+            free_cycles += arch::x86::rdtsc() - start;
+
+            for (uint32_t i = 0; i < BENCH_BATCH; i++) {
+                if (!objects[i])
+                    failed++;
+            }
+        }
+
+        auto ops = BENCH_BATCH * BENCH_PASSES;
+
+        printk("kmalloc-%u: %u cycles/alloc, %u cycles/free, %u failed\n",
+            size,
+            static_cast<uint32_t>(alloc_cycles / ops),
+            static_cast<uint32_t>(free_cycles / ops),
+            failed
+        );
+    }
+}
+
+inline const uint32_t FAULT_BENCH_PAGES {256}; // mapped area size in pages
+
+/**
+ * @brief Fill page of memory-backed benchmark file.
+ *
+ * @param [in] file - given file.
+ * @param [in] pgoff - given page offset in file.
+ * @param [out] buf - given page sized buffer to fill.
+ * @return true.
+ */
+static bool bench_readpage(core::memory::vm_file_t *file, size_t pgoff, void *buf) noexcept
+{
+    (void)file;
+
+    auto words = static_cast<uint32_t*>(buf);
+
+    for (uint32_t i = 0; i < core::memory::PAGE_SIZE / sizeof(uint32_t); i++)
+        words[i] = pgoff;
+
+    return true;
+}
+
+/**
+ * @brief Touch every page of the area and display fault counters delta.
+ *
+ * @param [in] name - given round name.
+ * @param [in] file - given backing file (nullptr - anonymous memory).
+ */
+static void fault_round(const char *name, core::memory::vm_file_t *file) noexcept
+{
+    using namespace core::memory;
+
+    mm_t *mm      = current_mm();
+    uint32_t prot = file ? uint32_t(VM::READ) : uint32_t(VM::READ | VM::WRITE);
+    auto area     = static_cast<volatile uint32_t*>(mm->mmap(0, FAULT_BENCH_PAGES * PAGE_SIZE, prot, file, 0));
+
+    if (!area) {
+        printk("%s: mmap failed\n", name);
+        return;
+    }
+
+    auto before   = mm->m_stats;
+    auto start    = arch::x86::rdtsc();
+    uint32_t step = PAGE_SIZE / sizeof(uint32_t);
+
+    for (uint32_t i = 0; i < FAULT_BENCH_PAGES; i++) {
+        if (file)
+            (void)area[i * step];
+        else
+            area[i * step] = i;
+    }
+
+    auto cycles = arch::x86::rdtsc() - start;
+
+    printk("%s: %u faults, %u major, %u fault-around, %u cycles/page\n", name,
+        mm->m_stats.m_faults - before.m_faults,
+        mm->m_stats.m_major - before.m_major,
+        mm->m_stats.m_around - before.m_around,
+        static_cast<uint32_t>(cycles / FAULT_BENCH_PAGES)
+    );
+
+    mm->munmap(reinterpret_cast<uint32_t>(area), FAULT_BENCH_PAGES * PAGE_SIZE);
+}
+
+void fault_bench(void) noexcept
+{
+    using namespace core::memory;
+
+    vm_file_t file;
+
+    if (!file.init(FAULT_BENCH_PAGES, bench_readpage, nullptr)) {
+        printk("%s\n", "fault benchmark: file allocation failed");
+        return;
+    }
+
+    auto saved = fault_around_pages;
+
+    printk("fault benchmark: sequential access of %u pages\n", FAULT_BENCH_PAGES);
+
+    fault_round("anonymous", nullptr);
+    fault_round("file (cold cache)", &file);
+
+    fault_around_pages = 1;
+    fault_round("file (no fault-around)", &file);
+
+    fault_around_pages = saved;
+    fault_round("file (fault-around)", &file);
+
+    file.destroy();
+}
+
+inline const uint32_t COW_BENCH_STRIDE {16};         // child writes every N-th page
+inline const uint32_t COW_BENCH_MAGIC  {0x5AFEC0DE}; // value written to shared page
+
+void cow_bench(void) noexcept
+{
+    using namespace core::memory;
+
+    mm_t *parent = current_mm();
+    uint32_t len = FAULT_BENCH_PAGES * PAGE_SIZE;
+    auto area    = static_cast<volatile uint32_t*>(parent->mmap(0, len, VM::READ | VM::WRITE, nullptr, 0));
+
+    if (!area) {
+        printk("%s\n", "cow benchmark: mmap failed");
+        return;
+    }
+
+    uint32_t step = PAGE_SIZE / sizeof(uint32_t);
+
+    for (uint32_t i = 0; i < FAULT_BENCH_PAGES; i++)
+        area[i * step] = i;
+
+    mm_t child;
+    auto used  = pmm.m_used_pages;
+    auto start = arch::x86::rdtsc();
+
+    if (!parent->dup(&child)) {
+        printk("%s\n", "cow benchmark: dup failed");
+        parent->munmap(reinterpret_cast<uint32_t>(area), len);
+        return;
+    }
+
+    auto cycles = arch::x86::rdtsc() - start;
+
+    printk("dup of %u pages: %u cycles, %u new pages\n", FAULT_BENCH_PAGES,
+        static_cast<uint32_t>(cycles), static_cast<uint32_t>(pmm.m_used_pages - used)
+    );
+
+    // parent writes through its own TLB before any address space switch
+    area[step] = ~1u;
+    switch_mm(&child);
+    uint32_t seen = area[step];
+    switch_mm(parent);
+
+    printk("cow isolation: %s\n", (seen == 1) ? "ok" : "broken");
+
+    used = pmm.m_used_pages;
+    switch_mm(&child);
+
+    for (uint32_t i = 0; i < FAULT_BENCH_PAGES; i += COW_BENCH_STRIDE)
+        area[i * step] = ~i;
+
+    switch_mm(parent);
+
+    printk("child wrote %u pages: %u copied, %u new pages\n",
+        FAULT_BENCH_PAGES / COW_BENCH_STRIDE, child.m_stats.m_cow,
+        static_cast<uint32_t>(pmm.m_used_pages - used)
+    );
+
+    auto reuse = parent->m_stats.m_reuse;
+
+    // parent is the last user of pages copied by child
+    for (uint32_t i = 0; i < FAULT_BENCH_PAGES; i += COW_BENCH_STRIDE)
+        area[i * step] = i;
+
+    printk("parent wrote %u pages: %u reused\n",
+        FAULT_BENCH_PAGES / COW_BENCH_STRIDE, parent->m_stats.m_reuse - reuse
+    );
+
+    // shared page read before dup is written by parent & read by child
+    auto shared = static_cast<volatile uint32_t*>(
+        parent->mmap(0, PAGE_SIZE, VM::READ | VM::WRITE | VM::SHARED, nullptr, 0)
+    );
+
+    if (shared) {
+        mm_t sharer;
+        (void)shared[0];
+
+        if (parent->dup(&sharer)) {
+            shared[0] = COW_BENCH_MAGIC;
+            switch_mm(&sharer);
+            seen = shared[0];
+            switch_mm(parent);
+
+            printk("shared anonymous: %s\n", (seen == COW_BENCH_MAGIC) ? "ok" : "broken");
+            sharer.destroy();
+        }
+
+        parent->munmap(reinterpret_cast<uint32_t>(shared), PAGE_SIZE);
+    }
+
+    child.destroy();
+    parent->munmap(reinterpret_cast<uint32_t>(area), len);
+}
+
+inline const uint32_t VMA_BENCH_AREAS   {2048};  // number of single page areas
+inline const uint32_t VMA_BENCH_LOOKUPS {16384}; // number of lookups
+
+void vma_bench(void) noexcept
+{
+    using namespace core::memory;
+
+    mm_t *mm       = current_mm();
+    uint32_t base  = MMAP_END - 2 * VMA_BENCH_AREAS * PAGE_SIZE;
+    uint32_t count = 0;
+
+    // every second page is mapped with alternating flags
+    for (uint32_t i = 0; i < VMA_BENCH_AREAS; i++) {
+        uint32_t flags = (i & 1) ? uint32_t(VM::READ) : uint32_t(VM::READ | VM::WRITE);
+
+        if (!mm->mmap(base + 2 * i * PAGE_SIZE, PAGE_SIZE, flags, nullptr, 0))
+            break;
+
+        count++;
+    }
+
+    uint32_t found = 0;
+    auto start     = arch::x86::rdtsc();
+
+    // stride is coprime with number of areas, so lookups miss the cache
+    for (uint32_t i = 0; i < VMA_BENCH_LOOKUPS; i++) {
+        uint32_t addr = base + 2 * ((i * 97) % VMA_BENCH_AREAS) * PAGE_SIZE;
+
+        if (mm->find_vma(addr))
+            found++;
+    }
+
+    auto cycles = arch::x86::rdtsc() - start;
+
+    printk("%u areas (%u in address space): %u cycles/lookup, %u found\n",
+        count, static_cast<uint32_t>(mm->m_map_count),
+        static_cast<uint32_t>(cycles / VMA_BENCH_LOOKUPS), found
+    );
+
+    mm->munmap(base, 2 * VMA_BENCH_AREAS * PAGE_SIZE);
+}
+
+inline const uint32_t SWAP_BENCH_PAGES {256}; // number of pages swapped out
+
+void swap_bench(void) noexcept
+{
+    using namespace core::memory;
+
+    if (!nr_swapfiles) {
+        printk("%s\n", "swap benchmark: no swap devices");
+        return;
+    }
+
+    mm_t *mm     = current_mm();
+    uint32_t len = SWAP_BENCH_PAGES * PAGE_SIZE;
+    auto area    = static_cast<volatile uint32_t*>(mm->mmap(0, len, VM::READ | VM::WRITE, nullptr, 0));
+
+    if (!area) {
+        printk("%s\n", "swap benchmark: mmap failed");
+        return;
+    }
+
+    uint32_t step = PAGE_SIZE / sizeof(uint32_t);
+
+    for (uint32_t i = 0; i < SWAP_BENCH_PAGES; i++)
+        area[i * step] = i;
+
+    auto out    = swap_stats.m_pswpout;
+    auto start  = arch::x86::rdtsc();
+    auto freed  = shrink_memory(SWAP_BENCH_PAGES);
+    auto cycles = arch::x86::rdtsc() - start;
+
+    printk("reclaimed %u pages: %u swapped out, %u cycles/page\n", freed,
+        swap_stats.m_pswpout - out, static_cast<uint32_t>(cycles) / (freed ? freed : 1)
+    );
+
+    auto swapin    = mm->m_stats.m_swapin;
+    auto readahead = swap_stats.m_readahead;
+    auto hits      = swap_stats.m_cache_hits;
+    uint32_t bad   = 0;
+
+    start = arch::x86::rdtsc();
+
+    for (uint32_t i = 0; i < SWAP_BENCH_PAGES; i++) {
+        if (area[i * step] != i)
+            bad++;
+    }
+
+    cycles = arch::x86::rdtsc() - start;
+
+    printk("read back %u pages: %u cycles/page, %u swapped in (%u read ahead, %u cache hits), %u corrupted\n",
+        SWAP_BENCH_PAGES, static_cast<uint32_t>(cycles / SWAP_BENCH_PAGES),
+        mm->m_stats.m_swapin - swapin, swap_stats.m_readahead - readahead,
+        swap_stats.m_cache_hits - hits, bad
+    );
+
+    mm->munmap(reinterpret_cast<uint32_t>(area), len);
+}
+
+
+inline const uint32_t KSM_BENCH_PAGES    {256}; // number of pages scanned
+inline const uint32_t KSM_BENCH_CONTENTS {4};   // number of distinct page contents
+
+void ksm_bench(void) noexcept
+{
+    using namespace core::memory;
+
+    mm_t *mm     = current_mm();
+    uint32_t len = KSM_BENCH_PAGES * PAGE_SIZE;
+    auto area    = static_cast<volatile uint32_t*>(
+        mm->mmap(0, len, VM::READ | VM::WRITE | VM::MERGEABLE, nullptr, 0)
+    );
+
+    if (!area) {
+        printk("%s\n", "ksm benchmark: mmap failed");
+        return;
+    }
+
+    uint32_t step = PAGE_SIZE / sizeof(uint32_t);
+
+    for (uint32_t i = 0; i < KSM_BENCH_PAGES; i++)
+        area[i * step] = i % KSM_BENCH_CONTENTS;
+
+    auto used    = pmm.m_used_pages;
+    auto merged  = ksm_stats.m_merged;
+    auto scanned = ksm_stats.m_scanned;
+    auto scans   = ksm_stats.m_full_scans;
+    auto start   = arch::x86::rdtsc();
+
+    // unchanged pages are merged during the second pass
+    while (ksm_stats.m_full_scans - scans < 3)
+        ksm_scan(KSM_BENCH_PAGES);
+
+    auto cycles = arch::x86::rdtsc() - start;
+    scanned     = ksm_stats.m_scanned - scanned;
+
+    printk("merged %u pages into %u frames: %u pages freed, %u cycles/page scanned\n",
+        ksm_stats.m_merged - merged, ksm_stats.m_pages_shared,
+        static_cast<uint32_t>(used - pmm.m_used_pages),
+        static_cast<uint32_t>(cycles) / (scanned ? scanned : 1)
+    );
+
+    uint32_t bad = 0;
+
+    // writes break sharing by copying frames
+    for (uint32_t i = 0; i < KSM_BENCH_PAGES; i++) {
+        if (area[i * step] != i % KSM_BENCH_CONTENTS)
+            bad++;
+
+        area[i * step] = i;
+    }
+
+    for (uint32_t i = 0; i < KSM_BENCH_PAGES; i++) {
+        if (area[i * step] != i)
+            bad++;
+    }
+
+    printk("unmerged %u pages by writes: %u corrupted\n", KSM_BENCH_PAGES, bad);
+    mm->munmap(reinterpret_cast<uint32_t>(area), len);
+}
+
+inline const uint32_t CLOCK_BENCH_READS   {1000};   // reads of each clocksource
+inline const uint32_t CLOCK_BENCH_ONESHOT {16};     // one-shot events programmed
+inline const uint32_t CLOCK_BENCH_DELAY   {1000};   // one-shot delay & periodic period (us)
+inline const uint32_t CLOCK_BENCH_PERIOD  {100};    // periodic mode run (ms)
+
+static volatile uint32_t clock_bench_events;
+static volatile uint64_t clock_bench_fired;   // time of the last event
+
+static void clock_bench_handler(core::clockevent_t& evt) noexcept
+{
+    (void)evt;
+
+    clock_bench_events = clock_bench_events + 1;
+    clock_bench_fired  = core::clock_monotonic_ns();
+}
+
+void clock_bench(void) noexcept
+{
+    using namespace core;
+
+    for (auto cs = clocksource_list; cs; cs = cs->m_next) {
+        auto start = arch::x86::rdtsc();
+
+        for (uint32_t i = 0; i < CLOCK_BENCH_READS; i++)
+            cs->m_read();
+
+        auto cycles = arch::x86::rdtsc() - start;
+        printk("%s: %u cycles/read\n", cs->m_name, static_cast<uint32_t>(cycles) / CLOCK_BENCH_READS);
+    }
+
+    auto start = arch::x86::rdtsc();
+
+    for (uint32_t i = 0; i < CLOCK_BENCH_READS; i++)
+        clock_monotonic_ns();
+
+    auto cycles = arch::x86::rdtsc() - start;
+    printk("clock_monotonic_ns: %u cycles/call\n", static_cast<uint32_t>(cycles) / CLOCK_BENCH_READS);
+
+    auto evt = clockevent;
+
+    if (!evt) {
+        printk("%s\n", "clock benchmark: no clockevent device");
+        return;
+    }
+
+    auto handler    = evt->m_handler;
+    evt->m_handler  = clock_bench_handler;
+    uint64_t delay  = CLOCK_BENCH_DELAY * NSEC_PER_USEC;
+    uint64_t late   = 0;
+    uint32_t missed = 0;
+
+    // interrupts are enabled in shell
+    for (uint32_t i = 0; i < CLOCK_BENCH_ONESHOT; i++) {
+        clock_bench_events = 0;
+        uint64_t now       = clock_monotonic_ns();
+
+        if (!clockevent_program(*evt, delay)) {
+            missed++;
+            continue;
+        }
+
+        while (!clock_bench_events && clock_monotonic_ns() - now < 10 * delay)
+            ;
+
+        if (!clock_bench_events)
+            missed++;
+        else if (clock_bench_fired > now + delay)
+            late += clock_bench_fired - now - delay;
+    }
+
+    uint32_t fired = CLOCK_BENCH_ONESHOT - missed;
+
+    printk("%s one-shot %u us: %u fired, %u ns late on average\n",
+        evt->m_name, CLOCK_BENCH_DELAY, fired,
+        static_cast<uint32_t>(kstd::div_u64(late, fired ? fired : 1))
+    );
+
+    if (clockevent_set_periodic(*evt, delay)) {
+        clock_bench_events = 0;
+        uint64_t now       = clock_monotonic_ns();
+
+        while (clock_monotonic_ns() - now < CLOCK_BENCH_PERIOD * static_cast<uint64_t>(NSEC_PER_MSEC))
+            ;
+
+        clockevent_shutdown(*evt);
+        printk("%s periodic %u us: %u events in %u ms\n",
+            evt->m_name, CLOCK_BENCH_DELAY, clock_bench_events, CLOCK_BENCH_PERIOD
+        );
+    }
+
+    // the first event restarts consumer of device (hrtimers)
+    evt->m_handler = handler;
+    clockevent_program(*evt, 0);
+}
+
+inline const uint32_t TIMER_BENCH_TIMERS {256};  // timeouts added per pass
+inline const uint32_t TIMER_BENCH_SPREAD {64};   // jiffies timeouts are spread over
+inline const int32_t  TIMER_BENCH_SLACK  {8};    // jiffies of coalescing pass
+
+static volatile uint32_t  timer_bench_fired;
+
+static void timer_bench_func(void *data) noexcept
+{
+    (void)data;
+    timer_bench_fired = timer_bench_fired + 1;
+}
+
+void timer_bench(kstd::arena_t& arena) noexcept
+{
+    using namespace core;
+
+    // every timer has fired or is deleted before return
+    auto timer_bench_timers = static_cast<timer_list_t*>(
+        arena.alloc(TIMER_BENCH_TIMERS * sizeof(timer_list_t), alignof(timer_list_t))
+    );
+
+    if (!timer_bench_timers) {
+        printk("%s\n", "timer benchmark: out of memory");
+        return;
+    }
+
+    uint32_t now  = get_jiffies();
+    auto start    = arch::x86::rdtsc();
+
+    // most timeouts are cancelled before they fire
+    for (uint32_t i = 0; i < TIMER_BENCH_TIMERS; i++) {
+        timer_init(&timer_bench_timers[i], timer_bench_func, nullptr);
+        mod_timer(&timer_bench_timers[i], now + HZ + i * 997);
+    }
+
+    auto add_cycles = arch::x86::rdtsc() - start;
+    start           = arch::x86::rdtsc();
+
+    for (uint32_t i = 0; i < TIMER_BENCH_TIMERS; i++)
+        del_timer(&timer_bench_timers[i]);
+
+    auto del_cycles = arch::x86::rdtsc() - start;
+
+    printk("add: %u cycles/timer, cancel: %u cycles/timer\n",
+        static_cast<uint32_t>(add_cycles) / TIMER_BENCH_TIMERS,
+        static_cast<uint32_t>(del_cycles) / TIMER_BENCH_TIMERS
+    );
+
+    for (int32_t slack = 0; slack <= TIMER_BENCH_SLACK; slack += TIMER_BENCH_SLACK) {
+        uint32_t batches  = timer_stats.this_cpu().m_batches;
+        timer_bench_fired = 0;
+        now               = get_jiffies();
+
+        for (uint32_t i = 0; i < TIMER_BENCH_TIMERS; i++) {
+            set_timer_slack(&timer_bench_timers[i], slack);
+            mod_timer(&timer_bench_timers[i], now + 1 + i % TIMER_BENCH_SPREAD);
+        }
+
+        // interrupts are enabled in shell
+        while (timer_bench_fired < TIMER_BENCH_TIMERS)
+            ;
+
+        printk("slack %u jiffies: %u timeouts expired in %u batches\n",
+            slack, TIMER_BENCH_TIMERS, timer_stats.this_cpu().m_batches - batches
+        );
+    }
+}
+
+inline const uint32_t HRTIMER_BENCH_PERIOD  {100};   // periodic timer period (us)
+inline const uint32_t HRTIMER_BENCH_RUN     {100};   // periodic timer run time (ms)
+inline const uint32_t HRTIMER_BENCH_ONESHOT {100};   // number of one-shot sleeps
+inline const uint32_t HRTIMER_BENCH_SLEEP   {50};    // one-shot sleep (us)
+
+static core::hrtimer_t  hrtimer_bench_timer;
+static volatile uint32_t hrtimer_bench_events;
+static uint32_t          hrtimer_bench_overruns;
+static uint64_t          hrtimer_bench_late;
+static uint64_t          hrtimer_bench_max_late;
+
+static core::hrtimer_restart hrtimer_bench_periodic(core::hrtimer_t *timer) noexcept
+{
+    uint64_t now  = core::clock_monotonic_ns();
+    uint64_t late = now - timer->m_expires;
+
+    hrtimer_bench_late += late;
+
+    if (late > hrtimer_bench_max_late)
+        hrtimer_bench_max_late = late;
+
+    hrtimer_bench_events    = hrtimer_bench_events + 1;
+    hrtimer_bench_overruns += core::hrtimer_forward(timer, now, HRTIMER_BENCH_PERIOD * core::NSEC_PER_USEC) - 1;
+
+    return core::hrtimer_restart::RESTART;
+}
+
+static core::hrtimer_restart hrtimer_bench_oneshot(core::hrtimer_t *timer) noexcept
+{
+    uint64_t late = core::clock_monotonic_ns() - timer->m_expires;
+
+    hrtimer_bench_late += late;
+
+    if (late > hrtimer_bench_max_late)
+        hrtimer_bench_max_late = late;
+
+    hrtimer_bench_events = hrtimer_bench_events + 1;
+    return core::hrtimer_restart::NORESTART;
+}
+
+void hrtimer_bench(void) noexcept
+{
+    using namespace core;
+
+    if (!clockevent || clockevent->m_handler != hrtimer_interrupt) {
+        printk("%s\n", "hrtimer benchmark: hrtimers are not initialized");
+        return;
+    }
+
+    hrtimer_bench_events   = 0;
+    hrtimer_bench_overruns = 0;
+    hrtimer_bench_late     = 0;
+    hrtimer_bench_max_late = 0;
+
+    hrtimer_init(&hrtimer_bench_timer, hrtimer_bench_periodic);
+    hrtimer_start(&hrtimer_bench_timer, HRTIMER_BENCH_PERIOD * NSEC_PER_USEC, hrtimer_mode::REL);
+
+    // interrupts are enabled in shell
+    uint64_t start = clock_monotonic_ns();
+
+    while (clock_monotonic_ns() - start < HRTIMER_BENCH_RUN * static_cast<uint64_t>(NSEC_PER_MSEC))
+        ;
+
+    hrtimer_cancel(&hrtimer_bench_timer);
+    uint32_t events = hrtimer_bench_events;
+
+    printk("periodic %u us: %u expiries in %u ms, %u overruns, %u ns late on average, max %u ns\n",
+        HRTIMER_BENCH_PERIOD, events, HRTIMER_BENCH_RUN, hrtimer_bench_overruns,
+        static_cast<uint32_t>(kstd::div_u64(hrtimer_bench_late, events ? events : 1)),
+        static_cast<uint32_t>(hrtimer_bench_max_late)
+    );
+
+    hrtimer_bench_events   = 0;
+    hrtimer_bench_late     = 0;
+    hrtimer_bench_max_late = 0;
+
+    hrtimer_init(&hrtimer_bench_timer, hrtimer_bench_oneshot);
+
+    for (uint32_t i = 0; i < HRTIMER_BENCH_ONESHOT; i++) {
+        uint32_t fired = hrtimer_bench_events;
+        hrtimer_start(&hrtimer_bench_timer, HRTIMER_BENCH_SLEEP * NSEC_PER_USEC, hrtimer_mode::REL);
+
+        while (hrtimer_bench_events == fired)
+            ;
+    }
+
+    printk("one-shot %u us: %u ns late on average, max %u ns (tick is %u us)\n",
+        HRTIMER_BENCH_SLEEP,
+        static_cast<uint32_t>(kstd::div_u64(hrtimer_bench_late, HRTIMER_BENCH_ONESHOT)),
+        static_cast<uint32_t>(hrtimer_bench_max_late), TICK_NSEC / NSEC_PER_USEC
+    );
+}
+
+inline const uint32_t SCHED_BENCH_YIELDS {10000};  // yields of each task
+inline const uint32_t SCHED_BENCH_SPIN   {200};    // time both tasks spin (ms)
+
+static volatile bool     sched_bench_stop;
+static volatile bool     sched_bench_running;
+static volatile uint32_t sched_bench_loops;
+static uint32_t          sched_bench_preempted;
+
+static void sched_bench_yielder(void *data) noexcept
+{
+    (void)data;
+
+    for (uint32_t i = 0; i < SCHED_BENCH_YIELDS; i++)
+        core::yield();
+
+    sched_bench_running = false;
+}
+
+static void sched_bench_spinner(void *data) noexcept
+{
+    (void)data;
+
+    while (!sched_bench_stop)
+        sched_bench_loops = sched_bench_loops + 1;
+
+    sched_bench_preempted = core::current()->m_preempted;
+    sched_bench_running   = false;
+}
+
+void sched_bench(void) noexcept
+{
+    using namespace core;
+
+    runqueue_t& rq      = runqueues.this_cpu();
+    sched_bench_running = true;
+
+    if (!kthread_run(sched_bench_yielder, nullptr, "yielder")) {
+        printk("%s\n", "sched benchmark: failed to create thread");
+        return;
+    }
+
+    uint32_t switches = rq.m_switches;
+    auto start        = arch::x86::rdtsc();
+
+    for (uint32_t i = 0; i < SCHED_BENCH_YIELDS; i++)
+        yield();
+
+    while (sched_bench_running)
+        yield();
+
+    auto cycles = arch::x86::rdtsc() - start;
+    switches    = rq.m_switches - switches;
+
+    printk("yield: %u switches, %u cycles/switch\n",
+        switches, static_cast<uint32_t>(kstd::div_u64(cycles, switches ? switches : 1))
+    );
+
+    sched_bench_stop    = false;
+    sched_bench_running = true;
+    sched_bench_loops   = 0;
+
+    if (!kthread_run(sched_bench_spinner, nullptr, "spinner")) {
+        printk("%s\n", "sched benchmark: failed to create thread");
+        return;
+    }
+
+    uint32_t preempted = current()->m_preempted;
+    uint32_t loops     = 0;
+    uint64_t now       = clock_monotonic_ns();
+
+    // interrupts are enabled in shell
+    while (clock_monotonic_ns() - now < SCHED_BENCH_SPIN * static_cast<uint64_t>(NSEC_PER_MSEC))
+        loops++;
+
+    sched_bench_stop = true;
+
+    while (sched_bench_running)
+        yield();
+
+    printk("spin %u ms: shell %u loops (preempted %u times), spinner %u loops (preempted %u times)\n",
+        SCHED_BENCH_SPIN, loops, current()->m_preempted - preempted,
+        sched_bench_loops, sched_bench_preempted
+    );
+}
+
+} // namespace debug
+} // namespace kernel
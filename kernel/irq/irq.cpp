@@ -0,0 +1,296 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/system.hpp>
+#include <kernel/arch/x86/acpi.hpp>
+#include <kernel/arch/x86/apic.hpp>
+#include <kernel/arch/x86/pic.hpp>
+#include <kernel/printk.hpp>
+#include <kernel/irq.hpp>
+
+
+namespace kernel {
+namespace core {
+
+irq_desc_t        irq_desc[NR_IRQS];
+irq_stats_t       irq_stats;
+const irq_chip_t *irq_chip;
+
+/**
+ * @brief Disable 8259 PIC line.
+ *
+ * @param [in] irq - given IRQ line.
+ */
+static void pic_mask(uint32_t irq) noexcept
+{
+    arch::x86::pic::mask(irq);
+}
+
+/**
+ * @brief Enable 8259 PIC line.
+ *
+ * @param [in] irq - given IRQ line.
+ */
+static void pic_unmask(uint32_t irq) noexcept
+{
+    arch::x86::pic::unmask(irq);
+}
+
+/**
+ * @brief Acknowledge 8259 PIC interrupt.
+ *
+ * @param [in] irq - given IRQ line.
+ */
+static void pic_eoi(uint32_t irq) noexcept
+{
+    arch::x86::pic::eoi(irq);
+}
+
+/**
+ * @brief Check 8259 PIC interrupt.
+ *
+ * @param [in] irq - given IRQ line.
+ * @return true - in case of spurious interrupt.
+ * @return false - otherwise.
+ */
+static bool pic_is_spurious(uint32_t irq) noexcept
+{
+    return arch::x86::pic::is_spurious(irq);
+}
+
+static const irq_chip_t pic_chip {
+    "8259 PIC", arch::x86::pic::LINES,
+    pic_mask, pic_unmask, pic_eoi, pic_is_spurious, nullptr
+};
+
+/**
+ * @brief Get I/O APIC input of IRQ line.
+ *
+ * @param [in] irq - given IRQ line.
+ * @return global system interrupt.
+ */
+static uint32_t irq_to_gsi(uint32_t irq) noexcept
+{
+    using namespace arch::x86;
+    return irq < acpi::ISA_IRQS ? acpi::madt.m_isa_gsi[irq] : irq;
+}
+
+/**
+ * @brief Disable I/O APIC line.
+ *
+ * @param [in] irq - given IRQ line.
+ */
+static void apic_mask(uint32_t irq) noexcept
+{
+    arch::x86::apic::mask(irq_to_gsi(irq));
+}
+
+/**
+ * @brief Enable I/O APIC line.
+ *
+ * @param [in] irq - given IRQ line.
+ */
+static void apic_unmask(uint32_t irq) noexcept
+{
+    arch::x86::apic::unmask(irq_to_gsi(irq));
+}
+
+/**
+ * @brief Acknowledge local APIC interrupt.
+ *
+ * @param [in] irq - given IRQ line.
+ */
+static void apic_eoi(uint32_t irq) noexcept
+{
+    (void)irq;
+    arch::x86::apic::lapic_eoi();
+}
+
+/**
+ * @brief Route I/O APIC line to CPU.
+ *
+ * @param [in] irq - given IRQ line.
+ * @param [in] cpu - given CPU number.
+ * @return true - always.
+ */
+static bool apic_set_affinity(uint32_t irq, uint32_t cpu) noexcept
+{
+    using namespace arch::x86;
+
+    apic::set_dest(irq_to_gsi(irq), acpi::madt.m_apic_ids[cpu]);
+    return true;
+}
+
+static irq_chip_t apic_chip {
+    "I/O APIC", 0,
+    apic_mask, apic_unmask, apic_eoi, nullptr, apic_set_affinity
+};
+
+/**
+ * @brief Dispatch hardware interrupt to handler of its line.
+ *
+ * @param [in] regs - given saved registers.
+ */
+static void do_irq(arch::x86::idt::regs_t *regs) noexcept
+{
+    uint32_t irq = regs->m_vector - arch::x86::idt::IRQ_BASE;
+
+    if (irq_chip->m_is_spurious && irq_chip->m_is_spurious(irq)) {
+        irq_stats.m_spurious++;
+        return;
+    }
+
+    irq_desc_t& desc = irq_desc[irq];
+    desc.m_count[smp_processor_id()]++;
+
+    if (desc.m_handler)
+        desc.m_handler(irq, desc.m_dev);
+    else
+        irq_stats.m_unhandled++;
+
+    irq_chip->m_eoi(irq);
+}
+
+/**
+ * @brief Switch from 8259 PIC to I/O APIC.
+ *
+ * @return true - in case of success.
+ * @return false - in case of APIC is not available.
+ */
+static bool apic_setup(void) noexcept
+{
+    using namespace arch::x86;
+
+    if (!acpi::init() || !apic::init())
+        return false;
+
+    uint32_t nr_irqs = apic::nr_gsis();
+    apic_chip.m_nr_irqs = nr_irqs < NR_IRQS ? nr_irqs : NR_IRQS;
+
+    // boot CPU handles all lines until affinity is changed
+    uint8_t dest = apic::lapic_id();
+
+    for (uint32_t cpu = 0; cpu < acpi::madt.m_nr_cpus; cpu++) {
+        if (acpi::madt.m_apic_ids[cpu] == dest) {
+            acpi::madt.m_apic_ids[cpu] = acpi::madt.m_apic_ids[0];
+            acpi::madt.m_apic_ids[0]   = dest;
+        }
+    }
+
+    for (uint32_t irq = acpi::ISA_IRQS; irq < apic_chip.m_nr_irqs; irq++)
+        apic::route(irq, idt::IRQ_BASE + irq, 0, true, dest);
+
+    // ISA lines are routed last since they can be redirected to pins of other lines (IRQ 0 - GSI 2)
+    for (uint32_t irq = 0; irq < acpi::ISA_IRQS; irq++) {
+        if (irq != pic::CASCADE_IRQ)
+            apic::route(irq_to_gsi(irq), idt::IRQ_BASE + irq, acpi::madt.m_isa_flags[irq], false, dest);
+    }
+
+    if (acpi::madt.m_has_pic)
+        pic::disable();
+
+    return true;
+}
+
+void irq_init(void) noexcept
+{
+    using namespace arch::x86;
+
+    // remapped PIC cannot raise spurious interrupts at exception vectors
+    pic::init(idt::IRQ_BASE);
+
+    irq_chip = apic_setup() ? &apic_chip : &pic_chip;
+
+    for (uint32_t i = 0; i < NR_IRQS; i++)
+        idt::set_handler(idt::IRQ_BASE + i, do_irq);
+}
+
+bool request_irq(uint32_t irq, irq_handler_t handler, const char *name, void *dev) noexcept
+{
+    using namespace arch::x86;
+
+    if (irq >= irq_chip->m_nr_irqs || irq == pic::CASCADE_IRQ || !handler || irq_desc[irq].m_handler)
+        return false;
+
+    auto flags = irq_save();
+
+    irq_desc[irq].m_handler = handler;
+    irq_desc[irq].m_dev     = dev;
+    irq_desc[irq].m_name    = name;
+    irq_chip->m_unmask(irq);
+
+    irq_restore(flags);
+    return true;
+}
+
+void free_irq(uint32_t irq) noexcept
+{
+    using namespace arch::x86;
+
+    if (irq >= irq_chip->m_nr_irqs || !irq_desc[irq].m_handler)
+        return;
+
+    auto flags = irq_save();
+
+    irq_chip->m_mask(irq);
+    irq_desc[irq].m_handler = nullptr;
+    irq_desc[irq].m_dev     = nullptr;
+
+    irq_restore(flags);
+}
+
+bool irq_set_affinity(uint32_t irq, uint32_t cpu) noexcept
+{
+    using namespace arch::x86;
+
+    if (irq >= irq_chip->m_nr_irqs || cpu >= num_online_cpus() || !irq_chip->m_set_affinity)
+        return false;
+
+    auto flags = irq_save();
+    bool ret   = irq_chip->m_set_affinity(irq, cpu);
+
+    if (ret)
+        irq_desc[irq].m_cpu = cpu;
+
+    irq_restore(flags);
+    return ret;
+}
+
+void irqstat(void) noexcept
+{
+    printk("controller: %s, %u lines\n", irq_chip->m_name, irq_chip->m_nr_irqs);
+
+    for (uint32_t i = 0; i < NR_IRQS; i++) {
+        const irq_desc_t& desc = irq_desc[i];
+        uint32_t count = 0;
+
+        for (uint32_t cpu = 0; cpu < NR_CPUS; cpu++)
+            count += desc.m_count[cpu];
+
+        if (desc.m_handler || count)
+            printk("IRQ %u: %u interrupts on CPU %u  %s\n", i, count, desc.m_cpu,
+                desc.m_handler ? desc.m_name : "<none>"
+            );
+    }
+
+    printk("spurious:  %u\n", irq_stats.m_spurious);
+    printk("unhandled: %u\n", irq_stats.m_unhandled);
+}
+
+} // namespace core
+} // namespace kernel
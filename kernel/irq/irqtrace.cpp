@@ -0,0 +1,132 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/system.hpp>
+#include <kernel/arch/x86/tsc.hpp>
+#include <kernel/kstd/cstring.hpp>
+#include <kernel/kstd/cmath.hpp>
+#include <kernel/kstd/cstdio.hpp>
+#include <kernel/irqtrace.hpp>
+#include <kernel/percpu.hpp>
+#include <kernel/printk.hpp>
+#include <kernel/bitops.hpp>
+
+
+namespace kernel {
+namespace core {
+
+#ifdef CONFIG_IRQ_TRACE
+static irq_trace_t               irq_trace[IRQ_TRACE_VECTORS];
+static percpu_t<irqsoff_trace_t> irqsoff_trace;
+
+void trace_irqs_off(void) noexcept
+{
+    auto& trace = irqsoff_trace.this_cpu();
+
+    trace.m_off      = true;
+    trace.m_start_ip = reinterpret_cast<uint32_t>(__builtin_return_address(0));
+    trace.m_start    = arch::x86::rdtsc();
+}
+
+void trace_irqs_on(void) noexcept
+{
+    uint64_t now = arch::x86::rdtsc();
+    auto& trace  = irqsoff_trace.this_cpu();
+
+    if (!trace.m_off)
+        return;
+
+    uint64_t cycles = now - trace.m_start;
+    trace.m_off     = false;
+
+    if (cycles > trace.m_max) {
+        trace.m_max       = cycles > 0xFFFFFFFF ? 0xFFFFFFFF : static_cast<uint32_t>(cycles);
+        trace.m_max_start = trace.m_start_ip;
+        trace.m_max_end   = reinterpret_cast<uint32_t>(__builtin_return_address(0));
+    }
+}
+
+void trace_irq_vector(uint32_t vector, uint64_t cycles) noexcept
+{
+    if (vector >= IRQ_TRACE_VECTORS)
+        return;
+
+    irq_trace_t& trace = irq_trace[vector];
+    uint32_t bucket    = ilog2(cycles);
+
+    if (bucket >= IRQ_TRACE_BUCKETS)
+        bucket = IRQ_TRACE_BUCKETS - 1;
+
+    trace.m_count++;
+    trace.m_total += cycles;
+    trace.m_hist[bucket]++;
+
+    if (cycles > trace.m_max)
+        trace.m_max = cycles > 0xFFFFFFFF ? 0xFFFFFFFF : static_cast<uint32_t>(cycles);
+}
+#endif // CONFIG_IRQ_TRACE
+
+void irqtrace(bool reset) noexcept
+{
+#ifdef CONFIG_IRQ_TRACE
+    // statistics are printed with interrupts enabled to not trace printing itself
+    for (uint32_t vec = 0; vec < IRQ_TRACE_VECTORS; vec++) {
+        const irq_trace_t& trace = irq_trace[vec];
+
+        if (!trace.m_count)
+            continue;
+
+        printk("vector %u: %u runs, avg %u, max %u cycles\n", vec, trace.m_count,
+            static_cast<uint32_t>(kstd::div_u64(trace.m_total, trace.m_count)), trace.m_max
+        );
+        printk("%s", "  cycles:");
+
+        for (uint32_t i = 0; i < IRQ_TRACE_BUCKETS; i++) {
+            if (trace.m_hist[i])
+                printk(" <%u:%u", 1 << (i + 1), trace.m_hist[i]);
+        }
+
+        kstd::putchar('\n');
+    }
+
+    for (uint32_t cpu = 0; cpu < num_online_cpus(); cpu++) {
+        const irqsoff_trace_t& trace = irqsoff_trace[cpu];
+
+        printk("CPU %u longest irqs-off: %u cycles from <%p> to <%p>\n",
+            cpu, trace.m_max, trace.m_max_start, trace.m_max_end
+        );
+    }
+
+    if (reset) {
+        auto flags = arch::x86::irq_save();
+
+        kstd::memset(irq_trace, 0, sizeof(irq_trace));
+
+        for (uint32_t cpu = 0; cpu < NR_CPUS; cpu++)
+            irqsoff_trace[cpu].m_max = 0;
+
+        arch::x86::irq_restore(flags);
+    }
+#else
+    (void)reset;
+    printk("%s\n", "irqtrace: kernel is built without CONFIG_IRQ_TRACE");
+#endif // CONFIG_IRQ_TRACE
+}
+
+} // namespace core
+} // namespace kernel
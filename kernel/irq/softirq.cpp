@@ -0,0 +1,246 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/system.hpp>
+#include <kernel/arch/x86/atomic.hpp>
+#include <kernel/arch/x86/tsc.hpp>
+#include <kernel/kthread.hpp>
+#include <kernel/printk.hpp>
+#include <kernel/softirq.hpp>
+
+
+namespace kernel {
+namespace core {
+
+static const char *softirq_names[NR_SOFTIRQS] = {
+    "TIMER",
+    "NET_RX",
+    "BLOCK",
+    "TASKLET"
+};
+
+/** @brief Per-CPU queue of scheduled tasklets.*/
+struct tasklet_list_t
+{
+    tasklet_t  *m_head;
+    tasklet_t **m_tail;
+};
+
+percpu_t<uint32_t>        softirq_pending;
+percpu_t<softirq_stats_t> softirq_stats;
+
+static softirq_action_t         softirq_vec[NR_SOFTIRQS];
+static percpu_t<bool>           softirq_running;    // softirqs run on CPU (no nesting)
+static percpu_t<bool>           ksoftirqd_wakeup;   // budget was exceeded
+static percpu_t<task_t*>        ksoftirqd_task;
+static percpu_t<tasklet_list_t> tasklet_vec;
+
+/**
+ * @brief Run pending softirqs within budget (interrupts disabled).
+ *
+ * @details Interrupts are enabled while handlers run and disabled again
+ * on return.
+ */
+static void do_softirq(void) noexcept
+{
+    uint32_t cpu = smp_processor_id();
+
+    // interrupt has arrived while softirqs of this CPU were running
+    if (softirq_running[cpu] || !softirq_pending[cpu])
+        return;
+
+    softirq_running[cpu] = true;
+
+    // interrupt arriving while handlers run must not switch task
+    preempt_disable();
+
+    uint64_t start   = arch::x86::rdtsc();
+    uint32_t restart = MAX_SOFTIRQ_RESTART;
+    uint32_t pending;
+
+    while ((pending = softirq_pending[cpu])) {
+        softirq_pending[cpu] = 0;
+        arch::x86::irq_enable();
+
+        for (uint32_t nr = 0; pending; nr++, pending >>= 1) {
+            if ((pending & 1) && softirq_vec[nr]) {
+                softirq_vec[nr]();
+                softirq_stats[cpu].m_count[nr]++;
+            }
+        }
+
+        arch::x86::irq_disable();
+
+        // softirqs raised again at high rate must not starve interrupted code
+        if (softirq_pending[cpu] && (!--restart || arch::x86::rdtsc() - start >= SOFTIRQ_BUDGET_CYCLES)) {
+            ksoftirqd_wakeup[cpu] = true;
+            softirq_stats[cpu].m_deferred++;
+
+            if (ksoftirqd_task[cpu])
+                wake_up_process(ksoftirqd_task[cpu]);
+
+            break;
+        }
+    }
+
+    // interrupts are disabled, so switch is left to interrupt exit
+    preempt_enable();
+    softirq_running[cpu] = false;
+}
+
+void open_softirq(uint32_t nr, softirq_action_t action) noexcept
+{
+    softirq_vec[nr] = action;
+}
+
+void raise_softirq(uint32_t nr) noexcept
+{
+    auto flags = arch::x86::irq_save();
+    raise_softirq_irqoff(nr);
+    arch::x86::irq_restore(flags);
+}
+
+void irq_exit(void) noexcept
+{
+    // deferred softirqs are left to ksoftirqd
+    if (softirq_pending.this_cpu() && !ksoftirqd_wakeup.this_cpu())
+        do_softirq();
+}
+
+/**
+ * @brief Run softirqs deferred by interrupt exit.
+ *
+ * @details Thread competes for CPU with other tasks, so softirqs raised
+ * at high rate do not starve them.
+ *
+ * @param [in] data - given unused data.
+ */
+static void run_ksoftirqd(void *data) noexcept
+{
+    (void)data;
+
+    for (;;) {
+        arch::x86::irq_disable();
+
+        uint32_t cpu = smp_processor_id();
+
+        if (ksoftirqd_wakeup[cpu]) {
+            ksoftirqd_wakeup[cpu] = false;
+            softirq_stats[cpu].m_ksoftirqd++;
+            do_softirq();
+        }
+        else {
+            // wakeup cannot be missed with interrupts disabled
+            set_current_state(task_state::SLEEPING);
+            schedule();
+        }
+
+        arch::x86::irq_enable();
+    }
+}
+
+bool spawn_ksoftirqd(void) noexcept
+{
+    task_t *task = kthread_run(run_ksoftirqd, nullptr, "ksoftirqd");
+
+    if (!task)
+        return false;
+
+    ksoftirqd_task.this_cpu() = task;
+    return true;
+}
+
+/** @brief Run tasklets scheduled on current CPU.*/
+static void tasklet_action(void) noexcept
+{
+    auto flags = arch::x86::irq_save();
+
+    tasklet_list_t& list = tasklet_vec.this_cpu();
+    tasklet_t *t = list.m_head;
+
+    list.m_head = nullptr;
+    list.m_tail = &list.m_head;
+
+    arch::x86::irq_restore(flags);
+
+    while (t) {
+        tasklet_t *next = t->m_next;
+
+        // tasklet can be scheduled again while it runs
+        t->m_scheduled = 0;
+        t->m_func(t->m_data);
+        t = next;
+    }
+}
+
+void softirq_init(void) noexcept
+{
+    for (uint32_t cpu = 0; cpu < NR_CPUS; cpu++)
+        tasklet_vec[cpu] = {nullptr, &tasklet_vec[cpu].m_head};
+
+    open_softirq(SOFTIRQ::TASKLET, tasklet_action);
+}
+
+void tasklet_init(tasklet_t *t, void (*func)(void *data) noexcept, void *data) noexcept
+{
+    t->m_next      = nullptr;
+    t->m_func      = func;
+    t->m_data      = data;
+    t->m_scheduled = 0;
+}
+
+void tasklet_schedule(tasklet_t *t) noexcept
+{
+    if (arch::x86::xchg(&t->m_scheduled, 1))
+        return;
+
+    auto flags = arch::x86::irq_save();
+
+    tasklet_list_t& list = tasklet_vec.this_cpu();
+
+    t->m_next    = nullptr;
+    *list.m_tail = t;
+    list.m_tail  = &t->m_next;
+    raise_softirq_irqoff(SOFTIRQ::TASKLET);
+
+    arch::x86::irq_restore(flags);
+}
+
+void softirqstat(void) noexcept
+{
+    for (uint32_t nr = 0; nr < NR_SOFTIRQS; nr++) {
+        uint32_t count = 0;
+
+        for (uint32_t cpu = 0; cpu < NR_CPUS; cpu++)
+            count += softirq_stats[cpu].m_count[nr];
+
+        printk("%s: %u\n", softirq_names[nr], count);
+    }
+
+    uint32_t deferred = 0, runs = 0;
+
+    for (uint32_t cpu = 0; cpu < NR_CPUS; cpu++) {
+        deferred += softirq_stats[cpu].m_deferred;
+        runs     += softirq_stats[cpu].m_ksoftirqd;
+    }
+
+    printk("budget exceeded: %u, ksoftirqd runs: %u\n", deferred, runs);
+}
+
+} // namespace core
+} // namespace kernel
@@ -17,15 +17,31 @@
  */
 
 #include <kernel/drivers/keyboard.hpp>
+#include <kernel/drivers/zram.hpp>
+#include <kernel/drivers/hpet.hpp>
 #include <kernel/arch/x86/gdt.hpp>
+#include <kernel/arch/x86/idt.hpp>
 #include <kernel/shell/shell.hpp>
+#include <kernel/clocksource.hpp>
+#include <kernel/clockevent.hpp>
 #include <kernel/terminal.hpp>
 #include <kernel/linkage.hpp>
 #include <kernel/printk.hpp>
 #include <kernel/panic.hpp>
 #include <kernel/core.hpp>
+#include <kernel/mmap.hpp>
+#include <kernel/swap.hpp>
 #include <kernel/slab.hpp>
+#include <kernel/softirq.hpp>
+#include <kernel/mempool.hpp>
+#include <kernel/sched.hpp>
+#include <kernel/ksm.hpp>
+#include <kernel/hrtimer.hpp>
+#include <kernel/timer.hpp>
+#include <kernel/tick.hpp>
+#include <kernel/irq.hpp>
 #include <kernel/pmm.hpp>
+#include <kernel/vmm.hpp>
 
 
 namespace kernel {
@@ -39,15 +55,15 @@ namespace core {
  */
 static void kboot(uint32_t magic, const multiboot_t& mboot) noexcept
 {
+    // set kernel address space
+    core::memory::vmm.init(mboot);
+
     // set kernel subsystems
     driver::vesa.set(mboot);
     tty::terminal.set();
     printk(KERN_OK "%s\n", "initialized VESA driver");
     printk(KERN_OK "%s\n", "initialized kernel terminal");
 
-    driver::keyboard.set();
-    printk(KERN_OK "%s\n", "initialized PS/2 keyboard driver");
-
     shell.set();
     printk(KERN_OK "%s\n", "initialized kernel shell");
 
@@ -57,12 +73,62 @@ static void kboot(uint32_t magic, const multiboot_t& mboot) noexcept
     arch::x86::gdt::init();
     printk(KERN_OK "%s\n", "initialized GDT");
 
+    arch::x86::idt::init();
+    printk(KERN_OK "%s\n", "initialized IDT");
+
+    irq_init();
+    printk(KERN_OK "initialized %s\n", irq_chip->m_name);
+
+    softirq_init();
+    printk(KERN_OK "%s\n", "initialized softirqs");
+
+    timers_init();
+    printk(KERN_OK "%s\n", "initialized timer wheel");
+
+    if (driver::hpet.set())
+        printk(KERN_OK "%s\n", "initialized HPET");
+
+    clocksource_init();
+    printk(KERN_OK "initialized %s clocksource\n", clocksource->m_name);
+
+    clockevent_init();
+
+    if (hrtimers_init())
+        printk(KERN_OK "initialized high-resolution timers on %s clockevent\n", clockevent->m_name);
+
+    if (tick_init())
+        printk(KERN_OK "initialized tickless idle on %s clockevent\n", clockevent->m_name);
+
+    driver::keyboard.set();
+    printk(KERN_OK "%s\n", "initialized PS/2 keyboard driver");
+
     core::memory::pmm.init(mboot);
     printk(KERN_OK "%s\n", "initialized physical memory manager");
 
     kmem::init();
     printk(KERN_OK "%s\n", "initialized kernel heap");
 
+    core::memory::mm_init();
+    printk(KERN_OK "%s\n", "initialized demand paging");
+
+    if (driver::zram.set(driver::ZRAM_PAGES))
+        printk(KERN_OK "%s\n", "initialized compressed RAM swap");
+
+    if (core::memory::swap_init())
+        printk(KERN_OK "%s\n", "initialized swap on primary IDE disk");
+
+    // boot thread continues as shell task
+    if (!sched_init("shell"))
+        panic("%s\n", "failed to initialize scheduler");
+
+    printk(KERN_OK "%s\n", "initialized scheduler");
+
+    if (spawn_ksoftirqd() && core::memory::mempool_init() && core::memory::ksm_init())
+        printk(KERN_OK "%s\n", "started ksoftirqd, kmempoold & ksmd threads");
+
+    // devices are handled by interrupts from now on
+    arch::x86::irq_enable();
+
     shell.process();
 }
 
@@ -0,0 +1,276 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/system.hpp>
+#include <kernel/arch/x86/idt.hpp>
+#include <kernel/kstd/cstring.hpp>
+#include <kernel/mmap.hpp>
+#include <kernel/panic.hpp>
+#include <kernel/swap.hpp>
+#include <kernel/tlb.hpp>
+#include <kernel/pmm.hpp>
+
+
+namespace kernel {
+namespace core {
+namespace memory {
+
+uint32_t fault_around_pages {16};
+
+// shared source of reads from untouched anonymous memory
+static page_t *zero_page;
+
+void mm_t::fault_around(const vm_area_t *vma, uint32_t addr, uint32_t prot) noexcept
+{
+    uint32_t n = fault_around_pages;
+
+    if (n <= 1 || n > PTRS_PER_PTE || (n & (n - 1)))
+        return;
+
+    // aligned window never crosses page table boundary
+    uint32_t window = n << PAGE_SHIFT;
+    uint32_t start  = addr & ~(window - 1);
+    uint32_t end    = start + window;
+
+    if (start < vma->m_start)
+        start = vma->m_start;
+
+    if (end > vma->m_end || end < start)
+        end = vma->m_end;
+
+    for (uint32_t a = start; a < end; a += PAGE_SIZE) {
+        if (a == addr)
+            continue;
+
+        // only pages that are already resident are mapped
+        size_t pgoff = vma->m_pgoff + ((a - vma->m_start) >> PAGE_SHIFT);
+        page_t *page = vma->m_file->find_page(pgoff);
+
+        if (!page)
+            continue;
+
+        pte_t *pte = get_pte(m_pgdir, a, false);
+
+        // swapped out private copy must not be replaced by file page
+        if (!pte || *pte)
+            continue;
+
+        get_page(page);
+        *pte = PFN_PHYS(page->m_pfn) | prot;
+        m_stats.m_around++;
+    }
+}
+
+bool mm_t::do_wp_page(uint32_t addr, pte_t *pte) noexcept
+{
+    page_t *page = pmm.get_page(*pte & PTE_ADDR_MASK);
+
+    // the last user can write to the page in place
+    if (page != zero_page && page_count(page) == 1) {
+        *pte |= PTE_WRITE;
+        flush_tlb_page(addr);
+        page_add_anon_rmap(page, this, addr);
+        m_stats.m_reuse++;
+        return true;
+    }
+
+    page_t *copy = pmm.alloc_pages(GFP::KERNEL, 0);
+
+    if (!copy)
+        return false;
+
+    kstd::memcpy(copy->addr(), page->addr(), PAGE_SIZE);
+
+    *pte = PFN_PHYS(copy->m_pfn) | PTE_PRESENT | PTE_USER | PTE_WRITE;
+    flush_tlb_page(addr);
+    page_add_anon_rmap(copy, this, addr);
+    page_remove_rmap(page, this);
+    put_page(page);
+    m_stats.m_cow++;
+
+    return true;
+}
+
+bool mm_t::do_swap_page(const vm_area_t *vma, uint32_t addr, pte_t *pte, bool write) noexcept
+{
+    swp_entry_t entry = pte_to_swp_entry(*pte);
+    page_t *page      = swapin_readahead(entry);
+
+    if (!page)
+        return false;
+
+    // swap cache keeps the page while other entries refer to the slot
+    get_page(page);
+    swap_free(entry);
+
+    uint32_t prot = PTE_PRESENT | PTE_USER;
+
+    if ((vma->m_flags & VM::WRITE) && ((vma->m_flags & VM::SHARED) || page_count(page) == 1))
+        prot |= PTE_WRITE;
+
+    *pte = PFN_PHYS(page->m_pfn) | prot;
+    page_add_anon_rmap(page, this, addr);
+    m_stats.m_swapin++;
+
+    if (write && !(prot & PTE_WRITE))
+        return do_wp_page(addr, pte);
+
+    return true;
+}
+
+bool mm_t::handle_fault(uint32_t addr, uint32_t err) noexcept
+{
+    m_stats.m_faults++;
+
+    vm_area_t *vma = find_vma(addr);
+    bool write     = err & PF_WRITE;
+
+    if (!vma || addr < vma->m_start || (write && !(vma->m_flags & VM::WRITE))) {
+        m_stats.m_errors++;
+        return false;
+    }
+
+    uint32_t page_addr = addr & PTE_ADDR_MASK;
+    pte_t *pte         = get_pte(m_pgdir, page_addr, true);
+
+    if (!pte) {
+        m_stats.m_errors++;
+        return false;
+    }
+
+    if (*pte & PTE_PRESENT) {
+        // fault raced with fault-around of the same window
+        if (!write || (*pte & PTE_WRITE))
+            return true;
+
+        if (do_wp_page(page_addr, pte))
+            return true;
+
+        m_stats.m_errors++;
+        return false;
+    }
+
+    if (*pte) {
+        if (do_swap_page(vma, page_addr, pte, write))
+            return true;
+
+        m_stats.m_errors++;
+        return false;
+    }
+
+    // private pages are mapped read-only until the first write
+    bool shared   = vma->m_flags & VM::SHARED;
+    uint32_t prot = PTE_PRESENT | PTE_USER;
+
+    if ((vma->m_flags & VM::WRITE) && shared)
+        prot |= PTE_WRITE;
+
+    page_t *page;
+
+    if (!vma->m_file) {
+        // write to shared area has to be seen through all its mappings
+        if (!write && !shared) {
+            get_page(zero_page);
+            *pte = PFN_PHYS(zero_page->m_pfn) | PTE_PRESENT | PTE_USER;
+            m_stats.m_zero++;
+            return true;
+        }
+
+        page = pmm.alloc_pages(GFP::KERNEL | GFP::ZERO, 0);
+
+        if (!page) {
+            m_stats.m_errors++;
+            return false;
+        }
+
+        *pte = PFN_PHYS(page->m_pfn) | (shared ? prot : PTE_PRESENT | PTE_USER | PTE_WRITE);
+        page_add_anon_rmap(page, this, page_addr);
+        m_stats.m_anon++;
+        return true;
+    }
+
+    size_t pgoff = vma->m_pgoff + ((page_addr - vma->m_start) >> PAGE_SHIFT);
+    page         = vma->m_file->find_page(pgoff);
+
+    if (!page) {
+        page = vma->m_file->read_page(pgoff);
+
+        if (!page) {
+            m_stats.m_errors++;
+            return false;
+        }
+
+        m_stats.m_major++;
+    }
+
+    get_page(page);
+    *pte = PFN_PHYS(page->m_pfn) | prot;
+    m_stats.m_file++;
+
+    fault_around(vma, page_addr, prot);
+
+    // write to private file page copies it out of the page cache
+    if (write && !shared && !do_wp_page(page_addr, pte)) {
+        m_stats.m_errors++;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Page fault exception handler.
+ *
+ * @param [in] regs - given saved registers.
+ */
+static void page_fault(arch::x86::idt::regs_t *regs) noexcept
+{
+    uint32_t addr = arch::x86::read_cr2();
+    bool irqs_on  = regs->m_eflags & arch::x86::EFLAGS_IF;
+
+    // interrupt gate disabled interrupts, but swap I/O may be long
+    if (irqs_on)
+        arch::x86::irq_enable();
+
+    // kernel memory is always mapped
+    bool handled = addr < PAGE_OFFSET && current_mm()->handle_fault(addr, regs->m_err_code);
+
+    if (irqs_on)
+        arch::x86::irq_disable();
+
+    if (handled)
+        return;
+
+    panic("page fault at <%08p> (err: %#X) at <%08p>\n", addr, regs->m_err_code, regs->m_eip);
+}
+
+void mm_init(void) noexcept
+{
+    // zero page reference is never dropped, so it is always copied on write
+    zero_page = pmm.get_zeroed_page(GFP::KERNEL | GFP::ZERO);
+
+    if (!zero_page)
+        panic("%s\n", "failed to allocate zero page");
+
+    init_mm.m_pgdir = vmm.m_pgdir;
+    arch::x86::idt::set_handler(arch::x86::idt::VEC_PAGE_FAULT, page_fault);
+}
+
+} // namespace memory
+} // namespace core
+} // namespace kernel
@@ -0,0 +1,660 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/kstd/cstring.hpp>
+#include <kernel/kthread.hpp>
+#include <kernel/printk.hpp>
+#include <kernel/mutex.hpp>
+#include <kernel/tick.hpp>
+#include <kernel/mmap.hpp>
+#include <kernel/slab.hpp>
+#include <kernel/ksm.hpp>
+#include <kernel/tlb.hpp>
+#include <kernel/pmm.hpp>
+
+
+namespace kernel {
+namespace core {
+namespace memory {
+
+bool        ksm_run;
+uint32_t    ksm_pages_to_scan {100};
+ksm_stats_t ksm_stats;
+
+static ksm_mm_t       *ksm_mm_list;     // registered address spaces
+static kstd::rb_root_t stable_tree;
+static kstd::rb_root_t unstable_tree;
+static uint32_t        ksm_seqnr;       // current full scan
+static core::task_t   *ksmd;
+
+// scanner position
+static ksm_mm_t    *scan_slot;
+static uint32_t     scan_addr;
+static ksm_item_t **scan_link;          // where item of the next page is linked
+
+/**
+ * @brief Hash page contents.
+ *
+ * @param [in] page - given page struct.
+ * @return contents hash.
+ */
+static uint32_t calc_checksum(const page_t *page) noexcept
+{
+    auto words    = static_cast<const uint32_t*>(page->addr());
+    uint32_t hash = 2166136261U;
+
+    for (uint32_t i = 0; i < PAGE_SIZE / sizeof(uint32_t); i++)
+        hash = (hash ^ words[i]) * 16777619U;
+
+    return hash;
+}
+
+/**
+ * @brief Change page table entry of possibly active address space.
+ *
+ * @param [in] mm - given address space.
+ * @param [in] addr - given virtual address.
+ * @param [out] pte - given page table entry.
+ * @param [in] val - given new entry value.
+ */
+static void set_pte(const mm_t *mm, uint32_t addr, pte_t *pte, pte_t val) noexcept
+{
+    *pte = val;
+
+    if (mm->m_pgdir == vmm.m_active)
+        flush_tlb_page(addr);
+}
+
+/**
+ * @brief Get exclusively mapped anonymous page that can be merged.
+ *
+ * @param [in] mm - given address space.
+ * @param [in] addr - given page address.
+ * @param [out] ptep - given page table entry of the page.
+ * @return page struct - in case of success.
+ * @return nullptr - in case of page is not mapped, shared or not anonymous.
+ */
+static page_t *get_mergeable_page(const mm_t *mm, uint32_t addr, pte_t **ptep) noexcept
+{
+    pte_t *pte = get_pte(mm->m_pgdir, addr, false);
+
+    if (!pte || !(*pte & PTE_PRESENT))
+        return nullptr;
+
+    page_t *page = pmm.get_page(*pte & PTE_ADDR_MASK);
+
+    // zero page & file pages are never on reclaim lists
+    if (!(page->m_flags & PG::LRU) || (page->m_flags & (PG::KSM | PG::SWAP)) || page_count(page) != 1)
+        return nullptr;
+
+    *ptep = pte;
+    return page;
+}
+
+/**
+ * @brief Replace page by identical shared frame.
+ *
+ * @param [in] mm - given address space.
+ * @param [in] addr - given page address.
+ * @param [in] pte - given page table entry of the page.
+ * @param [in] page - given exclusively mapped page.
+ * @param [in] kpage - given write-protected frame.
+ * @return true - in case of page was replaced.
+ * @return false - in case of contents differ.
+ */
+static bool merge_page(mm_t *mm, uint32_t addr, pte_t *pte, page_t *page, page_t *kpage) noexcept
+{
+    // writes after comparison would be lost, so they fault first
+    set_pte(mm, addr, pte, *pte & ~PTE_WRITE);
+
+    if (kstd::memcmp(page->addr(), kpage->addr(), PAGE_SIZE))
+        return false;
+
+    get_page(kpage);
+    set_pte(mm, addr, pte, PFN_PHYS(kpage->m_pfn) | (*pte & ~(PTE_ADDR_MASK | PTE_WRITE)));
+
+    page_remove_rmap(page, mm);
+    put_page(page);
+    ksm_stats.m_merged++;
+
+    return true;
+}
+
+/**
+ * @brief Find shared frame with the same contents as page.
+ *
+ * @param [in] page - given page struct.
+ * @param [in] checksum - given page contents hash.
+ * @return stable tree node - in case of success.
+ * @return nullptr - in case of there is no such frame.
+ */
+static ksm_stable_t *stable_search(const page_t *page, uint32_t checksum) noexcept
+{
+    kstd::rb_node_t *node  = stable_tree.m_node;
+    kstd::rb_node_t *first = nullptr;
+
+    // the leftmost node with equal hash
+    while (node) {
+        auto stable = rb_entry(node, ksm_stable_t, m_rb);
+
+        if (checksum <= stable->m_checksum) {
+            if (checksum == stable->m_checksum)
+                first = node;
+
+            node = node->m_left;
+        }
+        else
+            node = node->m_right;
+    }
+
+    // different contents of the same hash follow each other
+    for (node = first; node; node = kstd::rb_next(node)) {
+        auto stable = rb_entry(node, ksm_stable_t, m_rb);
+
+        if (stable->m_checksum != checksum)
+            break;
+
+        if (!kstd::memcmp(page->addr(), stable->m_page->addr(), PAGE_SIZE))
+            return stable;
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Insert node into tree ordered by checksum.
+ *
+ * @param [in,out] root - given tree.
+ * @param [in] node - given node.
+ * @param [in] checksum - given node checksum.
+ * @param [in] key - given checksum of tree node.
+ */
+static void tree_insert(kstd::rb_root_t& root, kstd::rb_node_t *node, uint32_t checksum,
+                        uint32_t (*key)(kstd::rb_node_t*) noexcept) noexcept
+{
+    kstd::rb_node_t **link  = &root.m_node;
+    kstd::rb_node_t *parent = nullptr;
+
+    while (*link) {
+        parent = *link;
+        link   = checksum < key(parent) ? &parent->m_left : &parent->m_right;
+    }
+
+    root.insert(node, parent, link);
+}
+
+/**
+ * @brief Get checksum of stable tree node.
+ *
+ * @param [in] node - given tree node.
+ * @return checksum.
+ */
+static uint32_t stable_key(kstd::rb_node_t *node) noexcept
+{
+    return rb_entry(node, ksm_stable_t, m_rb)->m_checksum;
+}
+
+/**
+ * @brief Get checksum of unstable tree node.
+ *
+ * @param [in] node - given tree node.
+ * @return checksum.
+ */
+static uint32_t unstable_key(kstd::rb_node_t *node) noexcept
+{
+    return rb_entry(node, ksm_item_t, m_rb)->m_checksum;
+}
+
+/**
+ * @brief Remove item from unstable tree of the current scan.
+ *
+ * @param [in] item - given item.
+ */
+static void unstable_remove(ksm_item_t *item) noexcept
+{
+    // unstable tree of previous scans is already dropped
+    if (item->m_unstable && item->m_seqnr == ksm_seqnr) {
+        unstable_tree.erase(&item->m_rb);
+        ksm_stats.m_pages_unshared--;
+    }
+
+    item->m_unstable = false;
+}
+
+/**
+ * @brief Find unstable tree item with the same contents as page.
+ *
+ * @param [in] item - given item of the page.
+ * @param [in] page - given page struct.
+ * @param [out] ptep - given page table entry of found page.
+ * @param [out] pagep - given found page.
+ * @return unstable tree item - in case of success.
+ * @return nullptr - in case of there is no such page.
+ */
+static ksm_item_t *unstable_search(const ksm_item_t *item, const page_t *page, pte_t **ptep, page_t **pagep) noexcept
+{
+    kstd::rb_node_t *node  = unstable_tree.m_node;
+    kstd::rb_node_t *first = nullptr;
+
+    while (node) {
+        uint32_t key = unstable_key(node);
+
+        if (item->m_checksum <= key) {
+            if (item->m_checksum == key)
+                first = node;
+
+            node = node->m_left;
+        }
+        else
+            node = node->m_right;
+    }
+
+    for (node = first; node && unstable_key(node) == item->m_checksum; node = kstd::rb_next(node)) {
+        auto other = rb_entry(node, ksm_item_t, m_rb);
+
+        // page may have been unmapped, swapped out or written since
+        page_t *opage = get_mergeable_page(other->m_slot->m_mm, other->m_addr, ptep);
+
+        if (!opage || kstd::memcmp(page->addr(), opage->addr(), PAGE_SIZE))
+            continue;
+
+        *pagep = opage;
+        return other;
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Forget shared frame of item releasing the frame after the last item.
+ *
+ * @param [in] item - given merged item.
+ */
+static void unmerge_item(ksm_item_t *item) noexcept
+{
+    ksm_stable_t *stable = item->m_stable;
+    item->m_stable       = nullptr;
+
+    if (--stable->m_rmap_count) {
+        ksm_stats.m_pages_sharing--;
+        return;
+    }
+
+    // remaining mappings keep frame as ordinary copy-on-write page
+    stable_tree.erase(&stable->m_rb);
+    stable->m_page->m_flags &= ~PG::KSM;
+    put_page(stable->m_page);
+    kfree(stable);
+    ksm_stats.m_pages_shared--;
+}
+
+/**
+ * @brief Free item.
+ *
+ * @param [in] item - given item.
+ */
+static void free_item(ksm_item_t *item) noexcept
+{
+    if (item->m_stable)
+        unmerge_item(item);
+
+    unstable_remove(item);
+    kfree(item);
+}
+
+/**
+ * @brief Merge page with identical page of unstable tree item into new shared frame.
+ *
+ * @param [in] item - given item of the page.
+ * @param [in] pte - given page table entry of the page.
+ * @param [in] page - given page struct.
+ * @param [in] other - given unstable tree item.
+ * @param [in] opte - given page table entry of unstable tree page.
+ * @param [in] opage - given unstable tree page.
+ */
+static void merge_unstable(ksm_item_t *item, pte_t *pte, page_t *page,
+                           ksm_item_t *other, pte_t *opte, page_t *opage) noexcept
+{
+    auto stable = static_cast<ksm_stable_t*>(kmalloc(sizeof(ksm_stable_t), GFP::KERNEL));
+
+    if (!stable)
+        return;
+
+    mm_t *omm = other->m_slot->m_mm;
+    set_pte(omm, other->m_addr, opte, *opte & ~PTE_WRITE);
+
+    if (!merge_page(item->m_slot->m_mm, item->m_addr, pte, page, opage)) {
+        kfree(stable);
+        return;
+    }
+
+    // tree reference keeps frame from being reused in place on write
+    get_page(opage);
+    opage->m_flags |= PG::KSM;
+
+    stable->m_page       = opage;
+    stable->m_checksum   = item->m_checksum;
+    stable->m_rmap_count = 2;
+    tree_insert(stable_tree, &stable->m_rb, stable->m_checksum, stable_key);
+
+    unstable_remove(other);
+    other->m_stable = stable;
+    item->m_stable  = stable;
+
+    ksm_stats.m_pages_shared++;
+    ksm_stats.m_pages_sharing++;
+}
+
+/**
+ * @brief Try to merge page of item.
+ *
+ * @param [in] item - given item.
+ * @param [in] pte - given page table entry.
+ * @param [in] page - given page struct.
+ */
+static void scan_page(ksm_item_t *item, pte_t *pte, page_t *page) noexcept
+{
+    uint32_t checksum = calc_checksum(page);
+    ksm_stable_t *stable = stable_search(page, checksum);
+
+    if (stable && merge_page(item->m_slot->m_mm, item->m_addr, pte, page, stable->m_page)) {
+        unstable_remove(item);
+        item->m_stable = stable;
+        stable->m_rmap_count++;
+        ksm_stats.m_pages_sharing++;
+        return;
+    }
+
+    // frequently written pages are not worth the unstable tree
+    if (checksum != item->m_checksum) {
+        unstable_remove(item);
+        item->m_checksum = checksum;
+        ksm_stats.m_pages_volatile++;
+        return;
+    }
+
+    // page is already in unstable tree of this scan
+    if (item->m_unstable && item->m_seqnr == ksm_seqnr)
+        return;
+
+    pte_t *opte;
+    page_t *opage;
+    ksm_item_t *other = unstable_search(item, page, &opte, &opage);
+
+    if (other) {
+        merge_unstable(item, pte, page, other, opte, opage);
+        return;
+    }
+
+    item->m_unstable = true;
+    item->m_seqnr    = ksm_seqnr;
+    tree_insert(unstable_tree, &item->m_rb, checksum, unstable_key);
+    ksm_stats.m_pages_unshared++;
+}
+
+/**
+ * @brief Find the next mapped anonymous page of mergeable areas.
+ *
+ * @param [in] mm - given address space.
+ * @param [in,out] addr - given address to search from, set to found page address.
+ * @return page table entry - in case of success.
+ * @return nullptr - in case of there are no pages left.
+ */
+static pte_t *next_page(mm_t *mm, uint32_t& addr) noexcept
+{
+    for (vm_area_t *vma = mm->find_vma(addr); vma; vma = vma->m_next) {
+        if (!(vma->m_flags & VM::MERGEABLE) || (vma->m_flags & VM::SHARED) || vma->m_file)
+            continue;
+
+        uint32_t a = addr > vma->m_start ? addr : vma->m_start;
+
+        for (; a < vma->m_end; a += PAGE_SIZE) {
+            // skip the whole 4 MB range of missing page table
+            if (!(mm->m_pgdir[a >> PGDIR_SHIFT] & PTE_PRESENT)) {
+                a = (a | (LARGE_PAGE_SIZE - 1)) - PAGE_SIZE + 1;
+                continue;
+            }
+
+            pte_t *pte = get_pte(mm->m_pgdir, a, false);
+
+            if (pte && (*pte & PTE_PRESENT)) {
+                addr = a;
+                return pte;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Get item of page address creating it if needed.
+ *
+ * @param [in] addr - given page address.
+ * @return item - in case of success.
+ * @return nullptr - in case of allocation error.
+ */
+static ksm_item_t *get_next_item(uint32_t addr) noexcept
+{
+    // addresses passed by scanner are no longer mapped
+    while (*scan_link && (*scan_link)->m_addr < addr) {
+        ksm_item_t *stale = *scan_link;
+        *scan_link = stale->m_next;
+        free_item(stale);
+    }
+
+    if (*scan_link && (*scan_link)->m_addr == addr)
+        return *scan_link;
+
+    auto item = static_cast<ksm_item_t*>(kmalloc(sizeof(ksm_item_t), GFP::KERNEL));
+
+    if (!item)
+        return nullptr;
+
+    kstd::memset(item, 0, sizeof(ksm_item_t));
+    item->m_slot = scan_slot;
+    item->m_addr = addr;
+    item->m_next = *scan_link;
+    *scan_link   = item;
+
+    return item;
+}
+
+/** @brief Free items left after the last page of address space and move to the next one.*/
+static void next_slot(void) noexcept
+{
+    while (*scan_link) {
+        ksm_item_t *stale = *scan_link;
+        *scan_link = stale->m_next;
+        free_item(stale);
+    }
+
+    scan_slot = scan_slot->m_next;
+    scan_addr = 0;
+
+    if (scan_slot) {
+        scan_link = &scan_slot->m_items;
+        return;
+    }
+
+    // pages of unstable tree may have changed since they were added
+    unstable_tree.m_node       = nullptr;
+    ksm_stats.m_pages_unshared = 0;
+    ksm_stats.m_full_scans++;
+    ksm_seqnr++;
+}
+
+bool ksm_enter(mm_t *mm) noexcept
+{
+    if (mm->m_ksm)
+        return true;
+
+    auto slot = static_cast<ksm_mm_t*>(kmalloc(sizeof(ksm_mm_t), GFP::KERNEL));
+
+    if (!slot)
+        return false;
+
+    slot->m_mm    = mm;
+    slot->m_items = nullptr;
+    slot->m_next  = ksm_mm_list;
+    ksm_mm_list   = slot;
+    mm->m_ksm     = slot;
+
+    return true;
+}
+
+void ksm_exit(mm_t *mm) noexcept
+{
+    ksm_mm_t *slot = mm->m_ksm;
+
+    if (!slot)
+        return;
+
+    // scanner moves on to the next address space
+    if (scan_slot == slot) {
+        scan_slot = slot->m_next;
+        scan_addr = 0;
+        scan_link = scan_slot ? &scan_slot->m_items : nullptr;
+    }
+
+    while (slot->m_items) {
+        ksm_item_t *item = slot->m_items;
+        slot->m_items    = item->m_next;
+        free_item(item);
+    }
+
+    for (ksm_mm_t **link = &ksm_mm_list; *link; link = &(*link)->m_next) {
+        if (*link == slot) {
+            *link = slot->m_next;
+            break;
+        }
+    }
+
+    kfree(slot);
+    mm->m_ksm = nullptr;
+}
+
+void ksm_scan(uint32_t nr_pages) noexcept
+{
+    if (!ksm_mm_list)
+        return;
+
+    uint32_t full_scans = ksm_stats.m_full_scans;
+
+    while (nr_pages) {
+        if (!scan_slot) {
+            scan_slot = ksm_mm_list;
+            scan_addr = 0;
+            scan_link = &scan_slot->m_items;
+        }
+
+        uint32_t addr = scan_addr;
+        pte_t *pte    = next_page(scan_slot->m_mm, addr);
+
+        if (!pte) {
+            next_slot();
+
+            // registered address spaces may have no pages left to scan
+            if (ksm_stats.m_full_scans != full_scans)
+                return;
+
+            continue;
+        }
+
+        scan_addr = addr + PAGE_SIZE;
+        nr_pages--;
+        ksm_stats.m_scanned++;
+
+        ksm_item_t *item = get_next_item(addr);
+
+        if (!item)
+            return;
+
+        scan_link    = &item->m_next;
+        page_t *page = pmm.get_page(*pte & PTE_ADDR_MASK);
+
+        // merged address still maps its frame
+        if (item->m_stable && item->m_stable->m_page == page)
+            continue;
+
+        // frame was copied on write or unmapped
+        if (item->m_stable)
+            unmerge_item(item);
+
+        if (get_mergeable_page(scan_slot->m_mm, addr, &pte))
+            scan_page(item, pte, page);
+    }
+}
+
+/**
+ * @brief Scan pages in batches while scanner is enabled.
+ *
+ * @param [in] data - given unused data.
+ */
+static void run_ksmd(void *data) noexcept
+{
+    (void)data;
+
+    for (;;) {
+        arch::x86::irq_disable();
+
+        // ksm_set_run() wakes thread up
+        if (!ksm_run) {
+            core::set_current_state(core::task_state::SLEEPING);
+            core::schedule();
+        }
+
+        arch::x86::irq_enable();
+
+        core::kernel_lock.lock();
+        ksm_scan(ksm_pages_to_scan);
+        core::kernel_lock.unlock();
+
+        core::schedule_timeout(core::msecs_to_jiffies(KSM_SLEEP_MS));
+    }
+}
+
+bool ksm_init(void) noexcept
+{
+    ksmd = core::kthread_run(run_ksmd, nullptr, "ksmd");
+    return ksmd;
+}
+
+void ksm_set_run(bool run) noexcept
+{
+    ksm_run = run;
+
+    if (run && ksmd)
+        core::wake_up_process(ksmd);
+}
+
+void ksmstat(void) noexcept
+{
+    printk("run:            %s, %u pages per run\n", ksm_run ? "on" : "off", ksm_pages_to_scan);
+    printk("pages shared:   %u\n", ksm_stats.m_pages_shared);
+    printk("pages sharing:  %u\n", ksm_stats.m_pages_sharing);
+    printk("pages unshared: %u\n", ksm_stats.m_pages_unshared);
+    printk("pages volatile: %u\n", ksm_stats.m_pages_volatile);
+    printk("scanned:        %u pages, %u full scans, %u merged\n",
+        ksm_stats.m_scanned, ksm_stats.m_full_scans, ksm_stats.m_merged
+    );
+}
+
+} // namespace memory
+} // namespace core
+} // namespace kernel
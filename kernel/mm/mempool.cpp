@@ -0,0 +1,308 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/system.hpp>
+#include <kernel/kthread.hpp>
+#include <kernel/mempool.hpp>
+#include <kernel/mutex.hpp>
+#include <kernel/tick.hpp>
+#include <kernel/pmm.hpp>
+
+
+namespace kernel {
+namespace core {
+namespace memory {
+
+inline const uint32_t MEMPOOL_RETRY_MS {100};  // delay before refill that failed is retried
+
+static mempool_t    *refill_queue {nullptr}; // pools waiting for refill
+static core::task_t *kmempoold    {nullptr};
+
+/**
+ * @brief Allocate slab cache object.
+ *
+ * @param [in] flags - given allocation flags.
+ * @param [in] pool_data - given slab cache.
+ * @return allocated object pointer.
+ */
+static void *mempool_alloc_slab(gfp_t flags, void *pool_data) noexcept
+{
+    return static_cast<kmem::cache_t*>(pool_data)->alloc(flags);
+}
+
+/**
+ * @brief Free slab cache object.
+ *
+ * @param [in] element - given object to free.
+ * @param [in] pool_data - given slab cache.
+ */
+static void mempool_free_slab(void *element, void *pool_data) noexcept
+{
+    (void)pool_data;
+    kfree(element);
+}
+
+/**
+ * @brief Allocate kmalloc() object.
+ *
+ * @param [in] flags - given allocation flags.
+ * @param [in] pool_data - given object size.
+ * @return allocated object pointer.
+ */
+static void *mempool_kmalloc(gfp_t flags, void *pool_data) noexcept
+{
+    return kmalloc(reinterpret_cast<size_t>(pool_data), flags);
+}
+
+/**
+ * @brief Free kmalloc() object.
+ *
+ * @param [in] element - given object to free.
+ * @param [in] pool_data - given object size.
+ */
+static void mempool_kfree(void *element, void *pool_data) noexcept
+{
+    (void)pool_data;
+    kfree(element);
+}
+
+/**
+ * @brief Allocate pages.
+ *
+ * @param [in] flags - given allocation flags.
+ * @param [in] pool_data - given power of two (2^order pages).
+ * @return allocated pages address.
+ */
+static void *mempool_alloc_pages(gfp_t flags, void *pool_data) noexcept
+{
+    auto order   = reinterpret_cast<uint32_t>(pool_data);
+    page_t *page = pmm.alloc_pages(flags, order);
+
+    return page ? page->addr() : nullptr;
+}
+
+/**
+ * @brief Free pages.
+ *
+ * @param [in] element - given pages address.
+ * @param [in] pool_data - given power of two (2^order pages).
+ */
+static void mempool_free_pages(void *element, void *pool_data) noexcept
+{
+    pmm.free_pages(virt_to_phys(element), reinterpret_cast<uint32_t>(pool_data));
+}
+
+inline void mempool_t::add_element(void *element) noexcept
+{
+    m_elements[m_curr_nr++] = element;
+}
+
+inline void *mempool_t::remove_element(void) noexcept
+{
+    return m_elements[--m_curr_nr];
+}
+
+bool mempool_t::create(uint32_t min_nr, mempool_alloc_t alloc, mempool_free_t free, void *pool_data) noexcept
+{
+    m_min_nr       = min_nr;
+    m_curr_nr      = 0;
+    m_alloc        = alloc;
+    m_free         = free;
+    m_pool_data    = pool_data;
+    m_next_refill  = nullptr;
+    m_is_queued    = false;
+    m_reserve_hits = 0;
+    m_elements     = static_cast<void**>(kmalloc(min_nr * sizeof(void*), GFP::KERNEL));
+
+    if (!m_elements)
+        return false;
+
+    if (!refill()) {
+        destroy();
+        return false;
+    }
+
+    return true;
+}
+
+bool mempool_t::create_slab_pool(uint32_t min_nr, kmem::cache_t *cache) noexcept
+{
+    return create(min_nr, mempool_alloc_slab, mempool_free_slab, cache);
+}
+
+bool mempool_t::create_kmalloc_pool(uint32_t min_nr, size_t size) noexcept
+{
+    auto pool_data = reinterpret_cast<void*>(static_cast<uint32_t>(size));
+    return create(min_nr, mempool_kmalloc, mempool_kfree, pool_data);
+}
+
+bool mempool_t::create_page_pool(uint32_t min_nr, uint32_t order) noexcept
+{
+    return create(min_nr, mempool_alloc_pages, mempool_free_pages, reinterpret_cast<void*>(order));
+}
+
+void mempool_t::destroy(void) noexcept
+{
+    while (m_curr_nr)
+        m_free(remove_element(), m_pool_data);
+
+    kfree(m_elements);
+    m_elements = nullptr;
+    m_min_nr   = 0;
+}
+
+void *mempool_t::alloc(gfp_t flags) noexcept
+{
+    // try the normal path first, but without any slow detour
+    void *element = m_alloc(flags | GFP::KERNEL | GFP::ATOMIC, m_pool_data);
+
+    if (element)
+        return element;
+
+    auto irq_flags = arch::x86::irq_save();
+
+    if (m_curr_nr) {
+        element = remove_element();
+        m_reserve_hits++;
+        queue_refill();
+    }
+
+    arch::x86::irq_restore(irq_flags);
+    return element;
+}
+
+void mempool_t::free(void *element) noexcept
+{
+    if (!element)
+        return;
+
+    auto irq_flags = arch::x86::irq_save();
+
+    if (m_curr_nr < m_min_nr) {
+        add_element(element);
+        arch::x86::irq_restore(irq_flags);
+        return;
+    }
+
+    arch::x86::irq_restore(irq_flags);
+    m_free(element, m_pool_data);
+}
+
+bool mempool_t::refill(void) noexcept
+{
+    while (m_curr_nr < m_min_nr) {
+        void *element = m_alloc(GFP::KERNEL, m_pool_data);
+
+        if (!element)
+            return false;
+
+        auto irq_flags = arch::x86::irq_save();
+
+        // reserve could be refilled by free() in the meantime
+        if (m_curr_nr < m_min_nr) {
+            add_element(element);
+            element = nullptr;
+        }
+
+        arch::x86::irq_restore(irq_flags);
+
+        if (element)
+            m_free(element, m_pool_data);
+    }
+
+    return true;
+}
+
+void mempool_t::queue_refill(void) noexcept
+{
+    if (m_is_queued)
+        return;
+
+    m_is_queued   = true;
+    m_next_refill = refill_queue;
+    refill_queue  = this;
+
+    if (kmempoold)
+        core::wake_up_process(kmempoold);
+}
+
+bool mempool_refill_pending(void) noexcept
+{
+    for (;;) {
+        auto irq_flags = arch::x86::irq_save();
+        mempool_t *pool = refill_queue;
+
+        if (pool) {
+            refill_queue      = pool->m_next_refill;
+            pool->m_is_queued = false;
+        }
+
+        arch::x86::irq_restore(irq_flags);
+
+        if (!pool)
+            return true;
+
+        // keep pool queued until allocator can satisfy it again
+        if (!pool->refill()) {
+            irq_flags = arch::x86::irq_save();
+            pool->queue_refill();
+            arch::x86::irq_restore(irq_flags);
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief Refill pools outside of their allocation paths.
+ *
+ * @param [in] data - given unused data.
+ */
+static void run_kmempoold(void *data) noexcept
+{
+    (void)data;
+
+    for (;;) {
+        arch::x86::irq_disable();
+
+        // queue_refill() wakes thread up
+        if (!refill_queue) {
+            core::set_current_state(core::task_state::SLEEPING);
+            core::schedule();
+        }
+
+        arch::x86::irq_enable();
+
+        core::kernel_lock.lock();
+        bool done = mempool_refill_pending();
+        core::kernel_lock.unlock();
+
+        // retry after other tasks have freed memory
+        if (!done)
+            core::schedule_timeout(core::msecs_to_jiffies(MEMPOOL_RETRY_MS));
+    }
+}
+
+bool mempool_init(void) noexcept
+{
+    kmempoold = core::kthread_run(run_kmempoold, nullptr, "kmempoold");
+    return kmempoold;
+}
+
+} // namespace memory
+} // namespace core
+} // namespace kernel
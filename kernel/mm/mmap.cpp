@@ -0,0 +1,637 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/system.hpp>
+#include <kernel/kstd/cstring.hpp>
+#include <kernel/sched.hpp>
+#include <kernel/mmap.hpp>
+#include <kernel/swap.hpp>
+#include <kernel/slab.hpp>
+#include <kernel/ksm.hpp>
+#include <kernel/tlb.hpp>
+#include <kernel/pmm.hpp>
+
+
+namespace kernel {
+namespace core {
+namespace memory {
+
+mm_t init_mm;
+mm_t *active_mm {&init_mm};
+
+/**
+ * @brief Round size up to the page boundary.
+ *
+ * @param [in] size - given size in bytes.
+ * @return page aligned size.
+ */
+static inline uint64_t page_align(uint64_t size) noexcept
+{
+    return (size + PAGE_SIZE - 1) & ~uint64_t(PAGE_SIZE - 1);
+}
+
+bool vm_file_t::init(size_t npages, readpage_t readpage, void *priv) noexcept
+{
+    m_cache = static_cast<page_t**>(kmalloc(npages * sizeof(page_t*), GFP::KERNEL));
+
+    if (!m_cache)
+        return false;
+
+    kstd::memset(m_cache, 0, npages * sizeof(page_t*));
+    m_npages   = npages;
+    m_readpage = readpage;
+    m_private  = priv;
+
+    return true;
+}
+
+void vm_file_t::destroy(void) noexcept
+{
+    for (size_t i = 0; i < m_npages; i++) {
+        if (m_cache[i])
+            put_page(m_cache[i]);
+    }
+
+    kfree(m_cache);
+    m_cache  = nullptr;
+    m_npages = 0;
+}
+
+page_t *vm_file_t::find_page(size_t pgoff) const noexcept
+{
+    if (pgoff >= m_npages)
+        return nullptr;
+
+    return m_cache[pgoff];
+}
+
+page_t *vm_file_t::read_page(size_t pgoff) noexcept
+{
+    if (pgoff >= m_npages)
+        return nullptr;
+
+    if (m_cache[pgoff])
+        return m_cache[pgoff];
+
+    page_t *page = pmm.alloc_pages(GFP::KERNEL, 0);
+
+    if (!page)
+        return nullptr;
+
+    if (!m_readpage(this, pgoff, page->addr())) {
+        pmm.free_pages(PFN_PHYS(page->m_pfn), 0);
+        return nullptr;
+    }
+
+    m_cache[pgoff] = page;
+    return page;
+}
+
+// areas cache used until scheduler is initialized
+static vmacache_t boot_vmacache;
+
+vmacache_t *current_vmacache(void) noexcept
+{
+    core::task_t *task = core::current();
+    return task ? &task->m_vmacache : &boot_vmacache;
+}
+
+/**
+ * @brief Get free gap between area and the previous one.
+ *
+ * @param [in] vma - given area.
+ * @return gap size in bytes.
+ */
+static inline uint32_t vma_gap(const vm_area_t *vma) noexcept
+{
+    return vma->m_start - (vma->m_prev ? vma->m_prev->m_end : MMAP_START);
+}
+
+/**
+ * @brief Get largest free gap of subtree.
+ *
+ * @param [in] node - given tree node (nullptr - empty subtree).
+ * @return gap size in bytes.
+ */
+static inline uint32_t subtree_gap(const kstd::rb_node_t *node) noexcept
+{
+    return node ? rb_entry(const_cast<kstd::rb_node_t*>(node), vm_area_t, m_rb)->m_subtree_gap : 0;
+}
+
+/**
+ * @brief Recompute largest free gap of area subtree.
+ *
+ * @param [in] node - given area tree node.
+ */
+static void vma_augment(kstd::rb_node_t *node) noexcept
+{
+    vm_area_t *vma = rb_entry(node, vm_area_t, m_rb);
+    uint32_t gap   = vma_gap(vma);
+
+    if (subtree_gap(node->m_left) > gap)
+        gap = subtree_gap(node->m_left);
+
+    if (subtree_gap(node->m_right) > gap)
+        gap = subtree_gap(node->m_right);
+
+    vma->m_subtree_gap = gap;
+}
+
+/**
+ * @brief Check that area can be extended by the new range.
+ *
+ * @param [in] vma - given area.
+ * @param [in] flags - given range VM flags.
+ * @param [in] file - given range backing file.
+ * @param [in] pgoff - given file page offset of the range start.
+ * @param [in] start - given range start.
+ * @return true - in case of area & range are compatible.
+ * @return false - otherwise.
+ */
+static inline bool vma_compatible(const vm_area_t *vma, uint32_t flags, const vm_file_t *file,
+                                  size_t pgoff, uint32_t start) noexcept
+{
+    if (vma->m_flags != flags || vma->m_file != file)
+        return false;
+
+    // file pages must stay contiguous
+    return !file || vma->m_pgoff + (int32_t(start - vma->m_start) >> PAGE_SHIFT) == pgoff;
+}
+
+void mm_t::link_vma(vm_area_t *vma, vm_area_t *prev) noexcept
+{
+    vma->m_prev = prev;
+    vma->m_next = prev ? prev->m_next : m_mmap;
+
+    if (prev)
+        prev->m_next = vma;
+    else
+        m_mmap = vma;
+
+    if (vma->m_next)
+        vma->m_next->m_prev = vma;
+
+    kstd::rb_node_t **link  = &m_mm_rb.m_node;
+    kstd::rb_node_t *parent = nullptr;
+
+    while (*link) {
+        parent = *link;
+
+        if (vma->m_start < rb_entry(parent, vm_area_t, m_rb)->m_start)
+            link = &parent->m_left;
+        else
+            link = &parent->m_right;
+    }
+
+    m_mm_rb.insert(&vma->m_rb, parent, link, vma_augment);
+
+    // gap before the next area became smaller
+    if (vma->m_next)
+        kstd::rb_propagate(&vma->m_next->m_rb, vma_augment);
+
+    m_map_count++;
+}
+
+void mm_t::unlink_vma(vm_area_t *vma) noexcept
+{
+    m_mm_rb.erase(&vma->m_rb, vma_augment);
+
+    if (vma->m_prev)
+        vma->m_prev->m_next = vma->m_next;
+    else
+        m_mmap = vma->m_next;
+
+    if (vma->m_next) {
+        vma->m_next->m_prev = vma->m_prev;
+        kstd::rb_propagate(&vma->m_next->m_rb, vma_augment);
+    }
+
+    m_map_count--;
+    m_vmacache_seqnum++;
+}
+
+void mm_t::adjust_vma(vm_area_t *vma, uint32_t start, uint32_t end) noexcept
+{
+    // start change keeps order, since areas never overlap
+    vma->m_pgoff += int32_t(start - vma->m_start) >> PAGE_SHIFT;
+    vma->m_start  = start;
+    vma->m_end    = end;
+
+    kstd::rb_propagate(&vma->m_rb, vma_augment);
+
+    if (vma->m_next)
+        kstd::rb_propagate(&vma->m_next->m_rb, vma_augment);
+
+    m_vmacache_seqnum++;
+}
+
+vm_area_t *mm_t::find_vma(uint32_t addr) const noexcept
+{
+    vmacache_t *cache = current_vmacache();
+    uint32_t hash     = (addr >> PAGE_SHIFT) & (VMACACHE_SIZE - 1);
+
+    if (cache->m_mm != this || cache->m_seqnum != m_vmacache_seqnum) {
+        kstd::memset(cache->m_vmas, 0, sizeof(cache->m_vmas));
+        cache->m_mm     = this;
+        cache->m_seqnum = m_vmacache_seqnum;
+    }
+
+    for (const auto& vma : cache->m_vmas) {
+        if (vma && vma->m_start <= addr && addr < vma->m_end)
+            return vma;
+    }
+
+    kstd::rb_node_t *node = m_mm_rb.m_node;
+    vm_area_t *ret        = nullptr;
+
+    while (node) {
+        vm_area_t *vma = rb_entry(node, vm_area_t, m_rb);
+
+        if (addr < vma->m_end) {
+            ret = vma;
+
+            if (vma->m_start <= addr)
+                break;
+
+            node = node->m_left;
+        }
+        else
+            node = node->m_right;
+    }
+
+    if (ret)
+        cache->m_vmas[hash] = ret;
+
+    return ret;
+}
+
+uint32_t mm_t::get_unmapped_area(uint32_t size) const noexcept
+{
+    kstd::rb_node_t *node = m_mm_rb.m_node;
+
+    // descend to the lowest gap that fits
+    if (subtree_gap(node) >= size) {
+        while (true) {
+            vm_area_t *vma = rb_entry(node, vm_area_t, m_rb);
+
+            if (subtree_gap(node->m_left) >= size) {
+                node = node->m_left;
+                continue;
+            }
+
+            if (vma_gap(vma) >= size)
+                return vma->m_start - vma_gap(vma);
+
+            node = node->m_right;
+        }
+    }
+
+    // gap after the last area
+    kstd::rb_node_t *last = m_mm_rb.last();
+    uint32_t start        = last ? rb_entry(last, vm_area_t, m_rb)->m_end : MMAP_START;
+
+    return MMAP_END - start >= size ? start : 0;
+}
+
+void *mm_t::mmap(uint32_t addr, size_t len, uint32_t flags, vm_file_t *file, size_t pgoff) noexcept
+{
+    uint64_t size = page_align(len);
+
+    if (!size || (addr & (PAGE_SIZE - 1)) || size > MMAP_END - MMAP_START)
+        return nullptr;
+
+    if (file && pgoff + (size >> PAGE_SHIFT) > file->m_npages)
+        return nullptr;
+
+    if (!file)
+        pgoff = 0;
+
+    if (addr) {
+        if (addr < MMAP_START || addr + size > MMAP_END)
+            return nullptr;
+
+        vm_area_t *vma = find_vma(addr);
+
+        if (vma && vma->m_start < addr + size)
+            return nullptr;
+    }
+    else if (!(addr = get_unmapped_area(size)))
+        return nullptr;
+
+    if ((flags & VM::MERGEABLE) && !ksm_enter(this))
+        return nullptr;
+
+    uint32_t end    = addr + size;
+    vm_area_t *next = find_vma(addr);
+    vm_area_t *prev = next ? next->m_prev : (m_mmap ? rb_entry(m_mm_rb.last(), vm_area_t, m_rb) : nullptr);
+
+    bool merge_prev = prev && prev->m_end == addr && vma_compatible(prev, flags, file, pgoff, addr);
+    bool merge_next = next && next->m_start == end && vma_compatible(next, flags, file, pgoff, addr);
+
+    // extend adjacent compatible areas instead of creating the new one
+    if (merge_prev && merge_next) {
+        uint32_t next_end = next->m_end;
+
+        unlink_vma(next);
+        kfree(next);
+        adjust_vma(prev, prev->m_start, next_end);
+    }
+    else if (merge_prev)
+        adjust_vma(prev, prev->m_start, end);
+    else if (merge_next)
+        adjust_vma(next, addr, next->m_end);
+    else {
+        auto vma = static_cast<vm_area_t*>(kmalloc(sizeof(vm_area_t), GFP::KERNEL));
+
+        if (!vma)
+            return nullptr;
+
+        vma->m_start = addr;
+        vma->m_end   = end;
+        vma->m_flags = flags;
+        vma->m_file  = file;
+        vma->m_pgoff = pgoff;
+
+        link_vma(vma, prev);
+    }
+
+    return reinterpret_cast<void*>(addr);
+}
+
+/**
+ * @brief Drop reference to unmapped page after TLB flush.
+ *
+ * @param [in] addr - given virtual address.
+ * @param [in] pte - given removed page table entry.
+ * @param [in,out] tlb - given gather the entry was added to.
+ */
+static void zap_pte(uint32_t addr, pte_t pte, tlb_gather_t *tlb) noexcept
+{
+    (void)addr;
+
+    if (!(pte & PTE_PRESENT)) {
+        swap_free(pte_to_swp_entry(pte));
+        return;
+    }
+
+    page_t *page = pmm.get_page(pte & PTE_ADDR_MASK);
+
+    // page may outlive the mapping in another address space
+    if (page->m_mm && page->m_mm->m_pgdir == tlb->m_pgdir)
+        page->m_mm = nullptr;
+
+    tlb->release(page);
+}
+
+void mm_t::zap_range(uint32_t start, uint32_t end, tlb_gather_t& tlb) noexcept
+{
+    if (m_pgdir == vmm.m_active) {
+        vmm.unmap_range(start, end - start, zap_pte, &tlb);
+        return;
+    }
+
+    // inactive address space has no TLB entries
+    for (uint32_t addr = start; addr < end; addr += PAGE_SIZE) {
+        pte_t *pte = get_pte(m_pgdir, addr, false);
+
+        if (!pte || !*pte)
+            continue;
+
+        pte_t old = *pte;
+        *pte      = 0;
+        zap_pte(addr, old, &tlb);
+    }
+}
+
+bool mm_t::munmap(uint32_t addr, size_t len) noexcept
+{
+    uint64_t size = page_align(len);
+
+    if (!size || (addr & (PAGE_SIZE - 1)) || addr < MMAP_START || addr + size > MMAP_END)
+        return false;
+
+    uint32_t end   = addr + size;
+    vm_area_t *vma = find_vma(addr);
+    tlb_gather_t tlb;
+    bool unmerge   = false;
+
+    // all areas of the range are flushed at once
+    tlb.init(m_pgdir);
+
+    while (vma && vma->m_start < end) {
+        vm_area_t *next = vma->m_next;
+
+        // split area that contains the whole range
+        if (vma->m_start < addr && vma->m_end > end) {
+            auto tail = static_cast<vm_area_t*>(kmalloc(sizeof(vm_area_t), GFP::KERNEL));
+
+            if (!tail) {
+                tlb.finish();
+                return false;
+            }
+
+            *tail         = *vma;
+            tail->m_start = end;
+            tail->m_pgoff = vma->m_pgoff + ((end - vma->m_start) >> PAGE_SHIFT);
+
+            zap_range(addr, end, tlb);
+            adjust_vma(vma, vma->m_start, addr);
+            link_vma(tail, vma);
+            break;
+        }
+
+        uint32_t zap_start = vma->m_start > addr ? vma->m_start : addr;
+        uint32_t zap_end   = vma->m_end < end ? vma->m_end : end;
+
+        zap_range(zap_start, zap_end, tlb);
+
+        if (zap_start == vma->m_start && zap_end == vma->m_end) {
+            unmerge |= (vma->m_flags & VM::MERGEABLE) != 0;
+            unlink_vma(vma);
+            kfree(vma);
+        }
+        else if (zap_start == vma->m_start)
+            adjust_vma(vma, zap_end, vma->m_end);
+        else
+            adjust_vma(vma, vma->m_start, zap_start);
+
+        vma = next;
+    }
+
+    tlb.finish();
+
+    // scanner stops visiting address space without mergeable areas
+    if (unmerge && m_ksm) {
+        vma = m_mmap;
+
+        while (vma && !(vma->m_flags & VM::MERGEABLE))
+            vma = vma->m_next;
+
+        if (!vma)
+            ksm_exit(this);
+    }
+
+    return true;
+}
+
+bool mm_t::init(void) noexcept
+{
+    page_t *page = pmm.get_zeroed_page(GFP::KERNEL | GFP::ZERO);
+
+    if (!page)
+        return false;
+
+    m_pgdir           = static_cast<pde_t*>(page->addr());
+    m_mm_rb.m_node    = nullptr;
+    m_mmap            = nullptr;
+    m_map_count       = 0;
+    m_vmacache_seqnum = 0;
+    m_ksm             = nullptr;
+    kstd::memset(&m_stats, 0, sizeof(m_stats));
+
+    // kernel half is shared by all address spaces
+    for (uint32_t i = PAGE_OFFSET >> PGDIR_SHIFT; i < RECURSIVE_PDE; i++)
+        m_pgdir[i] = init_mm.m_pgdir[i];
+
+    m_pgdir[RECURSIVE_PDE] = virt_to_phys(m_pgdir) | PTE_PRESENT | PTE_WRITE;
+
+    return true;
+}
+
+void mm_t::destroy(void) noexcept
+{
+    tlb_gather_t tlb;
+    tlb.init(m_pgdir);
+
+    // merged frames are released by scanner items
+    ksm_exit(this);
+
+    while (m_mmap) {
+        vm_area_t *next = m_mmap->m_next;
+
+        zap_range(m_mmap->m_start, m_mmap->m_end, tlb);
+        kfree(m_mmap);
+        m_mmap = next;
+    }
+
+    tlb.finish();
+    m_mm_rb.m_node = nullptr;
+    m_map_count    = 0;
+
+    // address space memory can be reused by another one
+    if (boot_vmacache.m_mm == this)
+        boot_vmacache.m_mm = nullptr;
+
+    auto flags = arch::x86::irq_save();
+
+    for (core::task_t *task = core::task_list; task; task = task->m_next) {
+        if (task->m_vmacache.m_mm == this)
+            task->m_vmacache.m_mm = nullptr;
+    }
+
+    arch::x86::irq_restore(flags);
+
+    for (uint32_t i = 0; i < PAGE_OFFSET >> PGDIR_SHIFT; i++) {
+        if ((m_pgdir[i] & PTE_PRESENT) && !(m_pgdir[i] & PTE_LARGE))
+            pmm.free_pages(m_pgdir[i] & PTE_ADDR_MASK, 0);
+    }
+
+    pmm.free_pages(virt_to_phys(m_pgdir), 0);
+    m_pgdir = nullptr;
+}
+
+bool mm_t::dup(mm_t *child) noexcept
+{
+    if (!child->init())
+        return false;
+
+    if (m_ksm && !ksm_enter(child)) {
+        child->destroy();
+        return false;
+    }
+
+    vm_area_t *tail = nullptr;
+    tlb_gather_t tlb;
+
+    // write-protected entries of parent are flushed at once
+    tlb.init(m_pgdir);
+
+    for (vm_area_t *vma = m_mmap; vma; vma = vma->m_next) {
+        auto copy = static_cast<vm_area_t*>(kmalloc(sizeof(vm_area_t), GFP::KERNEL));
+
+        if (!copy) {
+            tlb.finish();
+            child->destroy();
+            return false;
+        }
+
+        *copy = *vma;
+        child->link_vma(copy, tail);
+        tail = copy;
+
+        bool cow = !(vma->m_flags & VM::SHARED);
+
+        // only populated page tables are copied
+        for (uint32_t addr = vma->m_start; addr < vma->m_end; addr += PAGE_SIZE) {
+            if (!(m_pgdir[addr >> PGDIR_SHIFT] & PTE_PRESENT)) {
+                addr = (addr | (LARGE_PAGE_SIZE - 1)) - PAGE_SIZE + 1;
+                continue;
+            }
+
+            pte_t *src = get_pte(m_pgdir, addr, false);
+
+            if (!src || !*src)
+                continue;
+
+            pte_t *dst = get_pte(child->m_pgdir, addr, true);
+
+            // swapped out page is shared through its slot
+            if (!dst || (!(*src & PTE_PRESENT) && !swap_duplicate(pte_to_swp_entry(*src)))) {
+                tlb.finish();
+                child->destroy();
+                return false;
+            }
+
+            if (!(*src & PTE_PRESENT)) {
+                *dst = *src;
+                continue;
+            }
+
+            if (cow && (*src & PTE_WRITE)) {
+                tlb.add(addr, *src);
+                *src &= ~PTE_WRITE;
+            }
+
+            *dst = *src;
+            get_page(pmm.get_page(*src & PTE_ADDR_MASK));
+        }
+    }
+
+    tlb.finish();
+    return true;
+}
+
+void switch_mm(mm_t *mm) noexcept
+{
+    active_mm = mm;
+    vmm.load(mm->m_pgdir);
+}
+
+} // namespace memory
+} // namespace core
+} // namespace kernel
@@ -20,6 +20,7 @@
 #include <kernel/memlayout.hpp>
 #include <kernel/panic.hpp>
 #include <kernel/pmm.hpp>
+#include <kernel/vmm.hpp>
 
 
 namespace kernel {
@@ -32,7 +33,7 @@ void phys_mman_t::detect_memory(void) noexcept
     size_t i = 0;
 
     while (i < m_mboot->mmap_length) {
-        mmmt = reinterpret_cast<multiboot_entry_t*>(m_mboot->mmap_addr + i);
+        mmmt = static_cast<multiboot_entry_t*>(phys_to_virt(m_mboot->mmap_addr + i));
 
         if (mmmt->type == MULTIBOOT_MEMORY_AVAILABLE)
             m_mem_available += mmmt->len;
@@ -48,12 +49,19 @@ void phys_mman_t::free_available_memory(void) noexcept
     size_t i = 0;
 
     while (i < m_mboot->mmap_length) {
-        mmmt = reinterpret_cast<multiboot_entry_t*>(m_mboot->mmap_addr + i);
+        mmmt = static_cast<multiboot_entry_t*>(phys_to_virt(m_mboot->mmap_addr + i));
+        i   += sizeof(multiboot_entry_t);
 
-        if (mmmt->type == MULTIBOOT_MEMORY_AVAILABLE)
-            mark_as_free(mmmt->addr, mmmt->len);
+        if (mmmt->type != MULTIBOOT_MEMORY_AVAILABLE || mmmt->addr >= vmm.m_lowmem_end)
+            continue;
 
-        i += sizeof(multiboot_entry_t);
+        // only direct-mapped memory can be allocated
+        auto end = mmmt->addr + mmmt->len;
+
+        if (end > vmm.m_lowmem_end)
+            end = vmm.m_lowmem_end;
+
+        mark_as_free(mmmt->addr, end - mmmt->addr);
     }
 }
 
@@ -64,6 +72,7 @@ void phys_mman_t::init(const multiboot_t& mboot) noexcept
         panic("%s\n", "multiboot memory map wasn't set correctly");
 
     m_mboot = &mboot;
+    m_lock.init();
     detect_memory();
     m_max_pages = m_mem_total >> PAGE_SHIFT;
 
@@ -83,7 +92,7 @@ void phys_mman_t::init(const multiboot_t& mboot) noexcept
     kstd::memset(m_mem_map, 0, m_mem_map_size);
 
     // setting page frame numbers
-    for (size_t i = 0; i < m_mem_map_size; i++) {
+    for (size_t i = 0; i < m_max_pages; i++) {
         m_mem_map[i].m_cache = nullptr;
         m_mem_map[i].m_slab  = nullptr;
         m_mem_map[i].m_flags = 0;
@@ -100,10 +109,10 @@ void phys_mman_t::init(const multiboot_t& mboot) noexcept
     mark_as_used(phys_addr_t(KERNEL_START_PADDR), KERNEL_SIZE + PAGE_SIZE);
 
     // mark bitmap memory as used
-    mark_as_used(phys_addr_t(m_bitmap.m_data), m_bitmap.m_size);
+    mark_as_used(virt_to_phys(m_bitmap.m_data), m_bitmap.m_size);
 
     // mark pages memory map as used
-    mark_as_used(phys_addr_t(m_mem_map), m_mem_map_size);
+    mark_as_used(virt_to_phys(m_mem_map), m_mem_map_size);
 
     // first page containing reserved data (e.g. GDT), that should not
     // be accessed, so it was set as used:
@@ -167,7 +176,7 @@ size_t phys_mman_t::get_free_pages(gfp_t mask, uint32_t order) noexcept
                     }
 
                     // if used page was found check next group of pages
-                    if (k < n - 1)
+                    if (k < n)
                         continue;
                     else
                         return pos;
@@ -183,19 +192,26 @@ page_t *phys_mman_t::alloc_pages(gfp_t mask, uint32_t order) noexcept
 {
     uint32_t n = 1 << order; // allocate 2^order pages
 
+    size_t start_pos = 0;
+    auto flags       = m_lock.lock_irqsave();
+
     // not enough of free blocks
-    if((m_max_pages - m_used_pages) <= n)
-        return nullptr;
+    if ((m_max_pages - m_used_pages) > n)
+        start_pos = get_free_pages(mask, order);
 
-    size_t start_pos = get_free_pages(mask, order);
+    // swap out anonymous pages and retry once
+    if (!start_pos && !(mask & GFP::ATOMIC)) {
+        m_lock.unlock_irqrestore(flags);
+        bool shrunk = shrink_memory(n);
+        flags       = m_lock.lock_irqsave();
 
-    if (!start_pos)
-        return nullptr;
+        if (shrunk && (m_max_pages - m_used_pages) > n)
+            start_pos = get_free_pages(mask, order);
+    }
 
-    // set page to zero
-    if (mask & GFP::ZERO) {
-        auto addr = reinterpret_cast<void*>(PFN_PHYS(start_pos));
-        kstd::memset(addr, 0, n << PAGE_SHIFT);
+    if (!start_pos) {
+        m_lock.unlock_irqrestore(flags);
+        return nullptr;
     }
 
     // set n pages as used
@@ -203,6 +219,13 @@ page_t *phys_mman_t::alloc_pages(gfp_t mask, uint32_t order) noexcept
         m_bitmap.set(start_pos + i);
 
     m_used_pages += n;
+    m_mem_map[start_pos].m_count = 1;
+    m_lock.unlock_irqrestore(flags);
+
+    // set page to zero
+    if (mask & GFP::ZERO) {
+        kstd::memset(m_mem_map[start_pos].addr(), 0, n << PAGE_SHIFT);
+    }
 
     return &m_mem_map[start_pos];
 }
@@ -219,19 +242,62 @@ page_t *phys_mman_t::get_zeroed_page(gfp_t mask) noexcept
 
 void phys_mman_t::free_pages(phys_addr_t addr, uint32_t order) noexcept
 {
-    size_t pos = PFN_PHYS(addr);
+    size_t pos = PHYS_PFN(addr);
 
     // handle freeing first page
     if (!pos)
         panic("%s\n", "it is forbidden to free the first page");
 
     uint32_t n = 1 << order; // free 2^order pages
+    auto flags = m_lock.lock_irqsave();
 
     // set n pages as free
     for (size_t i = 0; i < n; i++)
         m_bitmap.unset(pos + i);
 
     m_used_pages -= n;
+    m_mem_map[pos].m_count = 0;
+    m_lock.unlock_irqrestore(flags);
+}
+
+bool phys_mman_t::grow_pages(phys_addr_t addr, uint32_t order, uint32_t new_order) noexcept
+{
+    size_t start = PHYS_PFN(addr) + (1 << order);
+    size_t end   = PHYS_PFN(addr) + (1 << new_order);
+
+    if (end > m_max_pages)
+        return false;
+
+    auto flags = m_lock.lock_irqsave();
+
+    // check that adjacent pages are free
+    for (size_t pos = start; pos < end; pos++) {
+        if (m_bitmap.get(pos) != PAGE_FREE) {
+            m_lock.unlock_irqrestore(flags);
+            return false;
+        }
+    }
+
+    for (size_t pos = start; pos < end; pos++)
+        m_bitmap.set(pos);
+
+    m_used_pages += end - start;
+    m_lock.unlock_irqrestore(flags);
+
+    return true;
+}
+
+void phys_mman_t::shrink_pages(phys_addr_t addr, uint32_t order, uint32_t new_order) noexcept
+{
+    size_t start = PHYS_PFN(addr) + (1 << new_order);
+    size_t end   = PHYS_PFN(addr) + (1 << order);
+    auto flags   = m_lock.lock_irqsave();
+
+    for (size_t pos = start; pos < end; pos++)
+        m_bitmap.unset(pos);
+
+    m_used_pages -= end - start;
+    m_lock.unlock_irqrestore(flags);
 }
 
 page_t *phys_mman_t::get_page(phys_addr_t addr) const noexcept
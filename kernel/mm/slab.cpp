@@ -18,8 +18,10 @@
 
 #include <kernel/kstd/cstring.hpp>
 #include <kernel/kstd/cmath.hpp>
+#include <kernel/arch/x86/tsc.hpp>
 #include <kernel/mm_types.hpp>
 #include <kernel/kernel.hpp>
+#include <kernel/printk.hpp>
 #include <kernel/panic.hpp>
 #include <kernel/slab.hpp>
 #include <kernel/pmm.hpp>
@@ -37,6 +39,23 @@ static cache_t     caches[CACHES_SIZE]; // array of predefined caches
 inline size_t      slab_pos = 0;        // current free slab position
 inline slab_list_t slabs;               // allocated slabs list
 
+#ifdef CONFIG_SLAB_LATENCY
+/**
+ * @brief Account operation latency in histogram.
+ *
+ * @param [out] hist - given latency histogram.
+ * @param [in] cycles - given operation latency in CPU cycles.
+ */
+static inline void account_latency(uint32_t *hist, uint64_t cycles) noexcept
+{
+    auto bucket = ilog2(cycles);
+
+    if (bucket >= LATENCY_BUCKETS)
+        bucket = LATENCY_BUCKETS - 1;
+
+    hist[bucket]++;
+}
+#endif // CONFIG_SLAB_LATENCY
 
 void init(void) noexcept
 {
@@ -67,6 +86,7 @@ void init(void) noexcept
         slabs.m_head[i].m_next    = nullptr;
         slabs.m_head[i].m_prev    = nullptr;
         slabs.m_head[i].m_is_free = true;
+        slabs.m_head[i].m_frozen  = false;
         slabs.m_head[i].m_inuse   = 0;
     }
 
@@ -81,157 +101,457 @@ void init(void) noexcept
     caches[0].create("kmalloc-8", 8, 0);
 }
 
+/**
+ * @brief Get next free object.
+ *
+ * @param [in] objp - given free object.
+ * @return next free object pointer.
+ */
+static inline void *get_freepointer(void *objp) noexcept
+{
+    return *static_cast<void**>(objp);
+}
+
+/**
+ * @brief Set next free object.
+ *
+ * @param [out] objp - given free object.
+ * @param [in] next - given next free object.
+ */
+static inline void set_freepointer(void *objp, void *next) noexcept
+{
+    *static_cast<void**>(objp) = next;
+}
+
+/**
+ * @brief Append slab to the list.
+ *
+ * @param [out] list - given slab list.
+ * @param [in] slab - given slab to append.
+ */
+static void list_add(slab_list_t& list, slab_t *slab) noexcept
+{
+    slab->m_next = nullptr;
+    slab->m_prev = list.m_tail;
+
+    if (list.m_tail)
+        list.m_tail->m_next = slab;
+    else
+        list.m_head = slab;
+
+    list.m_tail = slab;
+    list.m_size++;
+}
+
+/**
+ * @brief Remove slab from the list.
+ *
+ * @param [out] list - given slab list.
+ * @param [in] slab - given slab to remove.
+ */
+static void list_del(slab_list_t& list, slab_t *slab) noexcept
+{
+    if (slab->m_prev)
+        slab->m_prev->m_next = slab->m_next;
+    else
+        list.m_head = slab->m_next;
+
+    if (slab->m_next)
+        slab->m_next->m_prev = slab->m_prev;
+    else
+        list.m_tail = slab->m_prev;
+
+    slab->m_next = nullptr;
+    slab->m_prev = nullptr;
+    list.m_size--;
+}
+
+/**
+ * @brief Build a fresh slab with all objects free.
+ *
+ * @param [out] slab - given slab to build.
+ * @param [in] objsize - given object size.
+ * @param [in] objnum - given number of objects.
+ */
+static void init_freelist(slab_t *slab, uint32_t objsize, uint32_t objnum) noexcept
+{
+    auto objp = static_cast<uint8_t*>(slab->m_s_mem);
+
+    for (uint32_t i = 0; i < objnum - 1; i++)
+        set_freepointer(objp + i * objsize, objp + (i + 1) * objsize);
+
+    set_freepointer(objp + (objnum - 1) * objsize, nullptr);
+
+    slab->m_free  = slab->m_s_mem;
+    slab->m_inuse = 0;
+}
+
 void cache_t::create(const char *name, size_t size, uint32_t flags) noexcept
 {
     // initializing cache structure
-    m_list          = {nullptr, nullptr, 0};
+    m_partial       = {nullptr, nullptr, 0};
+    m_full          = {nullptr, nullptr, 0};
     m_freelist      = {nullptr, nullptr, 0};
     m_objsize       = roundup_pow_of_two(size);
     m_gfporder      = kstd::ceil(kstd::log2(m_objsize));
     m_objnum        = PAGE_SIZE >> m_gfporder;
     m_flags         = flags;
     kstd::strncpy(m_name, name, CACHE_NAMELEN);
+    kstd::memset(&m_stats, 0, sizeof(m_stats));
+    kstd::memset(&m_cpu_slab, 0, sizeof(m_cpu_slab));
+    m_lock.init();
 }
 
 void *cache_t::alloc(uint8_t flags) noexcept
 {
     (void)flags;    // TODO: handle SLAB_KERNEL
 
-    if (m_list.m_size == 0)
-        alloc_slab();
+#ifdef CONFIG_SLAB_LATENCY
+    auto start = arch::x86::rdtsc();
+#endif // CONFIG_SLAB_LATENCY
 
-    slab_t *slab = m_list.m_next_free;
-    void *ptr    = slab->m_free;
+    auto& cpu_slab = m_cpu_slab.this_cpu();
+    void *objp;
+    uint32_t tid;
 
-    // handle case if all objects in the last slab are used
-    if (slab->m_inuse == m_objnum) {
-        alloc_slab();
-        slab = m_list.m_next_free;
-        ptr  = slab->m_free;
-    }
+    // lock-free fast path: pop object from CPU freelist
+    do {
+        tid  = cpu_slab.m_tid;
+        arch::x86::barrier();
+        objp = cpu_slab.m_freelist;
+
+        if (!objp) {
+            objp = alloc_slow(cpu_slab);
+            break;
+        }
+
+        // next pointer may be stale if an interrupt reused the object,
+        // but then tid has changed as well and cmpxchg8b fails
+        cpu_slab_t update;
+        update.m_freelist = get_freepointer(objp);
+        update.m_tid      = tid + 1;
+
+        cpu_slab_t expected;
+        expected.m_freelist = objp;
+        expected.m_tid      = tid;
+
+        if (arch::x86::cmpxchg8b(&cpu_slab.m_pair, expected.m_pair, update.m_pair))
+            break;
+    } while (true);
+
+    if (!objp)
+        return nullptr;
+
+    auto& stats = m_stats.this_cpu();
+    stats.m_allocs++;
 
-    // update slab info
-    slab->m_inuse++;
-    slab->m_free = reinterpret_cast<uint8_t*>(slab->m_free) + m_objsize;
+#ifdef CONFIG_SLAB_LATENCY
+    account_latency(stats.m_alloc_lat, arch::x86::rdtsc() - start);
+#endif // CONFIG_SLAB_LATENCY
 
-    return ptr;
+    return objp;
 }
 
-void cache_t::alloc_slab(void) noexcept
+void *cache_t::alloc_slow(cpu_slab_t& cpu_slab) noexcept
 {
-    bool is_allocated = false;
-    slab_t *slab;
+    auto flags = m_lock.lock_irqsave();
+    void *objp = nullptr;
+
+    m_stats.this_cpu().m_alloc_slowpath++;
+
+    // an interrupt could have refilled CPU freelist in the meantime
+    if (cpu_slab.m_freelist) {
+        objp                = cpu_slab.m_freelist;
+        cpu_slab.m_freelist = get_freepointer(objp);
+        cpu_slab.m_tid++;
+        m_lock.unlock_irqrestore(flags);
+        return objp;
+    }
 
-    // first looking into the freelist for free slabs
-    if (m_freelist.m_head) {
-        m_list.m_next_free->m_next             = m_freelist.m_next_free;
-        m_freelist.m_next_free->m_next         = nullptr;
-        m_freelist.m_next_free->m_prev->m_next = nullptr;
+    slab_t *slab = cpu_slab.m_slab;
+
+    // take objects freed to the active slab by other CPUs
+    if (slab && slab->m_free) {
+        objp          = slab->m_free;
+        slab->m_free  = nullptr;
+        slab->m_inuse = m_objnum;
+    }
+    else {
+        if (slab)
+            deactivate_slab(cpu_slab);
 
-        if (m_freelist.m_size)
-            m_freelist.m_next_free = m_freelist.m_next_free->m_prev;
+        // prefer partial slabs to keep memory compact
+        slab = m_partial.m_head;
 
-        m_list.m_next_free->m_next->m_prev = m_list.m_next_free;
-        m_list.m_next_free = m_list.m_next_free->m_next;
+        if (slab)
+            list_del(m_partial, slab);
+        else
+            slab = alloc_slab();
 
-        m_list.m_size++;
-        m_freelist.m_size--;
-        is_allocated = true;
+        if (!slab) {
+            m_lock.unlock_irqrestore(flags);
+            return nullptr;
+        }
+
+        // freeze slab: CPU owns all its free objects
+        objp            = slab->m_free;
+        slab->m_free    = nullptr;
+        slab->m_inuse   = m_objnum;
+        slab->m_frozen  = true;
+        cpu_slab.m_slab = slab;
+    }
+
+    cpu_slab.m_freelist = get_freepointer(objp);
+    cpu_slab.m_tid++;
+
+    m_lock.unlock_irqrestore(flags);
+    return objp;
+}
+
+slab_t *cache_t::alloc_slab(void) noexcept
+{
+    slab_t *slab = m_freelist.m_head;
+
+    // first looking into the freelist for free slabs
+    if (slab) {
+        list_del(m_freelist, slab);
+        m_stats.this_cpu().m_freelist_hits++;
     }
     else {
         // if there is no free slabs in freelist - then search them
-        // in the external slabs array (m_slabs)
-        while (slab_pos < slabs.m_size) {
-            slab = &slabs.m_head[slab_pos];
-
-            if (slab->m_is_free) {
-                slab->m_is_free = false;
-
-                if (m_list.m_head) {
-                    slab->m_prev               = m_list.m_next_free;
-                    slab->m_next               = nullptr;
-                    m_list.m_next_free->m_next = slab;
-                    m_list.m_next_free         = slab;
-                }
-                else {
-                    m_list.m_head      = slab;
-                    m_list.m_next_free = slab;
-                }
-
-                page_t *page  = pmm.get_page(phys_addr_t(slab->m_s_mem));
-                page->m_cache = this;
-                page->m_slab  = slab;
-
-                m_list.m_size++;
-                is_allocated = true;
-                break;
-            }
-
+        // in the external slabs array
+        while (slab_pos < slabs.m_size && !slabs.m_head[slab_pos].m_is_free)
             slab_pos++;
-        }
+
+        if (slab_pos == slabs.m_size)
+            return nullptr;
+
+        slab = &slabs.m_head[slab_pos];
+        slab->m_is_free = false;
+
+        page_t *page  = virt_to_page(slab->m_s_mem);
+        page->m_cache = this;
+        page->m_slab  = slab;
     }
 
-    if (!is_allocated)
-        panic("%s\n", "error to allocate new slab for cache");
+    init_freelist(slab, m_objsize, m_objnum);
+    m_stats.this_cpu().m_grows++;
+
+    return slab;
 }
 
-void cache_t::free_slab(slab_t *slab) noexcept
+void cache_t::deactivate_slab(cpu_slab_t& cpu_slab) noexcept
 {
-    slab->m_free = reinterpret_cast<uint8_t*>(slab->m_free) - m_objsize;
+    slab_t *slab = cpu_slab.m_slab;
+    void *objp   = cpu_slab.m_freelist;
 
-    if (slab->m_inuse > 0)
+    // give objects left in CPU freelist back to the slab
+    while (objp) {
+        void *next = get_freepointer(objp);
+
+        set_freepointer(objp, slab->m_free);
+        slab->m_free = objp;
         slab->m_inuse--;
+        objp = next;
+    }
 
-    // handle slab with all objects free
-    if (slab->m_inuse == 0 && m_list.m_next_free != slab) {
-        kstd::memset(slab->m_s_mem, 0, m_objnum << m_gfporder);
+    slab->m_frozen      = false;
+    cpu_slab.m_slab     = nullptr;
+    cpu_slab.m_freelist = nullptr;
+    cpu_slab.m_tid++;
 
-        if (slab->m_prev)
-            slab->m_prev->m_next = slab->m_next;
+    if (slab->m_inuse == 0) {
+        list_add(m_freelist, slab);
+        m_stats.this_cpu().m_shrinks++;
+    }
+    else if (slab->m_inuse == m_objnum)
+        list_add(m_full, slab);
+    else
+        list_add(m_partial, slab);
+}
 
-        slab->m_next->m_prev = slab->m_prev;
+void cache_t::free(void *objp) noexcept
+{
+#ifdef CONFIG_SLAB_LATENCY
+    auto start = arch::x86::rdtsc();
+#endif // CONFIG_SLAB_LATENCY
+
+    slab_t *slab   = virt_to_page(objp)->m_slab;
+    auto& cpu_slab = m_cpu_slab.this_cpu();
+    uint32_t tid;
+
+    // lock-free fast path: push object to CPU freelist
+    do {
+        tid = cpu_slab.m_tid;
+        arch::x86::barrier();
+
+        if (cpu_slab.m_slab != slab) {
+            free_slow(slab, objp);
+            break;
+        }
+
+        void *head = cpu_slab.m_freelist;
+        set_freepointer(objp, head);
+
+        cpu_slab_t update;
+        update.m_freelist = objp;
+        update.m_tid      = tid + 1;
+
+        cpu_slab_t expected;
+        expected.m_freelist = head;
+        expected.m_tid      = tid;
+
+        if (arch::x86::cmpxchg8b(&cpu_slab.m_pair, expected.m_pair, update.m_pair))
+            break;
+    } while (true);
+
+    auto& stats = m_stats.this_cpu();
+    stats.m_frees++;
+
+#ifdef CONFIG_SLAB_LATENCY
+    account_latency(stats.m_free_lat, arch::x86::rdtsc() - start);
+#endif // CONFIG_SLAB_LATENCY
+}
+
+void cache_t::free_slow(slab_t *slab, void *objp) noexcept
+{
+    auto flags = m_lock.lock_irqsave();
+
+    m_stats.this_cpu().m_free_slowpath++;
 
-        // append free slab into freelist
-        if (m_freelist.m_head) {
-            slab->m_prev                   = m_freelist.m_next_free;
-            slab->m_next                   = nullptr;
-            m_freelist.m_next_free->m_next = slab;
-            m_freelist.m_next_free         = slab;
+    set_freepointer(objp, slab->m_free);
+    slab->m_free = objp;
+    slab->m_inuse--;
+
+    // slab frozen by another CPU is returned to the lists by its owner
+    if (!slab->m_frozen) {
+        if (slab->m_inuse == m_objnum - 1) {
+            list_del(m_full, slab);
+            list_add(m_partial, slab);
         }
-        else {
-            slab->m_prev           = nullptr;
-            slab->m_next           = nullptr;
-            m_freelist.m_head      = slab;
-            m_freelist.m_next_free = slab;
+
+        if (slab->m_inuse == 0) {
+            list_del(m_partial, slab);
+            list_add(m_freelist, slab);
+            m_stats.this_cpu().m_shrinks++;
         }
-        m_freelist.m_size++;
-        m_list.m_size--;
     }
+
+    m_lock.unlock_irqrestore(flags);
 }
 
-void cache_t::free(void *objp) noexcept
+void cache_t::stats(cache_stats_t& stats) const noexcept
 {
-    auto page_number = PHYS_PFN(phys_addr_t(objp));
-    auto page_addr   = PFN_PHYS(page_number);
-    bool is_free     = false;
-
-    // traverse through the list to find a suitable slab
-    // traversing from the end of the list because it is more likely that
-    // slab object to be freed is one of the closest allocated ones
-    slab_t *slab = m_list.m_next_free;
-
-    for (size_t i = m_list.m_size; i > 0; i--) {
-        if (phys_addr_t(slab->m_s_mem) == page_addr) {
-            free_slab(slab);
-            is_free = true;
-            break;
+    kstd::memset(&stats, 0, sizeof(stats));
+
+    for (uint32_t cpu = 0; cpu < NR_CPUS; cpu++) {
+        const auto& cpu_stats = m_stats[cpu];
+
+        stats.m_allocs         += cpu_stats.m_allocs;
+        stats.m_frees          += cpu_stats.m_frees;
+        stats.m_grows          += cpu_stats.m_grows;
+        stats.m_shrinks        += cpu_stats.m_shrinks;
+        stats.m_freelist_hits  += cpu_stats.m_freelist_hits;
+        stats.m_alloc_slowpath += cpu_stats.m_alloc_slowpath;
+        stats.m_free_slowpath  += cpu_stats.m_free_slowpath;
+
+#ifdef CONFIG_SLAB_LATENCY
+        for (uint32_t i = 0; i < LATENCY_BUCKETS; i++) {
+            stats.m_alloc_lat[i] += cpu_stats.m_alloc_lat[i];
+            stats.m_free_lat[i]  += cpu_stats.m_free_lat[i];
         }
+#endif // CONFIG_SLAB_LATENCY
+    }
+}
 
-        slab = slab->m_prev;
+#ifdef CONFIG_SLAB_LATENCY
+/**
+ * @brief Display latency histogram.
+ *
+ * @param [in] name - given histogram name.
+ * @param [in] hist - given latency histogram.
+ */
+static void print_latency(const char *name, const uint32_t *hist) noexcept
+{
+    printk("  %s cycles:", name);
+
+    for (uint32_t i = 0; i < LATENCY_BUCKETS; i++) {
+        if (hist[i])
+            printk(" <%u:%u", 1 << (i + 1), hist[i]);
     }
 
-    if (!is_free)
-        panic("%s\n", "error to free slab object");
+    kstd::putchar('\n');
+}
+#endif // CONFIG_SLAB_LATENCY
+
+/**
+ * @brief Count active objects in the slab list.
+ *
+ * @param [in] list - given slab list.
+ * @return number of active objects.
+ */
+static uint32_t count_inuse(const slab_list_t& list) noexcept
+{
+    uint32_t inuse = 0;
+
+    for (const slab_t *slab = list.m_head; slab; slab = slab->m_next)
+        inuse += slab->m_inuse;
+
+    return inuse;
+}
+
+void slabinfo(void) noexcept
+{
+    cache_stats_t stats;
+
+    for (auto& cache : caches) {
+        auto flags      = cache.m_lock.lock_irqsave();
+        uint32_t active = count_inuse(cache.m_partial) + count_inuse(cache.m_full);
+        uint32_t cpu    = 0;
+
+        // frozen slabs count objects left in CPU freelists as used
+        for (uint32_t i = 0; i < NR_CPUS; i++) {
+            const auto& cpu_slab = cache.m_cpu_slab[i];
+
+            if (!cpu_slab.m_slab)
+                continue;
+
+            active += cpu_slab.m_slab->m_inuse;
+
+            for (void *objp = cpu_slab.m_freelist; objp; objp = get_freepointer(objp))
+                active--;
+
+            cpu++;
+        }
+
+        auto full    = static_cast<uint32_t>(cache.m_full.m_size);
+        auto partial = static_cast<uint32_t>(cache.m_partial.m_size);
+        auto free    = static_cast<uint32_t>(cache.m_freelist.m_size);
+
+        cache.m_lock.unlock_irqrestore(flags);
+        cache.stats(stats);
+
+        auto total = (full + partial + free + cpu) * cache.m_objnum;
+
+        printk("%s: %u/%u objects of %u bytes (%u per slab)\n",
+            cache.m_name, active, total, cache.m_objsize, cache.m_objnum
+        );
+        printk("  slabs:  %u full, %u partial, %u cpu, %u free\n",
+            full, partial, cpu, free
+        );
+        printk("  ops:    %u allocs, %u frees, %u grows, %u shrinks, %u/%u freelist hits\n",
+            stats.m_allocs, stats.m_frees, stats.m_grows, stats.m_shrinks,
+            stats.m_freelist_hits, stats.m_grows
+        );
+        printk("  locked: %u allocs, %u frees\n",
+            stats.m_alloc_slowpath, stats.m_free_slowpath
+        );
+
+#ifdef CONFIG_SLAB_LATENCY
+        print_latency("alloc", stats.m_alloc_lat);
+        print_latency("free ", stats.m_free_lat);
+#endif // CONFIG_SLAB_LATENCY
+    }
 }
 
 } // namespace kmem
@@ -254,18 +574,37 @@ constexpr inline int32_t get_cache_index(size_t size) noexcept
     return index;
 }
 
-void *kmalloc(size_t size, gfp_t flags) noexcept
+/**
+ * @brief Allocate page-backed memory for large sizes.
+ *
+ * @param [in] size - given size of memory block to allocate.
+ * @param [in] flags - given allocation flags.
+ * @return pointer to the allocated memory in case of success.
+ * @return nullptr in case of failure.
+ */
+static void *kmalloc_large(size_t size, gfp_t flags) noexcept
 {
-    // handle incorrect size
-    if (size > 2_KB) {
-        panic(PANIC_ERR "kmalloc: %s\n", "large size for allocation");
+    auto order   = get_order(size);
+    page_t *page = pmm.alloc_pages(flags, order);
+
+    if (!page)
         return nullptr;
-    }
 
+    page->m_flags |= PG::LARGE;
+    page->m_order  = order;
+
+    return page->addr();
+}
+
+void *kmalloc(size_t size, gfp_t flags) noexcept
+{
     // TODO: edit after switching to user space
     if (!(flags & GFP::KERNEL))
         return nullptr;
 
+    if (size > kmem::KMALLOC_MAX_CACHE)
+        return kmalloc_large(size, flags);
+
     auto index = get_cache_index(size);
 
     // handle incorrect index
@@ -283,8 +622,73 @@ void kfree(const void *objp) noexcept
     if (!objp)
         return;
 
-    page_t *page = pmm.get_page(phys_addr_t(objp));
-    page->m_cache->free_slab(page->m_slab);
+    page_t *page = virt_to_page(objp);
+
+    if (page->m_flags & PG::LARGE) {
+        page->m_flags &= ~PG::LARGE;
+        pmm.free_pages(virt_to_phys(objp), page->m_order);
+        return;
+    }
+
+    if (!(page->m_flags & PG::SLAB) || !page->m_cache) {
+        panic(PANIC_ERR "kfree: %s <%p>\n", "invalid pointer", objp);
+        return;
+    }
+
+    page->m_cache->free(const_cast<void*>(objp));
+}
+
+void *krealloc(const void *objp, size_t new_size, gfp_t flags) noexcept
+{
+    if (!objp)
+        return kmalloc(new_size, flags);
+
+    if (!new_size) {
+        kfree(objp);
+        return nullptr;
+    }
+
+    page_t *page    = virt_to_page(objp);
+    size_t old_size = ksize(objp);
+    void *ptr       = const_cast<void*>(objp);
+
+    if (page->m_flags & PG::LARGE) {
+        // keep page-backed memory even if it would fit a slab cache,
+        // unless it can release at least one page
+        if (new_size > kmem::KMALLOC_MAX_CACHE || page->m_order == 0) {
+            auto order = get_order(new_size);
+
+            if (order < page->m_order) {
+                pmm.shrink_pages(virt_to_phys(objp), page->m_order, order);
+                page->m_order = order;
+                return ptr;
+            }
+
+            if (order == page->m_order)
+                return ptr;
+
+            if (pmm.grow_pages(virt_to_phys(objp), page->m_order, order)) {
+                page->m_order = order;
+
+                if (flags & GFP::ZERO)
+                    kstd::memset(static_cast<uint8_t*>(ptr) + old_size, 0, ksize(objp) - old_size);
+
+                return ptr;
+            }
+        }
+    }
+    else if (new_size <= old_size)
+        return ptr;
+
+    void *new_ptr = kmalloc(new_size, flags);
+
+    if (!new_ptr)
+        return nullptr;
+
+    kstd::memcpy(new_ptr, objp, (new_size < old_size) ? new_size : old_size);
+    kfree(objp);
+
+    return new_ptr;
 }
 
 size_t ksize(const void *objp) noexcept
@@ -293,7 +697,11 @@ size_t ksize(const void *objp) noexcept
     if (!objp)
         return 0;
 
-    page_t *page = pmm.get_page(phys_addr_t(objp));
+    page_t *page = virt_to_page(objp);
+
+    if (page->m_flags & PG::LARGE)
+        return PAGE_SIZE << page->m_order;
+
     return page->m_cache->m_objsize;
 }
 
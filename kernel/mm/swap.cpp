@@ -0,0 +1,349 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/drivers/ata.hpp>
+#include <kernel/kstd/cstring.hpp>
+#include <kernel/printk.hpp>
+#include <kernel/panic.hpp>
+#include <kernel/swap.hpp>
+#include <kernel/slab.hpp>
+#include <kernel/pmm.hpp>
+
+
+namespace kernel {
+namespace core {
+namespace memory {
+
+swap_info_t  swap_info[MAX_SWAPFILES];
+uint32_t     nr_swapfiles;
+swap_stats_t swap_stats;
+
+/**
+ * @brief Get swap device of entry checking that slot is used.
+ *
+ * @param [in] entry - given swap entry.
+ * @return swap device.
+ */
+static swap_info_t *swap_info_get(swp_entry_t entry) noexcept
+{
+    uint32_t type   = swp_type(entry);
+    uint32_t offset = swp_offset(entry);
+
+    if (type >= nr_swapfiles || !offset || offset >= swap_info[type].m_pages)
+        panic("bad swap entry: %#X\n", entry.m_val);
+
+    swap_info_t *si = &swap_info[type];
+
+    if (!si->m_swap_map[offset])
+        panic("unused swap entry: %#X\n", entry.m_val);
+
+    return si;
+}
+
+bool swapon(const char *name, const swap_ops_t *ops, void *priv, uint32_t pages, int32_t prio) noexcept
+{
+    // slot 0 is reserved, so offset 0 never makes valid entry
+    if (nr_swapfiles >= MAX_SWAPFILES || pages < 2)
+        return false;
+
+    swap_info_t *si = &swap_info[nr_swapfiles];
+
+    si->m_swap_map = static_cast<uint16_t*>(kmalloc(pages * sizeof(uint16_t), GFP::KERNEL));
+    si->m_cache    = static_cast<page_t**>(kmalloc(pages * sizeof(page_t*), GFP::KERNEL));
+
+    if (!si->m_swap_map || !si->m_cache) {
+        kfree(si->m_swap_map);
+        kfree(si->m_cache);
+        return false;
+    }
+
+    kstd::memset(si->m_swap_map, 0, pages * sizeof(uint16_t));
+    kstd::memset(si->m_cache, 0, pages * sizeof(page_t*));
+
+    si->m_name    = name;
+    si->m_ops     = ops;
+    si->m_private = priv;
+    si->m_prio    = prio;
+    si->m_pages   = pages;
+    si->m_inuse   = 0;
+    si->m_next    = 1;
+
+    nr_swapfiles++;
+    return true;
+}
+
+swp_entry_t get_swap_page(void) noexcept
+{
+    swap_info_t *best = nullptr;
+
+    for (uint32_t i = 0; i < nr_swapfiles; i++) {
+        swap_info_t *si = &swap_info[i];
+
+        if (si->m_inuse + 1 >= si->m_pages)
+            continue;
+
+        if (!best || si->m_prio > best->m_prio)
+            best = si;
+    }
+
+    if (!best)
+        return {0};
+
+    // slots are handed out sequentially, so pages swapped out
+    // together are adjacent on device & read ahead together
+    uint32_t offset = best->m_next;
+
+    while (best->m_swap_map[offset]) {
+        if (++offset >= best->m_pages)
+            offset = 1;
+    }
+
+    best->m_swap_map[offset] = 1;
+    best->m_inuse++;
+    best->m_next = offset + 1 < best->m_pages ? offset + 1 : 1;
+
+    return swp_entry(best - swap_info, offset);
+}
+
+bool swap_duplicate(swp_entry_t entry) noexcept
+{
+    swap_info_t *si = swap_info_get(entry);
+    uint32_t offset = swp_offset(entry);
+
+    if (si->m_swap_map[offset] == SWAP_MAP_MAX)
+        return false;
+
+    si->m_swap_map[offset]++;
+    return true;
+}
+
+void swap_free(swp_entry_t entry) noexcept
+{
+    swap_info_t *si = swap_info_get(entry);
+    uint32_t offset = swp_offset(entry);
+
+    if (--si->m_swap_map[offset])
+        return;
+
+    // cached copy is not needed after the last entry is gone
+    page_t *page = si->m_cache[offset];
+
+    if (page) {
+        si->m_cache[offset] = nullptr;
+        page->m_flags &= ~PG::SWAP;
+        page->m_swap   = 0;
+        put_page(page);
+    }
+
+    if (si->m_ops->m_discard)
+        si->m_ops->m_discard(si->m_private, offset);
+
+    si->m_inuse--;
+}
+
+bool swap_writepage(swp_entry_t entry, page_t *page) noexcept
+{
+    swap_info_t *si = swap_info_get(entry);
+
+    if (!si->m_ops->m_write(si->m_private, swp_offset(entry), page->addr()))
+        return false;
+
+    swap_stats.m_pswpout++;
+    return true;
+}
+
+void delete_from_swap_cache(page_t *page) noexcept
+{
+    swp_entry_t entry = {page->m_swap};
+    swap_info_t *si   = swap_info_get(entry);
+
+    si->m_cache[swp_offset(entry)] = nullptr;
+    page->m_flags &= ~PG::SWAP;
+    page->m_swap   = 0;
+    put_page(page);
+}
+
+/**
+ * @brief Read swap slot into swap cache.
+ *
+ * @param [in] si - given swap device.
+ * @param [in] entry - given swap entry.
+ * @param [in] mask - given allocation flags.
+ * @return swap cache page - in case of success.
+ * @return nullptr - in case of allocation or I/O error.
+ */
+static page_t *read_swap_cache(swap_info_t *si, swp_entry_t entry, gfp_t mask) noexcept
+{
+    uint32_t offset = swp_offset(entry);
+    page_t *page    = pmm.alloc_pages(mask, 0);
+
+    if (!page)
+        return nullptr;
+
+    if (!si->m_ops->m_read(si->m_private, offset, page->addr())) {
+        put_page(page);
+        return nullptr;
+    }
+
+    // allocation reference is owned by swap cache
+    si->m_cache[offset] = page;
+    page->m_flags |= PG::SWAP;
+    page->m_swap   = entry.m_val;
+    lru_add(page);
+
+    swap_stats.m_pswpin++;
+    return page;
+}
+
+page_t *swapin_readahead(swp_entry_t entry) noexcept
+{
+    swap_info_t *si = swap_info_get(entry);
+    uint32_t offset = swp_offset(entry);
+    page_t *page    = si->m_cache[offset];
+
+    if (page) {
+        swap_stats.m_cache_hits++;
+        return page;
+    }
+
+    page = read_swap_cache(si, entry, GFP::KERNEL);
+
+    if (!page)
+        return nullptr;
+
+    uint32_t start = offset & ~(SWAP_CLUSTER_PAGES - 1);
+    uint32_t end   = start + SWAP_CLUSTER_PAGES;
+
+    if (end > si->m_pages)
+        end = si->m_pages;
+
+    // readahead gives up as soon as memory is short
+    for (uint32_t off = start ? start : 1; off < end; off++) {
+        if (off == offset || !si->m_swap_map[off] || si->m_cache[off])
+            continue;
+
+        if (!read_swap_cache(si, swp_entry(swp_type(entry), off), GFP::KERNEL | GFP::ATOMIC))
+            break;
+
+        swap_stats.m_readahead++;
+    }
+
+    return page;
+}
+
+inline const uint32_t PAGE_SECTORS {PAGE_SIZE / driver::ATA_SECTOR_SIZE};
+
+/**
+ * @brief Read page from disk swap partition.
+ *
+ * @param [in] priv - given disk.
+ * @param [in] offset - given slot offset.
+ * @param [out] buf - given page sized buffer to fill.
+ * @return true - in case of success.
+ * @return false - in case of I/O error.
+ */
+static bool ata_swap_read(void *priv, uint32_t offset, void *buf) noexcept
+{
+    return static_cast<driver::ata_t*>(priv)->read(offset * PAGE_SECTORS, PAGE_SECTORS, buf);
+}
+
+/**
+ * @brief Write page to disk swap partition.
+ *
+ * @param [in] priv - given disk.
+ * @param [in] offset - given slot offset.
+ * @param [in] buf - given page sized buffer.
+ * @return true - in case of success.
+ * @return false - in case of I/O error.
+ */
+static bool ata_swap_write(void *priv, uint32_t offset, const void *buf) noexcept
+{
+    return static_cast<driver::ata_t*>(priv)->write(offset * PAGE_SECTORS, PAGE_SECTORS, buf);
+}
+
+static const swap_ops_t ata_swap_ops = {
+    .m_read    = ata_swap_read,
+    .m_write   = ata_swap_write,
+    .m_discard = nullptr
+};
+
+/**
+ * @brief Read number of swap slots from header in slot 0 of disk.
+ *
+ * @param [in] disk_pages - given disk size in pages.
+ * @return number of slots (header included) - in case of valid header.
+ * @return 0 - in case of header is missing or I/O error.
+ */
+static uint32_t read_swap_header(uint32_t disk_pages) noexcept
+{
+    page_t *page = pmm.alloc_pages(GFP::KERNEL, 0);
+
+    if (!page)
+        return 0;
+
+    auto header    = static_cast<const uint8_t*>(page->addr());
+    uint32_t pages = 0;
+
+    if (ata_swap_read(&driver::ata, 0, page->addr()) &&
+        kstd::memcmp(header + SWAP_MAGIC_OFFSET, SWAP_MAGIC, SWAP_MAGIC_LEN) == 0) {
+        auto info = reinterpret_cast<const swap_header_t*>(header + SWAP_HEADER_OFFSET);
+
+        // header may describe partition smaller than the disk
+        if (info->m_version == 1 && info->m_last_page)
+            pages = info->m_last_page < disk_pages ? info->m_last_page + 1 : disk_pages;
+    }
+
+    put_page(page);
+    return pages;
+}
+
+bool swap_init(void) noexcept
+{
+    if (!driver::ata.set(0x1F0, 0x3F6, false))
+        return false;
+
+    // disk is used only if it was prepared with mkswap
+    uint32_t pages = read_swap_header(driver::ata.m_sectors / PAGE_SECTORS);
+
+    if (!pages)
+        return false;
+
+    return swapon("hda", &ata_swap_ops, &driver::ata, pages, 0);
+}
+
+void swapinfo(void) noexcept
+{
+    for (uint32_t i = 0; i < nr_swapfiles; i++) {
+        const swap_info_t& si = swap_info[i];
+        printk("%s: %u of %u slots used, priority %d\n", si.m_name, si.m_inuse, si.m_pages - 1, si.m_prio);
+    }
+
+    printk("lru:       %u active, %u inactive\n", lru_active.m_count, lru_inactive.m_count);
+    printk("swap I/O:  %u in, %u out, %u failed\n",
+        swap_stats.m_pswpin, swap_stats.m_pswpout, swap_stats.m_failed
+    );
+    printk("readahead: %u pages, %u swap cache hits\n", swap_stats.m_readahead, swap_stats.m_cache_hits);
+    printk("reclaim:   %u scanned, %u reclaimed, %u activated, %u deactivated\n",
+        swap_stats.m_scanned, swap_stats.m_reclaimed, swap_stats.m_activated,
+        swap_stats.m_deactivated
+    );
+}
+
+} // namespace memory
+} // namespace core
+} // namespace kernel
@@ -0,0 +1,166 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/system.hpp>
+#include <kernel/mm_types.hpp>
+#include <kernel/printk.hpp>
+#include <kernel/tlb.hpp>
+#include <kernel/pmm.hpp>
+
+
+namespace kernel {
+namespace core {
+namespace memory {
+
+uint32_t tlb_flush_ceiling {33};
+
+percpu_t<tlb_stats_t> tlb_stats;
+percpu_t<tlb_state_t> tlb_state;
+
+void tlb_gather_t::init(pde_t *pgdir) noexcept
+{
+    m_pgdir  = pgdir;
+    m_start  = 0;
+    m_end    = 0;
+    m_count    = 0;
+    m_global   = false;
+    m_nr_pages = 0;
+}
+
+void tlb_gather_t::add(uint32_t addr, pte_t old) noexcept
+{
+    // non-present entries are never cached
+    if (!(old & PTE_PRESENT))
+        return;
+
+    addr &= PTE_ADDR_MASK;
+
+    if (!m_count || addr < m_start)
+        m_start = addr;
+
+    if (!m_count || addr + PAGE_SIZE > m_end)
+        m_end = addr + PAGE_SIZE;
+
+    if (old & PTE_GLOBAL)
+        m_global = true;
+
+    if (m_count < TLB_GATHER_ADDRS)
+        m_addrs[m_count] = addr;
+
+    m_count++;
+}
+
+void tlb_gather_t::release(page_t *page) noexcept
+{
+    if (m_nr_pages == TLB_GATHER_PAGES)
+        finish();
+
+    m_pages[m_nr_pages++] = page;
+}
+
+void tlb_gather_t::finish(void) noexcept
+{
+    if (!m_count) {
+        for (uint32_t i = 0; i < m_nr_pages; i++)
+            put_page(m_pages[i]);
+
+        m_nr_pages = 0;
+        return;
+    }
+
+    auto& stats = tlb_stats.this_cpu();
+    auto& state = tlb_state.this_cpu();
+
+    // global entries are cached regardless of loaded address space
+    if (!m_global && m_pgdir != vmm.m_active)
+        stats.m_skipped++;
+    // kernel thread does not access user mappings until it is switched from
+    else if (!m_global && state.m_lazy && m_end - 1 < PAGE_OFFSET) {
+        state.m_need_flush = true;
+        stats.m_lazy++;
+    }
+    // distant entries are invalidated one by one as well
+    else if (m_count <= tlb_flush_ceiling && m_count <= TLB_GATHER_ADDRS) {
+        for (uint32_t i = 0; i < m_count; i++)
+            arch::x86::invlpg(m_addrs[i]);
+
+        stats.m_pages += m_count;
+        stats.m_ranges++;
+    }
+    else if (m_global) {
+        arch::x86::flush_tlb_global();
+        stats.m_global++;
+    }
+    else {
+        arch::x86::flush_tlb();
+        stats.m_full++;
+    }
+
+    for (uint32_t i = 0; i < m_nr_pages; i++)
+        put_page(m_pages[i]);
+
+    init(m_pgdir);
+}
+
+void flush_tlb_page(uint32_t addr) noexcept
+{
+    arch::x86::invlpg(addr);
+    tlb_stats.this_cpu().m_pages++;
+}
+
+void enter_lazy_tlb(void) noexcept
+{
+    tlb_state.this_cpu().m_lazy = true;
+}
+
+void leave_lazy_tlb(void) noexcept
+{
+    auto& state = tlb_state.this_cpu();
+
+    if (state.m_need_flush) {
+        arch::x86::flush_tlb();
+        tlb_stats.this_cpu().m_lazy_done++;
+    }
+
+    state.m_lazy       = false;
+    state.m_need_flush = false;
+}
+
+void tlbstat(void) noexcept
+{
+    printk("TLB flush ceiling: %u pages\n", tlb_flush_ceiling);
+
+    for (uint32_t cpu = 0; cpu < NR_CPUS; cpu++) {
+        const auto& stats = tlb_stats[cpu];
+
+        if (!stats.m_switch && !stats.m_pages && !stats.m_full && !stats.m_global && !stats.m_lazy)
+            continue;
+
+        printk("CPU %u:\n", cpu);
+        printk("  invlpg:  %u pages in %u ranges\n", stats.m_pages, stats.m_ranges);
+        printk("  full:    %u (%u global)\n", stats.m_full, stats.m_global);
+        printk("  skipped: %u inactive, %u lazy (%u flushed later)\n",
+            stats.m_skipped, stats.m_lazy, stats.m_lazy_done
+        );
+        printk("  switch:  %u\n", stats.m_switch);
+    }
+}
+
+} // namespace memory
+} // namespace core
+} // namespace kernel
@@ -0,0 +1,236 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/system.hpp>
+#include <kernel/arch/x86/cpuid.hpp>
+#include <kernel/vmm.hpp>
+#include <kernel/pmm.hpp>
+#include <kernel/tlb.hpp>
+
+
+namespace kernel {
+namespace core {
+namespace memory {
+
+virt_mman_t vmm;
+
+alignas(4096) static pde_t kernel_pgdir[PGDIR_ENTRIES];
+
+/**
+ * @brief Get end of available physical memory.
+ *
+ * @param [in] mboot - given multiboot information structure.
+ * @return highest available physical address.
+ */
+static uint64_t available_memory_end(const multiboot_t& mboot) noexcept
+{
+    multiboot_entry_t *mmmt;
+    uint64_t end = 0;
+
+    for (size_t i = 0; i < mboot.mmap_length; i += sizeof(multiboot_entry_t)) {
+        mmmt = static_cast<multiboot_entry_t*>(phys_to_virt(mboot.mmap_addr + i));
+
+        if (mmmt->type == MULTIBOOT_MEMORY_AVAILABLE && mmmt->addr + mmmt->len > end)
+            end = mmmt->addr + mmmt->len;
+    }
+
+    return end;
+}
+
+void virt_mman_t::init(const multiboot_t& mboot) noexcept
+{
+    using namespace arch::x86;
+
+    m_pgdir        = kernel_pgdir;
+    m_ioremap_next = IOREMAP_START;
+    m_global       = has_feature(CPUID_EDX_PGE) ? PTE_GLOBAL : 0;
+
+    // memory above direct map is left unused (no highmem support)
+    uint64_t end = available_memory_end(mboot);
+
+    if (end > LOWMEM_SIZE)
+        end = LOWMEM_SIZE;
+
+    m_lowmem_end = (end + LARGE_PAGE_SIZE - 1) & LARGE_PAGE_MASK;
+
+    // direct map of physical memory with 4 MB pages
+    uint32_t first = PAGE_OFFSET >> PGDIR_SHIFT;
+    uint32_t count = m_lowmem_end >> PGDIR_SHIFT;
+
+    for (uint32_t i = 0; i < count; i++)
+        m_pgdir[first + i] = (i << PGDIR_SHIFT) | PTE_PRESENT | PTE_WRITE | PTE_LARGE | m_global;
+
+    m_pgdir[RECURSIVE_PDE] = virt_to_phys(m_pgdir) | PTE_PRESENT | PTE_WRITE;
+
+    // identity mapping is not set, so it is dropped here
+    load(m_pgdir);
+
+    // global bits are ignored until CR4.PGE is set
+    if (m_global)
+        write_cr4(read_cr4() | CR4_PGE);
+}
+
+void virt_mman_t::load(pde_t *pgdir) noexcept
+{
+    m_active = pgdir;
+    arch::x86::write_cr3(virt_to_phys(pgdir));
+
+    // CR3 reload flushed deferred user mappings as well
+    tlb_state.this_cpu().m_need_flush = false;
+    tlb_stats.this_cpu().m_switch++;
+}
+
+bool virt_mman_t::map_range(uint32_t virt, phys_addr_t phys, size_t size, uint32_t flags) noexcept
+{
+    uint64_t end = uint64_t(virt) + size;
+    pte_t *pte   = nullptr;
+    tlb_gather_t tlb;
+
+    tlb.init(m_active);
+
+    for (uint64_t addr = virt; addr < end; addr += PAGE_SIZE, phys += PAGE_SIZE) {
+        // page tables are walked only at 4 MB boundaries
+        if (!pte || !(addr & (LARGE_PAGE_SIZE - 1))) {
+            pte = get_pte(m_active, addr, true);
+
+            if (!pte) {
+                tlb.finish();
+                return false;
+            }
+        }
+        else
+            pte++;
+
+        tlb.add(addr, *pte);
+        *pte = phys | flags;
+    }
+
+    tlb.finish();
+    return true;
+}
+
+void virt_mman_t::unmap_range(uint32_t virt, size_t size, unmap_fn_t fn, tlb_gather_t *tlb) noexcept
+{
+    uint64_t end = uint64_t(virt) + size;
+    tlb_gather_t local;
+
+    if (!tlb) {
+        local.init(m_active);
+        tlb = &local;
+    }
+
+    for (uint64_t addr = virt; addr < end; addr += PAGE_SIZE) {
+        pde_t pde = *pde_for(addr);
+
+        // skip the whole 4 MB range of missing page table
+        if (!(pde & PTE_PRESENT) || (pde & PTE_LARGE)) {
+            addr = (addr | (LARGE_PAGE_SIZE - 1)) + 1 - PAGE_SIZE;
+            continue;
+        }
+
+        pte_t *pte = pte_for(addr);
+
+        if (!*pte)
+            continue;
+
+        // entry is cleared first, since callback may flush the gather
+        pte_t old = *pte;
+        *pte      = 0;
+
+        // swapped out pages have nothing to flush
+        if (old & PTE_PRESENT)
+            tlb->add(addr, old);
+
+        if (fn)
+            fn(addr, old, tlb);
+    }
+
+    if (tlb == &local)
+        local.finish();
+}
+
+void *virt_mman_t::ioremap(phys_addr_t addr, size_t size) noexcept
+{
+    uint64_t start = addr & LARGE_PAGE_MASK;
+    uint64_t end   = (uint64_t(addr) + size + LARGE_PAGE_SIZE - 1) & LARGE_PAGE_MASK;
+    uint32_t count = (end - start) >> PGDIR_SHIFT;
+    uint32_t flags = PTE_PRESENT | PTE_WRITE | PTE_LARGE | PTE_PCD | PTE_PWT | m_global;
+
+    // reuse existing mapping of the same region
+    for (uint32_t v = IOREMAP_START; v < m_ioremap_next; v += LARGE_PAGE_SIZE) {
+        if ((m_pgdir[v >> PGDIR_SHIFT] & LARGE_PAGE_MASK) != start)
+            continue;
+
+        uint32_t i = 1;
+
+        while (i < count && v + i * LARGE_PAGE_SIZE < m_ioremap_next &&
+               (m_pgdir[(v >> PGDIR_SHIFT) + i] & LARGE_PAGE_MASK) == start + i * LARGE_PAGE_SIZE)
+            i++;
+
+        if (i == count)
+            return reinterpret_cast<void*>(v + (addr - start));
+    }
+
+    if (uint64_t(m_ioremap_next) + (end - start) > IOREMAP_END)
+        return nullptr;
+
+    uint32_t virt = m_ioremap_next;
+
+    for (uint32_t i = 0; i < count; i++) {
+        m_pgdir[(virt >> PGDIR_SHIFT) + i] = (uint32_t(start) + (i << PGDIR_SHIFT)) | flags;
+        flush_tlb_page(virt + (i << PGDIR_SHIFT));
+    }
+
+    m_ioremap_next += count << PGDIR_SHIFT;
+
+    return reinterpret_cast<void*>(virt + (addr - start));
+}
+
+pte_t *get_pte(pde_t *pgdir, uint32_t addr, bool alloc) noexcept
+{
+    pde_t& pde = pgdir[addr >> PGDIR_SHIFT];
+
+    if (pde & PTE_LARGE)
+        return nullptr;
+
+    if (!(pde & PTE_PRESENT)) {
+        if (!alloc)
+            return nullptr;
+
+        page_t *page = pmm.get_zeroed_page(GFP::KERNEL | GFP::ZERO);
+
+        if (!page)
+            return nullptr;
+
+        // access rights are checked on page table entries level
+        pde = PFN_PHYS(page->m_pfn) | PTE_PRESENT | PTE_WRITE | PTE_USER;
+
+        if (pgdir == vmm.m_active)
+            arch::x86::invlpg(reinterpret_cast<uint32_t>(pte_for(addr)) & PTE_ADDR_MASK);
+    }
+
+    if (pgdir == vmm.m_active)
+        return pte_for(addr);
+
+    auto table = static_cast<pte_t*>(phys_to_virt(pde & PTE_ADDR_MASK));
+    return &table[(addr >> PAGE_SHIFT) & (PTRS_PER_PTE - 1)];
+}
+
+} // namespace memory
+} // namespace core
+} // namespace kernel
@@ -0,0 +1,302 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/mmap.hpp>
+#include <kernel/swap.hpp>
+#include <kernel/tlb.hpp>
+#include <kernel/pmm.hpp>
+
+
+namespace kernel {
+namespace core {
+namespace memory {
+
+lru_list_t lru_active;
+lru_list_t lru_inactive;
+
+/**
+ * @brief Insert page at the head of reclaim list.
+ *
+ * @param [in] list - given reclaim list.
+ * @param [in] page - given page struct.
+ */
+static void list_add(lru_list_t& list, page_t *page) noexcept
+{
+    page->m_prev = nullptr;
+    page->m_next = list.m_head;
+
+    if (list.m_head)
+        list.m_head->m_prev = page;
+    else
+        list.m_tail = page;
+
+    list.m_head = page;
+    list.m_count++;
+}
+
+/**
+ * @brief Remove page from reclaim list.
+ *
+ * @param [in] list - given reclaim list.
+ * @param [in] page - given page struct.
+ */
+static void list_del(lru_list_t& list, page_t *page) noexcept
+{
+    if (page->m_prev)
+        page->m_prev->m_next = page->m_next;
+    else
+        list.m_head = page->m_next;
+
+    if (page->m_next)
+        page->m_next->m_prev = page->m_prev;
+    else
+        list.m_tail = page->m_prev;
+
+    page->m_prev = nullptr;
+    page->m_next = nullptr;
+    list.m_count--;
+}
+
+/**
+ * @brief Move page to the head of active list.
+ *
+ * @param [in] page - given page struct on any reclaim list.
+ */
+static void activate_page(page_t *page) noexcept
+{
+    list_del((page->m_flags & PG::ACTIVE) ? lru_active : lru_inactive, page);
+    page->m_flags |= PG::ACTIVE;
+    list_add(lru_active, page);
+}
+
+/**
+ * @brief Move page to the head of inactive list.
+ *
+ * @param [in] page - given page struct on any reclaim list.
+ */
+static void deactivate_page(page_t *page) noexcept
+{
+    list_del((page->m_flags & PG::ACTIVE) ? lru_active : lru_inactive, page);
+    page->m_flags &= ~PG::ACTIVE;
+    list_add(lru_inactive, page);
+}
+
+void lru_add(page_t *page) noexcept
+{
+    // new pages have to be referenced again to get to active list
+    page->m_flags |= PG::LRU;
+    list_add(lru_inactive, page);
+}
+
+void lru_del(page_t *page) noexcept
+{
+    list_del((page->m_flags & PG::ACTIVE) ? lru_active : lru_inactive, page);
+    page->m_flags &= ~(PG::LRU | PG::ACTIVE);
+    page->m_mm     = nullptr;
+}
+
+void page_add_anon_rmap(page_t *page, mm_t *mm, uint32_t addr) noexcept
+{
+    page->m_mm    = mm;
+    page->m_vaddr = addr;
+
+    if (!(page->m_flags & PG::LRU))
+        lru_add(page);
+}
+
+/**
+ * @brief Get page table entry mapping anonymous page.
+ *
+ * @param [in] page - given page struct.
+ * @return page table entry - in case of page is mapped by its address space only.
+ * @return nullptr - otherwise.
+ */
+static pte_t *page_pte(page_t *page) noexcept
+{
+    if (!page->m_mm || page_count(page) != 1)
+        return nullptr;
+
+    pte_t *pte = get_pte(page->m_mm->m_pgdir, page->m_vaddr, false);
+
+    // address space has replaced the page, while another one still maps it
+    if (!pte || !(*pte & PTE_PRESENT) || (*pte & PTE_ADDR_MASK) != PFN_PHYS(page->m_pfn)) {
+        page->m_mm = nullptr;
+        return nullptr;
+    }
+
+    return pte;
+}
+
+/**
+ * @brief Test and clear accessed bit of page table entry.
+ *
+ * @param [in] page - given mapped page struct.
+ * @param [in] pte - given page table entry.
+ * @return true - in case of page was accessed since the last check.
+ * @return false - otherwise.
+ */
+static bool page_referenced(const page_t *page, pte_t *pte) noexcept
+{
+    if (!(*pte & PTE_ACCESSED))
+        return false;
+
+    *pte &= ~PTE_ACCESSED;
+
+    // CPU sets accessed bit only when entry is loaded into TLB
+    if (page->m_mm->m_pgdir == vmm.m_active)
+        flush_tlb_page(page->m_vaddr);
+
+    return true;
+}
+
+/**
+ * @brief Write page to swap and replace its mapping by swap entry.
+ *
+ * @param [in] page - given exclusively mapped page struct.
+ * @param [in] pte - given page table entry.
+ * @return true - in case of page was freed.
+ * @return false - in case of swap is full or I/O error.
+ */
+static bool swap_out(page_t *page, pte_t *pte) noexcept
+{
+    swp_entry_t entry = get_swap_page();
+
+    if (!entry.m_val)
+        return false;
+
+    // page must not be written while its contents go to swap
+    pte_t old = *pte;
+    *pte      = swp_entry_to_pte(entry);
+
+    if (page->m_mm->m_pgdir == vmm.m_active)
+        flush_tlb_page(page->m_vaddr);
+
+    if (!swap_writepage(entry, page)) {
+        *pte = old;
+        swap_free(entry);
+        return false;
+    }
+
+    put_page(page);
+    return true;
+}
+
+/**
+ * @brief Move unreferenced pages from the tail of active list to inactive list.
+ *
+ * @param [in] nr_scan - given number of pages to scan.
+ */
+static void refill_inactive(uint32_t nr_scan) noexcept
+{
+    // both lists are kept of the same size
+    while (nr_scan-- && lru_active.m_tail && lru_inactive.m_count < lru_active.m_count) {
+        page_t *page = lru_active.m_tail;
+        pte_t *pte   = page_pte(page);
+
+        if (pte && page_referenced(page, pte)) {
+            activate_page(page);
+            continue;
+        }
+
+        deactivate_page(page);
+        swap_stats.m_deactivated++;
+    }
+}
+
+/**
+ * @brief Free unreferenced pages from the tail of inactive list.
+ *
+ * @param [in] nr_scan - given number of pages to scan.
+ * @param [in] nr_pages - given number of pages to free.
+ * @return number of freed pages.
+ */
+static uint32_t shrink_inactive(uint32_t nr_scan, uint32_t nr_pages) noexcept
+{
+    uint32_t freed = 0;
+
+    while (nr_scan-- && freed < nr_pages && lru_inactive.m_tail) {
+        page_t *page = lru_inactive.m_tail;
+        swap_stats.m_scanned++;
+
+        // slot contents are on device, so unmapped copy is simply dropped
+        if ((page->m_flags & PG::SWAP) && page_count(page) == 1) {
+            delete_from_swap_cache(page);
+            freed++;
+            continue;
+        }
+
+        pte_t *pte = page_pte(page);
+
+        // shared pages stay until all but one user drop them
+        if (!pte) {
+            activate_page(page);
+            continue;
+        }
+
+        if (page_referenced(page, pte)) {
+            activate_page(page);
+            swap_stats.m_activated++;
+            continue;
+        }
+
+        if (!swap_out(page, pte)) {
+            activate_page(page);
+            swap_stats.m_failed++;
+            break;
+        }
+
+        freed++;
+    }
+
+    return freed;
+}
+
+uint32_t shrink_memory(uint32_t nr_pages) noexcept
+{
+    static bool reclaiming;
+
+    // allocations of reclaim itself never recurse into it
+    if (reclaiming)
+        return 0;
+
+    reclaiming = true;
+
+    uint32_t freed = 0;
+    uint32_t total = lru_active.m_count + lru_inactive.m_count;
+
+    // every page is looked at no more than twice
+    for (uint32_t scanned = 0; freed < nr_pages && scanned < 2 * total; scanned += SWAP_SCAN_BATCH) {
+        refill_inactive(SWAP_SCAN_BATCH);
+
+        uint32_t n = shrink_inactive(SWAP_SCAN_BATCH, nr_pages - freed);
+
+        if (!n && !lru_inactive.m_count)
+            break;
+
+        freed += n;
+    }
+
+    swap_stats.m_reclaimed += freed;
+    reclaiming = false;
+
+    return freed;
+}
+
+} // namespace memory
+} // namespace core
+} // namespace kernel
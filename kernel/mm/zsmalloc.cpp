@@ -0,0 +1,149 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/zsmalloc.hpp>
+#include <kernel/pmm.hpp>
+
+
+namespace kernel {
+namespace core {
+namespace memory {
+
+/**
+ * @brief Insert page at the head of class list of pages with free objects.
+ *
+ * @param [in] cls - given size class.
+ * @param [in] zspage - given page header.
+ */
+static void link_zspage(zs_class_t& cls, zspage_t *zspage) noexcept
+{
+    zspage->m_prev = nullptr;
+    zspage->m_next = cls.m_partial;
+
+    if (cls.m_partial)
+        cls.m_partial->m_prev = zspage;
+
+    cls.m_partial = zspage;
+}
+
+/**
+ * @brief Remove page from class list of pages with free objects.
+ *
+ * @param [in] cls - given size class.
+ * @param [in] zspage - given page header.
+ */
+static void unlink_zspage(zs_class_t& cls, zspage_t *zspage) noexcept
+{
+    if (zspage->m_prev)
+        zspage->m_prev->m_next = zspage->m_next;
+    else
+        cls.m_partial = zspage->m_next;
+
+    if (zspage->m_next)
+        zspage->m_next->m_prev = zspage->m_prev;
+
+    zspage->m_prev = nullptr;
+    zspage->m_next = nullptr;
+}
+
+void zs_pool_t::init(void) noexcept
+{
+    for (uint32_t i = 0; i < ZS_NR_CLASSES; i++) {
+        zs_class_t& cls = m_classes[i];
+
+        cls.m_size    = (i + 1) * ZS_ALIGN;
+        cls.m_objs    = (PAGE_SIZE - sizeof(zspage_t)) / cls.m_size;
+        cls.m_partial = nullptr;
+        cls.m_pages   = 0;
+        cls.m_inuse   = 0;
+    }
+
+    m_pages = 0;
+}
+
+void *zs_pool_t::alloc(uint32_t size, gfp_t flags) noexcept
+{
+    if (!size || size > ZS_MAX_ALLOC)
+        return nullptr;
+
+    uint32_t index  = (size - 1) / ZS_ALIGN;
+    zs_class_t& cls = m_classes[index];
+    zspage_t *zspage = cls.m_partial;
+
+    if (!zspage) {
+        page_t *page = pmm.alloc_pages(flags, 0);
+
+        if (!page)
+            return nullptr;
+
+        zspage = static_cast<zspage_t*>(page->addr());
+        zspage->m_inuse = 0;
+        zspage->m_class = index;
+        zspage->m_free  = nullptr;
+
+        // objects are pushed in reverse, so they are handed out in address order
+        auto base = reinterpret_cast<uint8_t*>(zspage + 1);
+
+        for (uint32_t i = cls.m_objs; i-- > 0;) {
+            void *objp = base + i * cls.m_size;
+            *static_cast<void**>(objp) = zspage->m_free;
+            zspage->m_free = objp;
+        }
+
+        link_zspage(cls, zspage);
+        cls.m_pages++;
+        m_pages++;
+    }
+
+    void *objp     = zspage->m_free;
+    zspage->m_free = *static_cast<void**>(objp);
+    zspage->m_inuse++;
+    cls.m_inuse++;
+
+    if (!zspage->m_free)
+        unlink_zspage(cls, zspage);
+
+    return objp;
+}
+
+void zs_pool_t::free(void *objp) noexcept
+{
+    auto zspage     = reinterpret_cast<zspage_t*>(reinterpret_cast<uint32_t>(objp) & ~(PAGE_SIZE - 1));
+    zs_class_t& cls = m_classes[zspage->m_class];
+
+    // full page gets free object again
+    if (!zspage->m_free)
+        link_zspage(cls, zspage);
+
+    *static_cast<void**>(objp) = zspage->m_free;
+    zspage->m_free = objp;
+    zspage->m_inuse--;
+    cls.m_inuse--;
+
+    if (zspage->m_inuse)
+        return;
+
+    unlink_zspage(cls, zspage);
+    put_page(virt_to_page(zspage));
+    cls.m_pages--;
+    m_pages--;
+}
+
+} // namespace memory
+} // namespace core
+} // namespace kernel
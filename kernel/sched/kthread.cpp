@@ -0,0 +1,111 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  kthread.cpp
+ * @brief Contains kernel threads creation implementation.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#include <kernel/kthread.hpp>
+#include <kernel/panic.hpp>
+#include <kernel/slab.hpp>
+
+
+namespace kernel {
+namespace core {
+
+/**
+ * @brief Entry of new thread.
+ *
+ * @details The first switch to thread returns here from switch_to()
+ * with interrupts disabled by schedule().
+ */
+static void kthread_entry(void) noexcept
+{
+    schedule_tail();
+    arch::x86::irq_enable();
+
+    task_t *task = current();
+    task->m_func(task->m_data);
+
+    kthread_exit();
+}
+
+task_t *kthread_create(kthread_func_t func, void *data, const char *name) noexcept
+{
+    sched_reap_dead();
+
+    auto task = static_cast<task_t*>(kmalloc(sizeof(task_t), GFP::KERNEL));
+
+    if (!task)
+        return nullptr;
+
+    auto stack = static_cast<uint32_t*>(kmalloc(THREAD_SIZE, GFP::KERNEL));
+
+    if (!stack) {
+        kfree(task);
+        return nullptr;
+    }
+
+    sched_fork(task, name);
+
+    task->m_func    = func;
+    task->m_data    = data;
+    task->m_stack   = stack;
+    task->m_kthread = true;
+    *stack          = STACK_END_MAGIC;
+
+    // frame popped by switch_to(): edi, esi, ebx, ebp & return address
+    uint32_t *sp = stack + THREAD_SIZE / sizeof(uint32_t);
+
+    *--sp = 0;  // kthread_entry() never returns
+    *--sp = reinterpret_cast<uint32_t>(kthread_entry);
+    *--sp = 0;  // ebp
+    *--sp = 0;  // ebx
+    *--sp = 0;  // esi
+    *--sp = 0;  // edi
+
+    task->m_esp = reinterpret_cast<uint32_t>(sp);
+    return task;
+}
+
+task_t *kthread_run(kthread_func_t func, void *data, const char *name) noexcept
+{
+    task_t *task = kthread_create(func, data, name);
+
+    if (task)
+        wake_up_process(task);
+
+    return task;
+}
+
+void kthread_exit(void) noexcept
+{
+    arch::x86::irq_disable();
+    set_current_state(task_state::DEAD);
+
+    // the next task unlinks this one, it is freed by sched_reap_dead()
+    schedule();
+    panic("%s\n", "dead thread was scheduled");
+}
+
+} // namespace core
+} // namespace kernel
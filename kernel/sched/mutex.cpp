@@ -0,0 +1,97 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  mutex.cpp
+ * @brief Contains sleeping lock implementation.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#include <kernel/mutex.hpp>
+
+
+namespace kernel {
+namespace core {
+
+mutex_t kernel_lock {nullptr, nullptr, &kernel_lock.m_waiters, 0};
+
+void mutex_t::init(void) noexcept
+{
+    m_owner     = nullptr;
+    m_waiters   = nullptr;
+    m_tail      = &m_waiters;
+    m_contended = 0;
+}
+
+void mutex_t::lock(void) noexcept
+{
+    auto flags   = arch::x86::irq_save();
+    task_t *curr = current();
+
+    if (m_owner)
+        m_contended++;
+
+    // woken waiter may find mutex taken by other task again
+    while (m_owner) {
+        curr->m_wait_next = nullptr;
+        *m_tail           = curr;
+        m_tail            = &curr->m_wait_next;
+
+        set_current_state(task_state::SLEEPING);
+        schedule();
+    }
+
+    m_owner = curr;
+    arch::x86::irq_restore(flags);
+}
+
+bool mutex_t::trylock(void) noexcept
+{
+    auto flags  = arch::x86::irq_save();
+    bool locked = !m_owner;
+
+    if (locked)
+        m_owner = current();
+
+    arch::x86::irq_restore(flags);
+    return locked;
+}
+
+void mutex_t::unlock(void) noexcept
+{
+    auto flags   = arch::x86::irq_save();
+    task_t *task = m_waiters;
+
+    m_owner = nullptr;
+
+    if (task) {
+        m_waiters = task->m_wait_next;
+
+        if (!m_waiters)
+            m_tail = &m_waiters;
+
+        wake_up_process(task);
+    }
+
+    arch::x86::irq_restore(flags);
+}
+
+} // namespace core
+} // namespace kernel
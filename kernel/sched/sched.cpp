@@ -0,0 +1,372 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  sched.cpp
+ * @brief Contains kernel threads scheduler implementation.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#include <kernel/kstd/cstring.hpp>
+#include <kernel/clocksource.hpp>
+#include <kernel/linkage.hpp>
+#include <kernel/kthread.hpp>
+#include <kernel/printk.hpp>
+#include <kernel/sched.hpp>
+#include <kernel/timer.hpp>
+#include <kernel/panic.hpp>
+#include <kernel/slab.hpp>
+#include <kernel/tick.hpp>
+#include <kernel/tlb.hpp>
+
+
+namespace kernel {
+namespace core {
+
+percpu_t<runqueue_t> runqueues;
+task_t              *task_list {nullptr};
+
+static task_t   boot_task;      // boot thread runs on boot stack
+static task_t  *dead_tasks;     // exited tasks waiting to be freed
+static uint32_t next_pid {0};
+
+/**
+ * @brief Save callee-saved registers & stack pointer of previous task
+ * and restore them for the next one.
+ *
+ * @param [out] prev_esp - given saved stack pointer of previous task.
+ * @param [in] next_esp - given saved stack pointer of the next task.
+ */
+asmlinkage void switch_to(uint32_t *prev_esp, uint32_t next_esp);
+
+/**
+ * @brief Idle thread function.
+ *
+ * @details Idle task is never preempted on interrupt exit, so tick is
+ * restarted before it switches to the woken task.
+ *
+ * @param [in] data - given unused data.
+ */
+static void idle_thread(void *data) noexcept
+{
+    (void)data;
+
+    for (;;) {
+        arch::x86::irq_disable();
+
+        // cpu_idle() returns with interrupts enabled
+        if (!need_resched())
+            cpu_idle();
+        else
+            arch::x86::irq_enable();
+
+        schedule();
+    }
+}
+
+/**
+ * @brief Put task at the tail of run queue.
+ *
+ * @param [in] rq - given run queue.
+ * @param [in] task - given task that is not queued.
+ */
+static void enqueue_task(runqueue_t& rq, task_t *task) noexcept
+{
+    task->m_run_next = nullptr;
+    task->m_on_rq    = true;
+
+    if (rq.m_tail)
+        rq.m_tail->m_run_next = task;
+    else
+        rq.m_head = task;
+
+    rq.m_tail = task;
+    rq.m_nr_running++;
+}
+
+/**
+ * @brief Take task from the head of run queue.
+ *
+ * @param [in] rq - given run queue.
+ * @return task - in case of queue is not empty.
+ * @return nullptr - otherwise.
+ */
+static task_t *dequeue_task(runqueue_t& rq) noexcept
+{
+    task_t *task = rq.m_head;
+
+    if (!task)
+        return nullptr;
+
+    rq.m_head = task->m_run_next;
+
+    if (!rq.m_head)
+        rq.m_tail = nullptr;
+
+    task->m_run_next = nullptr;
+    task->m_on_rq    = false;
+    rq.m_nr_running--;
+
+    return task;
+}
+
+/**
+ * @brief Switch from current task to the next one.
+ *
+ * @param [in] preempt - given flag whether current task is preempted.
+ */
+static void do_schedule(bool preempt) noexcept
+{
+    runqueue_t& rq = runqueues.this_cpu();
+    task_t *prev   = rq.m_curr;
+
+    if (prev->m_stack && *prev->m_stack != STACK_END_MAGIC)
+        panic("stack overflow in %s\n", prev->m_comm);
+
+    rq.m_need_resched = false;
+
+    // preempted task is queued even if it was about to sleep
+    if (prev != rq.m_idle && (preempt || prev->m_state == task_state::RUNNING))
+        enqueue_task(rq, prev);
+
+    task_t *next = dequeue_task(rq);
+
+    if (!next)
+        next = rq.m_idle;
+
+    if (next == prev)
+        return;
+
+    uint64_t now       = clock_monotonic_ns();
+    prev->m_runtime   += now - prev->m_exec_start;
+    next->m_exec_start = now;
+    next->m_slice      = SCHED_SLICE;
+    next->m_switches++;
+
+    if (preempt)
+        prev->m_preempted++;
+
+    rq.m_curr = next;
+    rq.m_prev = prev;
+    rq.m_switches++;
+
+    // kernel thread keeps address space of previous task loaded
+    if (next->m_kthread)
+        memory::enter_lazy_tlb();
+    else
+        memory::leave_lazy_tlb();
+
+    switch_to(&prev->m_esp, next->m_esp);
+
+    // running as prev again, switched from whatever task ran before
+    schedule_tail();
+}
+
+bool sched_init(const char *name) noexcept
+{
+    runqueue_t& rq = runqueues.this_cpu();
+
+    sched_fork(&boot_task, name);
+    boot_task.m_state      = task_state::RUNNING;
+    boot_task.m_exec_start = clock_monotonic_ns();
+
+    rq.m_curr = &boot_task;
+    rq.m_idle = kthread_create(idle_thread, nullptr, "idle");
+
+    if (!rq.m_idle) {
+        rq.m_curr = nullptr;
+        return false;
+    }
+
+    rq.m_idle->m_state = task_state::RUNNING;
+    return true;
+}
+
+void schedule(void) noexcept
+{
+    auto flags = arch::x86::irq_save();
+    do_schedule(false);
+    arch::x86::irq_restore(flags);
+}
+
+void schedule_tail(void) noexcept
+{
+    task_t *prev = runqueues.this_cpu().m_prev;
+
+    if (!prev || prev->m_state != task_state::DEAD)
+        return;
+
+    // unlink from task list
+    task_t **link = &task_list;
+
+    while (*link != prev)
+        link = &(*link)->m_next;
+
+    *link = prev->m_next;
+    runqueues.this_cpu().m_prev = nullptr;
+
+    // switch may have preempted allocator, so task is freed later
+    prev->m_next = dead_tasks;
+    dead_tasks   = prev;
+}
+
+void sched_reap_dead(void) noexcept
+{
+    auto flags   = arch::x86::irq_save();
+    task_t *task = dead_tasks;
+    dead_tasks   = nullptr;
+    arch::x86::irq_restore(flags);
+
+    // nothing runs on their stacks anymore
+    while (task) {
+        task_t *next = task->m_next;
+
+        kfree(task->m_stack);
+        kfree(task);
+        task = next;
+    }
+}
+
+void preempt_schedule_irq(void) noexcept
+{
+    runqueue_t& rq = runqueues.this_cpu();
+
+    if (!rq.m_need_resched || rq.m_preempt_count || !rq.m_curr || rq.m_curr == rq.m_idle)
+        return;
+
+    do_schedule(true);
+}
+
+void scheduler_tick(void) noexcept
+{
+    runqueue_t& rq = runqueues.this_cpu();
+    task_t *curr   = rq.m_curr;
+
+    if (!curr || curr == rq.m_idle)
+        return;
+
+    if (curr->m_slice)
+        curr->m_slice--;
+
+    // task keeps CPU while there is no one to share it with
+    if (!curr->m_slice && rq.m_nr_running)
+        rq.m_need_resched = true;
+}
+
+bool wake_up_process(task_t *task) noexcept
+{
+    auto flags = arch::x86::irq_save();
+    bool woken = task->m_state == task_state::SLEEPING;
+
+    if (woken) {
+        runqueue_t& rq = runqueues[task->m_cpu];
+        task->m_state  = task_state::RUNNING;
+
+        // task that has not switched out yet is queued by schedule()
+        if (!task->m_on_rq && task != rq.m_curr)
+            enqueue_task(rq, task);
+
+        if (rq.m_curr == rq.m_idle)
+            rq.m_need_resched = true;
+    }
+
+    arch::x86::irq_restore(flags);
+    return woken;
+}
+
+/**
+ * @brief Wake up task sleeping in schedule_timeout().
+ *
+ * @param [in] data - given task.
+ */
+static void process_timeout(void *data) noexcept
+{
+    wake_up_process(static_cast<task_t*>(data));
+}
+
+uint32_t schedule_timeout(uint32_t timeout) noexcept
+{
+    timer_list_t timer;
+    uint32_t expires = static_cast<uint32_t>(get_jiffies()) + timeout;
+
+    timer_init(&timer, process_timeout, current());
+
+    auto flags = arch::x86::irq_save();
+
+    set_current_state(task_state::SLEEPING);
+    mod_timer(&timer, expires);
+    schedule();
+    del_timer(&timer);
+
+    arch::x86::irq_restore(flags);
+
+    int32_t left = expires - static_cast<uint32_t>(get_jiffies());
+    return left > 0 ? left : 0;
+}
+
+void yield(void) noexcept
+{
+    schedule();
+}
+
+void sched_fork(task_t *task, const char *name) noexcept
+{
+    kstd::memset(task, 0, sizeof(task_t));
+    kstd::strncpy(task->m_comm, name, TASK_COMM_LEN - 1);
+
+    auto flags    = arch::x86::irq_save();
+    task->m_pid   = next_pid++;
+    task->m_cpu   = smp_processor_id();
+    task->m_state = task_state::SLEEPING;
+    task->m_slice = SCHED_SLICE;
+    task->m_next  = task_list;
+    task_list     = task;
+    arch::x86::irq_restore(flags);
+}
+
+void ps(void) noexcept
+{
+    static const char *states[] = {"R", "S", "X"};
+
+    auto flags = arch::x86::irq_save();
+    current()->m_runtime   += clock_monotonic_ns() - current()->m_exec_start;
+    current()->m_exec_start = clock_monotonic_ns();
+    arch::x86::irq_restore(flags);
+
+    printk("%s\n", "PID  S  SWITCHES  PREEMPTED  RUNTIME  NAME");
+
+    for (task_t *task = task_list; task; task = task->m_next) {
+        printk("%u  %s  %u  %u  %u ms  %s%s\n",
+            task->m_pid, states[static_cast<uint32_t>(task->m_state)],
+            task->m_switches, task->m_preempted,
+            static_cast<uint32_t>(kstd::div_u64(task->m_runtime, NSEC_PER_MSEC)),
+            task->m_comm, task == current() ? " *" : ""
+        );
+    }
+
+    for (uint32_t cpu = 0; cpu < num_online_cpus(); cpu++) {
+        printk("CPU %u: %u context switches, %u runnable\n",
+            cpu, runqueues[cpu].m_switches, runqueues[cpu].m_nr_running
+        );
+    }
+}
+
+} // namespace core
+} // namespace kernel
@@ -17,13 +17,28 @@
  */
 
 #include <kernel/drivers/keyboard.hpp>
+#include <kernel/drivers/zram.hpp>
 #include <kernel/arch/x86/system.hpp>
 #include <kernel/arch/x86/gdt.hpp>
 #include <kernel/kstd/cstring.hpp>
 #include <kernel/kstd/cctype.hpp>
 #include <kernel/shell/shell.hpp>
+#include <kernel/clocksource.hpp>
+#include <kernel/clockevent.hpp>
+#include <kernel/mutex.hpp>
+#include <kernel/softirq.hpp>
+#include <kernel/irqtrace.hpp>
+#include <kernel/hrtimer.hpp>
+#include <kernel/timer.hpp>
+#include <kernel/tick.hpp>
+#include <kernel/irq.hpp>
+#include <kernel/mmap.hpp>
+#include <kernel/swap.hpp>
+#include <kernel/ksm.hpp>
+#include <kernel/tlb.hpp>
 #include <kernel/config.hpp>
 #include <kernel/debug.hpp>
+#include <kernel/slab.hpp>
 #include <kernel/pmm.hpp>
 
 
@@ -32,6 +47,7 @@ namespace kernel {
 void shell_t::set(void) noexcept
 {
     kstd::memset(m_buffer, 0, SHELL_BUFFER_SIZE);
+    m_arena.init(m_scratch, SHELL_SCRATCH_SIZE);
 }
 
 inline void shell_t::display_prompt(void) const noexcept
@@ -80,13 +96,43 @@ void shell_t::process(void) noexcept
         display_prompt();
         get_line();
 
-        if (m_buffer[0])
+        // background threads run while shell waits for input
+        if (m_buffer[0]) {
+            core::kernel_lock.lock();
             exec(m_buffer);
+            // command buffers are freed at once
+            m_arena.release();
+            core::kernel_lock.unlock();
+        }
 
         kstd::memset(m_buffer, 0, SHELL_BUFFER_SIZE);
     }
 }
 
+/**
+ * @brief Convert decimal string to integer.
+ *
+ * @param [in] str - given string.
+ * @return integer - in case of success.
+ * @return 0 - in case of string is not a number.
+ */
+static uint32_t parse_uint(const char *str) noexcept
+{
+    uint32_t value = 0;
+
+    if (!*str)
+        return 0;
+
+    for (; *str; str++) {
+        if (!kstd::isdigit(*str))
+            return 0;
+
+        value = value * 10 + static_cast<uint32_t>(*str - '0');
+    }
+
+    return value;
+}
+
 // TODO: move to shell builtins
 const char *mem_types[5] = {
     "available",        // available RAM to use
@@ -96,7 +142,7 @@ const char *mem_types[5] = {
     "bad RAM"           // should not be used by the OS
 };
 
-void shell_t::exec(const char *cmd) const noexcept
+void shell_t::exec(const char *cmd) noexcept
 {
     if (kstd::strncmp(cmd, "gdt", 3) == 0) {
         // while trying to get GDT info by using GDT pointer struct
@@ -108,14 +154,14 @@ void shell_t::exec(const char *cmd) const noexcept
 
         using namespace arch::x86;
 
-        gdt::ptr_t *gdt_ptr = reinterpret_cast<gdt::ptr_t*>(gdt::GDT_BASE);
+        auto gdt_ptr = static_cast<gdt::ptr_t*>(core::memory::phys_to_virt(gdt::GDT_BASE));
 
         printk("\nGDT descriptor: <%08p>\n", gdt_ptr);
         printk("offset:         <%08p>\n", gdt_ptr->m_offset);
         printk("size:             %u bytes\n", gdt_ptr->m_size);
 
         printk("\n%s\n", "kernel dump of GDT descriptor:");
-        debug::kdump(gdt::GDT_BASE, 0);
+        debug::kdump(reinterpret_cast<uint32_t>(gdt_ptr), 0);
 
         printk("\n%s\n", "kernel dump of Global Descriptor Table:");
         debug::kdump(gdt_ptr->m_offset, gdt_ptr->m_size);
@@ -134,7 +180,7 @@ void shell_t::exec(const char *cmd) const noexcept
         multiboot_entry_t *mmmt;
 
         for (size_t i = 0; i < pmm.m_mboot->mmap_length; i += sizeof(multiboot_entry_t)) {
-            mmmt = reinterpret_cast<multiboot_entry_t*>(pmm.m_mboot->mmap_addr + i);
+            mmmt = static_cast<multiboot_entry_t*>(phys_to_virt(pmm.m_mboot->mmap_addr + i));
 
             printk("%#08X-", mmmt->addr);
             printk("%#08X  ", mmmt->addr + mmmt->len - 1);
@@ -146,6 +192,83 @@ void shell_t::exec(const char *cmd) const noexcept
         printk("Total memory:       %u KB\n", pmm.m_mem_total >> 0xA);
         printk("Used memory:        %u KB\n", (pmm.m_used_pages * PAGE_SIZE) >> 0xA);
     }
+    else if (kstd::strncmp(cmd, "slabinfo", 8) == 0)
+        kmem::slabinfo();
+    else if (kstd::strncmp(cmd, "slabbench", 9) == 0)
+        debug::slab_bench(m_arena);
+    else if (kstd::strncmp(cmd, "faultstat", 9) == 0) {
+        const auto& stats = core::memory::current_mm()->m_stats;
+
+        printk("faults:       %u\n", stats.m_faults);
+        printk("anonymous:    %u\n", stats.m_anon);
+        printk("file:         %u\n", stats.m_file);
+        printk("major:        %u\n", stats.m_major);
+        printk("fault-around: %u\n", stats.m_around);
+        printk("zero page:    %u\n", stats.m_zero);
+        printk("copy-on-write: %u (%u reused)\n", stats.m_cow, stats.m_reuse);
+        printk("swap-in:      %u\n", stats.m_swapin);
+        printk("errors:       %u\n", stats.m_errors);
+    }
+    else if (kstd::strncmp(cmd, "faultbench", 10) == 0)
+        debug::fault_bench();
+    else if (kstd::strncmp(cmd, "cowbench", 8) == 0)
+        debug::cow_bench();
+    else if (kstd::strncmp(cmd, "vmabench", 8) == 0)
+        debug::vma_bench();
+    else if (kstd::strncmp(cmd, "tlbstat", 7) == 0)
+        core::memory::tlbstat();
+    else if (kstd::strncmp(cmd, "swapinfo", 8) == 0)
+        core::memory::swapinfo();
+    else if (kstd::strncmp(cmd, "swapbench", 9) == 0)
+        debug::swap_bench();
+    else if (kstd::strncmp(cmd, "zramstat", 8) == 0)
+        driver::zram.stat();
+    else if (kstd::strncmp(cmd, "irqstat", 7) == 0)
+        core::irqstat();
+    else if (kstd::strncmp(cmd, "softirqstat", 11) == 0)
+        core::softirqstat();
+    else if (kstd::strncmp(cmd, "irqtrace", 8) == 0)
+        core::irqtrace(kstd::strncmp(cmd, "irqtrace reset", 14) == 0);
+    else if (kstd::strncmp(cmd, "clocksource", 11) == 0)
+        core::clocksource_info();
+    else if (kstd::strncmp(cmd, "clockevent", 10) == 0)
+        core::clockevent_info();
+    else if (kstd::strncmp(cmd, "clockbench", 10) == 0)
+        debug::clock_bench();
+    else if (kstd::strncmp(cmd, "tickstat", 8) == 0)
+        core::tickstat();
+    else if (kstd::strncmp(cmd, "nohz on", 7) == 0)
+        core::tick_nohz_active = true;
+    else if (kstd::strncmp(cmd, "nohz off", 8) == 0)
+        core::tick_nohz_active = false;
+    else if (kstd::strncmp(cmd, "timerstat", 9) == 0)
+        core::timerstat();
+    else if (kstd::strncmp(cmd, "timerbench", 10) == 0)
+        debug::timer_bench(m_arena);
+    else if (kstd::strncmp(cmd, "hrtimerstat", 11) == 0)
+        core::hrtimerstat();
+    else if (kstd::strncmp(cmd, "hrbench", 7) == 0)
+        debug::hrtimer_bench();
+    else if (kstd::strncmp(cmd, "ps", 2) == 0)
+        core::ps();
+    else if (kstd::strncmp(cmd, "schedbench", 10) == 0)
+        debug::sched_bench();
+    else if (kstd::strncmp(cmd, "ksmstat", 7) == 0)
+        core::memory::ksmstat();
+    else if (kstd::strncmp(cmd, "ksmbench", 8) == 0)
+        debug::ksm_bench();
+    else if (kstd::strncmp(cmd, "ksm on", 6) == 0)
+        core::memory::ksm_set_run(true);
+    else if (kstd::strncmp(cmd, "ksm off", 7) == 0)
+        core::memory::ksm_set_run(false);
+    else if (kstd::strncmp(cmd, "ksm scan ", 9) == 0) {
+        uint32_t pages = parse_uint(cmd + 9);
+
+        if (pages)
+            core::memory::ksm_pages_to_scan = pages;
+        else
+            printk("%s\n", "ksm: invalid number of pages");
+    }
     else
         printk("sh: %s: command not found \n", cmd);
 }
@@ -0,0 +1,344 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/system.hpp>
+#include <kernel/arch/x86/cpuid.hpp>
+#include <kernel/arch/x86/apic.hpp>
+#include <kernel/arch/x86/pit.hpp>
+#include <kernel/arch/x86/tsc.hpp>
+#include <kernel/arch/x86/idt.hpp>
+#include <kernel/clocksource.hpp>
+#include <kernel/clockevent.hpp>
+#include <kernel/printk.hpp>
+#include <kernel/irq.hpp>
+
+
+namespace kernel {
+namespace core {
+
+inline const uint32_t PROGRAM_RETRIES {3};  // attempts to program the shortest delta
+inline const uint32_t CALIBRATE_MS    {10}; // local APIC timer measurement length
+
+inline const uint32_t LAPIC_MIN_TICKS {0xF};
+inline const uint32_t LAPIC_MAX_TICKS {0x7FFFFFFF};
+
+inline const uint32_t PIT_MIN_TICKS {0xF};
+inline const uint32_t PIT_MAX_TICKS {0x7FFF};   // about 27 ms
+
+clockevent_t *clockevent      {nullptr};
+clockevent_t *clockevent_list {nullptr};
+
+static uint32_t lapic_timer_mode {arch::x86::apic::LVT_MASKED};   // LVT timer mode
+
+/**
+ * @brief Set local APIC timer mode unless it is already set.
+ *
+ * @param [in] mode - given LVT timer mode.
+ */
+static void lapic_timer_set_mode(uint32_t mode) noexcept
+{
+    using namespace arch::x86;
+
+    if (lapic_timer_mode == mode)
+        return;
+
+    lapic_timer_mode = mode;
+    apic::lapic_write(apic::LAPIC_LVT_TIMER, idt::VEC_LAPIC_TIMER | mode);
+
+    // deadline MSR write must not be reordered before LVT write
+    if (mode == apic::LVT_TIMER_DEADLINE)
+        __asm__ volatile("mfence" : : : "memory");
+}
+
+static bool lapic_set_next_event(uint32_t ticks) noexcept
+{
+    lapic_timer_set_mode(arch::x86::apic::LVT_TIMER_ONESHOT);
+    arch::x86::apic::lapic_write(arch::x86::apic::LAPIC_TIMER_ICR, ticks);
+
+    // countdown cannot be missed
+    return true;
+}
+
+static bool lapic_set_periodic(uint32_t ticks) noexcept
+{
+    lapic_timer_set_mode(arch::x86::apic::LVT_TIMER_PERIODIC);
+    arch::x86::apic::lapic_write(arch::x86::apic::LAPIC_TIMER_ICR, ticks);
+
+    return true;
+}
+
+static void lapic_shutdown(void) noexcept
+{
+    using namespace arch::x86;
+
+    lapic_timer_mode = apic::LVT_MASKED;
+    apic::lapic_write(apic::LAPIC_LVT_TIMER, apic::LVT_MASKED);
+    apic::lapic_write(apic::LAPIC_TIMER_ICR, 0);
+}
+
+static bool deadline_set_next_event(uint32_t ticks) noexcept
+{
+    lapic_timer_set_mode(arch::x86::apic::LVT_TIMER_DEADLINE);
+
+    // deadline in the past raises interrupt immediately
+    arch::x86::wrmsr(arch::x86::apic::MSR_TSC_DEADLINE, arch::x86::rdtsc() + ticks);
+    return true;
+}
+
+static void deadline_shutdown(void) noexcept
+{
+    arch::x86::wrmsr(arch::x86::apic::MSR_TSC_DEADLINE, 0);
+}
+
+static clockevent_t lapic_clockevent {
+    "lapic", CLOCK_EVT_ONESHOT | CLOCK_EVT_PERIODIC, RATING_EVT_LAPIC, 0,
+    LAPIC_MIN_TICKS, LAPIC_MAX_TICKS, 0, 0, 0, 0, 0, nullptr,
+    lapic_set_next_event, lapic_set_periodic, lapic_shutdown, nullptr
+};
+
+static clockevent_t deadline_clockevent {
+    "tsc-deadline", CLOCK_EVT_ONESHOT, RATING_EVT_TSC_DEADLINE, 0,
+    LAPIC_MIN_TICKS, LAPIC_MAX_TICKS, 0, 0, 0, 0, 0, nullptr,
+    deadline_set_next_event, nullptr, deadline_shutdown, nullptr
+};
+
+static bool pit_set_next_event(uint32_t ticks) noexcept
+{
+    arch::x86::pit::set_oneshot(ticks);
+    return true;
+}
+
+static bool pit_set_periodic(uint32_t ticks) noexcept
+{
+    arch::x86::pit::set_periodic(ticks);
+    return true;
+}
+
+static void pit_shutdown(void) noexcept
+{
+    arch::x86::pit::stop();
+}
+
+static clockevent_t pit_clockevent {
+    "pit", CLOCK_EVT_ONESHOT | CLOCK_EVT_PERIODIC, RATING_EVT_PIT, arch::x86::pit::FREQUENCY / 1000,
+    PIT_MIN_TICKS, PIT_MAX_TICKS, 0, 0, 0, 0, 0, nullptr,
+    pit_set_next_event, pit_set_periodic, pit_shutdown, nullptr
+};
+
+/**
+ * @brief Handle PIT channel 0 interrupt.
+ *
+ * @param [in] irq - given IRQ line.
+ * @param [in] dev - given unused device.
+ */
+static void pit_timer_irq(uint32_t irq, void *dev) noexcept
+{
+    (void)irq;
+    (void)dev;
+
+    clockevent_handle(pit_clockevent);
+}
+
+/**
+ * @brief Register PIT as clockevent if there is no other device.
+ *
+ * @details PIT counter is no longer free-running, so PIT clocksource
+ * must not be in use.
+ */
+static void pit_clockevent_init(void) noexcept
+{
+    if (clockevent || !clocksource || clocksource->m_rating == RATING_PIT)
+        return;
+
+    arch::x86::pit::stop();
+
+    if (request_irq(arch::x86::pit::IRQ, pit_timer_irq, "pit", nullptr))
+        clockevent_register(pit_clockevent);
+}
+
+/**
+ * @brief Handle local APIC timer interrupt.
+ *
+ * @param [in] regs - given saved registers.
+ */
+static void lapic_timer_interrupt(arch::x86::idt::regs_t *regs) noexcept
+{
+    (void)regs;
+
+    bool deadline = lapic_timer_mode == arch::x86::apic::LVT_TIMER_DEADLINE;
+
+    arch::x86::apic::lapic_eoi();
+    clockevent_handle(deadline ? deadline_clockevent : lapic_clockevent);
+}
+
+/**
+ * @brief Measure local APIC timer frequency against clocksource.
+ *
+ * @return timer frequency in kHz.
+ */
+static uint32_t lapic_timer_calibrate(void) noexcept
+{
+    using namespace arch::x86;
+
+    apic::lapic_write(apic::LAPIC_LVT_TIMER, apic::LVT_MASKED);
+    apic::lapic_write(apic::LAPIC_TIMER_DCR, apic::TIMER_DIV_16);
+    apic::lapic_write(apic::LAPIC_TIMER_ICR, 0xFFFFFFFF);
+
+    uint64_t start = clock_monotonic_ns();
+    uint64_t elapsed;
+
+    while ((elapsed = clock_monotonic_ns() - start) < CALIBRATE_MS * NSEC_PER_MSEC)
+        ;
+
+    uint32_t ticks = 0xFFFFFFFF - apic::lapic_read(apic::LAPIC_TIMER_CCR);
+    apic::lapic_write(apic::LAPIC_TIMER_ICR, 0);
+
+    return kstd::div_u64(static_cast<uint64_t>(ticks) * NSEC_PER_MSEC, static_cast<uint32_t>(elapsed));
+}
+
+/**
+ * @brief Convert ticks of device to nanoseconds.
+ *
+ * @param [in] evt - given device.
+ * @param [in] ticks - given number of ticks.
+ * @return number of nanoseconds.
+ */
+static uint64_t ticks_to_ns(const clockevent_t& evt, uint32_t ticks) noexcept
+{
+    return kstd::div_u64(static_cast<uint64_t>(ticks) * NSEC_PER_MSEC, evt.m_khz);
+}
+
+/**
+ * @brief Convert nanoseconds to ticks of device.
+ *
+ * @param [in] evt - given device.
+ * @param [in] ns - given number of nanoseconds.
+ * @return number of ticks within device limits.
+ */
+static uint32_t ns_to_ticks(const clockevent_t& evt, uint64_t ns) noexcept
+{
+    // product of far deadline would not fit in 64 bits
+    if (ns >= evt.m_max_delta_ns)
+        return evt.m_max_ticks;
+
+    uint64_t ticks = kstd::mul_u64_u32_shr(ns, evt.m_mult, evt.m_shift);
+
+    if (ticks < evt.m_min_ticks)
+        return evt.m_min_ticks;
+
+    return ticks > evt.m_max_ticks ? evt.m_max_ticks : ticks;
+}
+
+void clockevent_init(void) noexcept
+{
+    using namespace arch::x86;
+
+    // local APIC is not enabled without I/O APIC
+    if (!apic::lapic || !clocksource) {
+        pit_clockevent_init();
+        return;
+    }
+
+    idt::set_handler(idt::VEC_LAPIC_TIMER, lapic_timer_interrupt);
+
+    if (tsc_khz && (cpuid(0x1).m_ecx & CPUID_ECX_TSC_DEADLINE)) {
+        deadline_clockevent.m_khz = tsc_khz;
+        clockevent_register(deadline_clockevent);
+        return;
+    }
+
+    lapic_clockevent.m_khz = lapic_timer_calibrate();
+
+    if (lapic_clockevent.m_khz)
+        clockevent_register(lapic_clockevent);
+    else
+        pit_clockevent_init();
+}
+
+void clockevent_register(clockevent_t& evt) noexcept
+{
+    // 10^6 ns per ms to kHz
+    clocks_calc_mult_shift(evt.m_mult, evt.m_shift, NSEC_PER_MSEC, evt.m_khz);
+
+    evt.m_min_delta_ns = ticks_to_ns(evt, evt.m_min_ticks);
+    evt.m_max_delta_ns = ticks_to_ns(evt, evt.m_max_ticks);
+    evt.m_events       = 0;
+
+    auto flags      = arch::x86::irq_save();
+    evt.m_next      = clockevent_list;
+    clockevent_list = &evt;
+
+    if (!clockevent || evt.m_rating > clockevent->m_rating)
+        clockevent = &evt;
+
+    arch::x86::irq_restore(flags);
+}
+
+bool clockevent_program(clockevent_t& evt, uint64_t delta_ns) noexcept
+{
+    if (evt.m_set_next_event(ns_to_ticks(evt, delta_ns)))
+        return true;
+
+    // deadline has passed while device was programmed
+    for (uint32_t i = 0; i < PROGRAM_RETRIES; i++) {
+        if (evt.m_set_next_event(evt.m_min_ticks))
+            return true;
+    }
+
+    return false;
+}
+
+bool clockevent_set_periodic(clockevent_t& evt, uint64_t period_ns) noexcept
+{
+    if (!(evt.m_features & CLOCK_EVT_PERIODIC))
+        return false;
+
+    return evt.m_set_periodic(ns_to_ticks(evt, period_ns));
+}
+
+void clockevent_shutdown(clockevent_t& evt) noexcept
+{
+    evt.m_shutdown();
+}
+
+void clockevent_handle(clockevent_t& evt) noexcept
+{
+    evt.m_events++;
+
+    if (evt.m_handler)
+        evt.m_handler(evt);
+}
+
+void clockevent_info(void) noexcept
+{
+    for (auto evt = clockevent_list; evt; evt = evt->m_next) {
+        printk("%s%s: rating %u, %u kHz, %s%s, events %u\n",
+            evt == clockevent ? "*" : " ", evt->m_name, evt->m_rating, evt->m_khz,
+            evt->m_features & CLOCK_EVT_ONESHOT ? "oneshot " : "",
+            evt->m_features & CLOCK_EVT_PERIODIC ? "periodic" : "", evt->m_events
+        );
+
+        printk("  delta: %u - %u us\n",
+            static_cast<uint32_t>(kstd::div_u64(evt->m_min_delta_ns, NSEC_PER_USEC)),
+            static_cast<uint32_t>(kstd::div_u64(evt->m_max_delta_ns, NSEC_PER_USEC))
+        );
+    }
+}
+
+} // namespace core
+} // namespace kernel
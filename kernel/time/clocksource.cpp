@@ -0,0 +1,229 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/system.hpp>
+#include <kernel/arch/x86/cpuid.hpp>
+#include <kernel/arch/x86/tsc.hpp>
+#include <kernel/arch/x86/pit.hpp>
+#include <kernel/clocksource.hpp>
+#include <kernel/printk.hpp>
+
+
+namespace kernel {
+namespace core {
+
+inline const uint32_t CALIBRATE_RUNS {5};   // median of runs is taken
+inline const uint32_t CALIBRATE_MS   {10};  // countdown length of each run
+
+// longest calibration against clocksource
+inline const uint32_t CALIBRATE_SPIN {10000000};
+
+clocksource_t *clocksource      {nullptr};
+clocksource_t *clocksource_list {nullptr};
+uint32_t       tsc_khz          {0};
+
+static const char *tsc_reference {nullptr};  // calibration clock name
+static uint64_t    cycle_last    {0};        // counter value at last read
+static uint64_t    cycle_total   {0};        // cycles accumulated by narrow counter
+static uint64_t    base_ns       {0};        // time of clocksource switch
+
+static uint64_t pit_read(void) noexcept
+{
+    return arch::x86::pit::read();
+}
+
+static uint64_t tsc_read(void) noexcept
+{
+    return arch::x86::rdtsc();
+}
+
+static clocksource_t pit_clocksource {
+    "pit", RATING_PIT, arch::x86::pit::FREQUENCY / 1000, 0xFFFF, 0, 0, nullptr, pit_read
+};
+
+static clocksource_t tsc_clocksource {
+    "tsc", RATING_TSC, 0, CLOCKSOURCE_MASK_64, 0, 0, nullptr, tsc_read
+};
+
+/**
+ * @brief Measure TSC frequency against clocksource.
+ *
+ * @param [in] ref - given reference clocksource.
+ * @param [in] ms - given measurement length in milliseconds.
+ * @return TSC frequency in kHz.
+ * @return 0 - if clocksource does not tick.
+ */
+static uint32_t calibrate_tsc_ref(const clocksource_t& ref, uint32_t ms) noexcept
+{
+    uint64_t ticks = static_cast<uint64_t>(ref.m_khz) * ms;
+    uint64_t delta = 0;
+    uint32_t spin  = 0;
+    auto     flags = arch::x86::irq_save();
+
+    uint64_t ref_start = ref.m_read();
+    uint64_t start     = arch::x86::rdtsc();
+
+    while (delta < ticks && ++spin < CALIBRATE_SPIN)
+        delta = (ref.m_read() - ref_start) & ref.m_mask;
+
+    uint64_t cycles = arch::x86::rdtsc() - start;
+    arch::x86::irq_restore(flags);
+
+    if (spin == CALIBRATE_SPIN)
+        return 0;
+
+    return kstd::div_u64(cycles * ref.m_khz, static_cast<uint32_t>(delta));
+}
+
+/**
+ * @brief Measure TSC frequency.
+ *
+ * @details Runs are disturbed by SMIs & virtual machine exits, so
+ * median of several short runs is used.
+ *
+ * @return TSC frequency in kHz (0 - calibration failed).
+ */
+static uint32_t calibrate_tsc(void) noexcept
+{
+    uint32_t khz[CALIBRATE_RUNS];
+
+    // PIT clocksource wraps too often, its channel 2 is used instead
+    bool pit      = clocksource == &pit_clocksource;
+    tsc_reference = pit ? "pit" : clocksource->m_name;
+
+    for (uint32_t i = 0; i < CALIBRATE_RUNS; i++) {
+        uint32_t value = pit ? arch::x86::pit::calibrate_tsc(CALIBRATE_MS)
+                             : calibrate_tsc_ref(*clocksource, CALIBRATE_MS);
+        uint32_t j     = i;
+
+        // insertion sort
+        for (; j > 0 && khz[j - 1] > value; j--)
+            khz[j] = khz[j - 1];
+
+        khz[j] = value;
+    }
+
+    return khz[CALIBRATE_RUNS / 2];
+}
+
+void clocks_calc_mult_shift(uint32_t& mult, uint32_t& shift, uint32_t from, uint32_t to) noexcept
+{
+    uint64_t tmp;
+
+    for (shift = 32; (tmp = kstd::div_u64(static_cast<uint64_t>(to) << shift, from)) > 0xFFFFFFFF; shift--)
+        ;
+
+    mult = tmp;
+}
+
+void clocksource_init(void) noexcept
+{
+    arch::x86::pit::init();
+    clocksource_register(pit_clocksource);
+
+    if (!arch::x86::has_feature(arch::x86::CPUID_EDX_TSC))
+        return;
+
+    tsc_khz = calibrate_tsc();
+
+    if (!tsc_khz) {
+        printk(KERN_ERR "%s\n", "TSC calibration failed");
+        return;
+    }
+
+    tsc_clocksource.m_khz = tsc_khz;
+
+    if (!arch::x86::tsc_invariant())
+        tsc_clocksource.m_rating = RATING_TSC_UNSTABLE;
+
+    clocksource_register(tsc_clocksource);
+}
+
+void clocksource_register(clocksource_t& cs) noexcept
+{
+    // kHz to 10^6 ns per ms
+    clocks_calc_mult_shift(cs.m_mult, cs.m_shift, cs.m_khz, NSEC_PER_MSEC);
+
+    auto flags       = arch::x86::irq_save();
+    cs.m_next        = clocksource_list;
+    clocksource_list = &cs;
+
+    if (!clocksource || cs.m_rating > clocksource->m_rating) {
+        // new clock continues from current time
+        base_ns     = clock_monotonic_ns();
+        cycle_last  = cs.m_read();
+        cycle_total = 0;
+        clocksource = &cs;
+    }
+
+    arch::x86::irq_restore(flags);
+}
+
+uint64_t clock_monotonic_ns(void) noexcept
+{
+    auto cs = clocksource;
+
+    if (!cs)
+        return 0;
+
+    // full width counter does not wrap, so it is read without locking
+    if (cs->m_mask == CLOCKSOURCE_MASK_64)
+        return base_ns + clocksource_cyc2ns(*cs, cs->m_read() - cycle_last);
+
+    auto     flags = arch::x86::irq_save();
+    uint64_t now   = cs->m_read();
+
+    cycle_total += (now - cycle_last) & cs->m_mask;
+    cycle_last   = now;
+
+    uint64_t ns = base_ns + clocksource_cyc2ns(*cs, cycle_total);
+    arch::x86::irq_restore(flags);
+
+    return ns;
+}
+
+uint64_t clocksource_max_idle_ns(void) noexcept
+{
+    auto cs = clocksource;
+
+    if (!cs || cs->m_mask == CLOCKSOURCE_MASK_64)
+        return KTIME_MAX;
+
+    // half of wrap period leaves margin for late wakeup
+    return clocksource_cyc2ns(*cs, cs->m_mask >> 1);
+}
+
+void clocksource_info(void) noexcept
+{
+    for (auto cs = clocksource_list; cs; cs = cs->m_next) {
+        printk("%s%s: rating %u, %u kHz, mult %u, shift %u\n",
+            cs == clocksource ? "*" : " ", cs->m_name, cs->m_rating,
+            cs->m_khz, cs->m_mult, cs->m_shift
+        );
+    }
+
+    uint64_t ns = clock_monotonic_ns();
+    printk("\nuptime: %u ms\n", static_cast<uint32_t>(kstd::div_u64(ns, NSEC_PER_MSEC)));
+    printk("invariant TSC: %s\n", arch::x86::tsc_invariant() ? "yes" : "no");
+
+    if (tsc_khz)
+        printk("TSC calibrated against %s\n", tsc_reference);
+}
+
+} // namespace core
+} // namespace kernel
@@ -0,0 +1,325 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file  hrtimer.cpp
+ * @brief Contains per-CPU high-resolution timers implementation.
+ *
+ * @author Alexander Kuzin (<a href="https://github.com/alkuzin">alkuzin</a>)
+ * @date   19.10.2026
+ */
+
+#include <kernel/arch/x86/system.hpp>
+#include <kernel/clocksource.hpp>
+#include <kernel/hrtimer.hpp>
+#include <kernel/printk.hpp>
+
+
+namespace kernel {
+namespace core {
+
+inline const uint32_t HRTIMER_RETRIES {3};   // attempts to catch up with timers expired while running
+
+percpu_t<hrtimer_stats_t>       hrtimer_stats;
+static percpu_t<hrtimer_base_t> hrtimer_bases;
+
+/**
+ * @brief Check whether hrtimers own clockevent device.
+ *
+ * @return true - if device may be programmed.
+ * @return false - otherwise.
+ */
+static inline bool hrtimer_device_owned(void) noexcept
+{
+    return clockevent && clockevent->m_handler == hrtimer_interrupt;
+}
+
+/**
+ * @brief Get the earliest expiry of base.
+ *
+ * @param [in] base - given timer base.
+ * @return expiry of leftmost timer (KTIME_MAX - no timers).
+ */
+static inline uint64_t hrtimer_next_expiry(const hrtimer_base_t& base) noexcept
+{
+    auto node = base.m_active.first();
+    return node ? rb_entry(node, hrtimer_t, m_node)->m_expires : KTIME_MAX;
+}
+
+/**
+ * @brief Insert timer into tree ordered by expiry.
+ *
+ * @details Timers with equal expiry are run in order they were queued.
+ *
+ * @param [in] base - given timer base.
+ * @param [in] timer - given timer that is not queued.
+ */
+static void enqueue_hrtimer(hrtimer_base_t& base, hrtimer_t *timer) noexcept
+{
+    kstd::rb_node_t **link  = &base.m_active.m_root.m_node;
+    kstd::rb_node_t *parent = nullptr;
+    bool leftmost           = true;
+
+    while (*link) {
+        parent = *link;
+
+        if (timer->m_expires < rb_entry(parent, hrtimer_t, m_node)->m_expires)
+            link = &parent->m_left;
+        else {
+            link     = &parent->m_right;
+            leftmost = false;
+        }
+    }
+
+    base.m_active.insert(&timer->m_node, parent, link, leftmost);
+    timer->m_state |= HRTIMER_ENQUEUED;
+}
+
+/**
+ * @brief Remove timer from tree.
+ *
+ * @param [in] base - given timer base.
+ * @param [in] timer - given queued timer.
+ */
+static void remove_hrtimer(hrtimer_base_t& base, hrtimer_t *timer) noexcept
+{
+    base.m_active.erase(&timer->m_node);
+    timer->m_state &= ~HRTIMER_ENQUEUED;
+}
+
+/**
+ * @brief Program device for the earliest timer if it has changed.
+ *
+ * @param [in] base - given timer base of current CPU.
+ */
+static void hrtimer_reprogram(hrtimer_base_t& base) noexcept
+{
+    // interrupt handler programs device after running timers
+    if (base.m_in_interrupt || !hrtimer_device_owned())
+        return;
+
+    uint64_t next = hrtimer_next_expiry(base);
+
+    if (next == base.m_next_event)
+        return;
+
+    base.m_next_event = next;
+    hrtimer_stats.this_cpu().m_reprograms++;
+
+    if (next == KTIME_MAX) {
+        clockevent_shutdown(*clockevent);
+        return;
+    }
+
+    uint64_t now = clock_monotonic_ns();
+    clockevent_program(*clockevent, next > now ? next - now : 0);
+}
+
+/**
+ * @brief Run functions of expired timers.
+ *
+ * @param [in] base - given timer base of current CPU.
+ * @param [in] now - given current time.
+ */
+static void hrtimer_run_queues(hrtimer_base_t& base, uint64_t now) noexcept
+{
+    hrtimer_stats_t& stats = hrtimer_stats.this_cpu();
+    kstd::rb_node_t *node;
+
+    while ((node = base.m_active.first())) {
+        auto timer = rb_entry(node, hrtimer_t, m_node);
+
+        if (timer->m_expires > now)
+            break;
+
+        if (now - timer->m_expires > stats.m_max_late)
+            stats.m_max_late = now - timer->m_expires;
+
+        remove_hrtimer(base, timer);
+        timer->m_state |= HRTIMER_CALLBACK;
+        stats.m_expired++;
+
+        auto restart = timer->m_func(timer);
+
+        // function may have restarted or cancelled timer itself
+        if (restart == hrtimer_restart::RESTART && !(timer->m_state & HRTIMER_ENQUEUED))
+            enqueue_hrtimer(base, timer);
+
+        timer->m_state &= ~HRTIMER_CALLBACK;
+    }
+}
+
+bool hrtimers_init(void) noexcept
+{
+    if (!clockevent)
+        return false;
+
+    for (uint32_t cpu = 0; cpu < NR_CPUS; cpu++)
+        hrtimer_bases[cpu].m_next_event = KTIME_MAX;
+
+    auto flags            = arch::x86::irq_save();
+    clockevent->m_handler = hrtimer_interrupt;
+    clockevent_shutdown(*clockevent);
+    arch::x86::irq_restore(flags);
+
+    return true;
+}
+
+void hrtimer_init(hrtimer_t *timer, hrtimer_restart (*func)(hrtimer_t *timer) noexcept) noexcept
+{
+    timer->m_node    = {};
+    timer->m_expires = 0;
+    timer->m_cpu     = smp_processor_id();
+    timer->m_state   = HRTIMER_INACTIVE;
+    timer->m_func    = func;
+}
+
+bool hrtimer_start(hrtimer_t *timer, uint64_t time, hrtimer_mode mode) noexcept
+{
+    auto flags  = arch::x86::irq_save();
+    bool queued = timer->m_state & HRTIMER_ENQUEUED;
+
+    if (mode == hrtimer_mode::REL) {
+        uint64_t now = clock_monotonic_ns();
+        time         = time < KTIME_MAX - now ? now + time : KTIME_MAX;
+    }
+
+    if (queued)
+        remove_hrtimer(hrtimer_bases[timer->m_cpu], timer);
+
+    hrtimer_base_t& base = hrtimer_bases.this_cpu();
+    timer->m_cpu         = smp_processor_id();
+    timer->m_expires     = time;
+
+    enqueue_hrtimer(base, timer);
+    hrtimer_stats.this_cpu().m_started++;
+    hrtimer_reprogram(base);
+
+    arch::x86::irq_restore(flags);
+    return queued;
+}
+
+bool hrtimer_cancel(hrtimer_t *timer) noexcept
+{
+    auto flags  = arch::x86::irq_save();
+    bool queued = timer->m_state & HRTIMER_ENQUEUED;
+
+    if (queued) {
+        remove_hrtimer(hrtimer_bases[timer->m_cpu], timer);
+        hrtimer_stats[timer->m_cpu].m_cancelled++;
+
+        // device of other CPU fires early & finds nothing to run
+        if (timer->m_cpu == smp_processor_id())
+            hrtimer_reprogram(hrtimer_bases[timer->m_cpu]);
+    }
+
+    arch::x86::irq_restore(flags);
+    return queued;
+}
+
+uint32_t hrtimer_forward(hrtimer_t *timer, uint64_t now, uint64_t interval) noexcept
+{
+    if (now < timer->m_expires || !interval)
+        return 0;
+
+    uint64_t overruns = 0;
+
+    if (interval >> 32) {
+        // long periods are rarely overrun more than once
+        while (timer->m_expires <= now) {
+            timer->m_expires += interval;
+            overruns++;
+        }
+    }
+    else {
+        overruns          = kstd::div_u64(now - timer->m_expires, interval) + 1;
+        timer->m_expires += overruns * interval;
+    }
+
+    return overruns;
+}
+
+uint64_t hrtimer_get_remaining(const hrtimer_t *timer) noexcept
+{
+    uint64_t now = clock_monotonic_ns();
+    return timer->m_expires > now ? timer->m_expires - now : 0;
+}
+
+void hrtimer_interrupt(clockevent_t& evt) noexcept
+{
+    hrtimer_base_t& base = hrtimer_bases.this_cpu();
+    uint64_t now         = clock_monotonic_ns();
+    uint64_t next;
+
+    hrtimer_stats.this_cpu().m_interrupts++;
+    base.m_in_interrupt = true;
+
+    for (uint32_t retries = 0;; retries++) {
+        hrtimer_run_queues(base, now);
+        next = hrtimer_next_expiry(base);
+
+        if (next == KTIME_MAX)
+            break;
+
+        now = clock_monotonic_ns();
+
+        // device fires as soon as it can if timers keep expiring
+        if (next > now || retries == HRTIMER_RETRIES)
+            break;
+    }
+
+    base.m_in_interrupt = false;
+    base.m_next_event   = next;
+    hrtimer_stats.this_cpu().m_reprograms++;
+
+    if (next == KTIME_MAX)
+        clockevent_shutdown(evt);
+    else
+        clockevent_program(evt, next > now ? next - now : 0);
+}
+
+void hrtimerstat(void) noexcept
+{
+    printk("clockevent: %s%s\n",
+        clockevent ? clockevent->m_name : "none",
+        hrtimer_device_owned() ? "" : " (not owned)"
+    );
+
+    for (uint32_t cpu = 0; cpu < num_online_cpus(); cpu++) {
+        const hrtimer_stats_t& stats = hrtimer_stats[cpu];
+        uint64_t next                = hrtimer_bases[cpu].m_next_event;
+        uint64_t now                 = clock_monotonic_ns();
+
+        printk("CPU %u: %u started, %u cancelled, %u expired, %u interrupts, %u reprograms\n",
+            cpu, stats.m_started, stats.m_cancelled, stats.m_expired,
+            stats.m_interrupts, stats.m_reprograms
+        );
+
+        printk("  max late: %u ns, next event: ",
+            static_cast<uint32_t>(stats.m_max_late)
+        );
+
+        if (next == KTIME_MAX)
+            printk("%s\n", "none");
+        else
+            printk("in %u us\n", static_cast<uint32_t>(kstd::div_u64(next > now ? next - now : 0, NSEC_PER_USEC)));
+    }
+}
+
+} // namespace core
+} // namespace kernel
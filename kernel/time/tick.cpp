@@ -0,0 +1,191 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/clockevent.hpp>
+#include <kernel/printk.hpp>
+#include <kernel/sched.hpp>
+#include <kernel/timer.hpp>
+#include <kernel/tick.hpp>
+
+
+namespace kernel {
+namespace core {
+
+inline const uint32_t RATE_SAMPLE_MS {1000};  // wakeups per second sampling period
+
+volatile uint64_t      jiffies          {0};
+bool                   tick_nohz_active {true};
+percpu_t<tick_sched_t> tick_sched;
+
+/**
+ * @brief Update ticks since boot.
+ *
+ * @details Ticks are not counted while idle CPU has its tick stopped,
+ * so jiffies are derived from monotonic clock.
+ *
+ * @param [in] now - given current time.
+ */
+static void tick_update_jiffies(uint64_t now) noexcept
+{
+    jiffies = kstd::div_u64(now, TICK_NSEC);
+}
+
+/**
+ * @brief Start tick timer for the next tick.
+ *
+ * @param [in] ts - given tick state.
+ */
+static void tick_program_next(tick_sched_t& ts) noexcept
+{
+    ts.m_next_tick = (jiffies + 1) * TICK_NSEC;
+    hrtimer_start(&ts.m_timer, ts.m_next_tick, hrtimer_mode::ABS);
+}
+
+/**
+ * @brief Handle tick.
+ *
+ * @param [in] timer - given tick timer.
+ * @return whether tick timer is restarted.
+ */
+static hrtimer_restart tick_sched_timer(hrtimer_t *timer) noexcept
+{
+    tick_sched_t& ts = tick_sched[smp_processor_id()];
+    uint64_t now     = clock_monotonic_ns();
+
+    ts.m_ticks++;
+    tick_update_jiffies(now);
+    run_local_timers();
+    scheduler_tick();
+
+    // idle CPU was woken up to keep clocksource from wrapping
+    if (ts.m_stopped)
+        return hrtimer_restart::NORESTART;
+
+    // ticks missed while interrupts were disabled are skipped
+    hrtimer_forward(timer, now, TICK_NSEC);
+    ts.m_next_tick = timer->m_expires;
+
+    return hrtimer_restart::RESTART;
+}
+
+bool tick_init(void) noexcept
+{
+    if (!clockevent || clockevent->m_handler != hrtimer_interrupt)
+        return false;
+
+    tick_sched_t& ts = tick_sched[smp_processor_id()];
+    auto flags       = arch::x86::irq_save();
+    uint64_t now     = clock_monotonic_ns();
+
+    hrtimer_init(&ts.m_timer, tick_sched_timer);
+    ts.m_rate_start = now;
+
+    tick_update_jiffies(now);
+    tick_program_next(ts);
+
+    arch::x86::irq_restore(flags);
+    return true;
+}
+
+void tick_nohz_idle_enter(void) noexcept
+{
+    tick_sched_t& ts = tick_sched[smp_processor_id()];
+    ts.m_idle_start  = clock_monotonic_ns();
+
+    if (!tick_nohz_active || !clockevent || clockevent->m_handler != hrtimer_interrupt)
+        return;
+
+    uint64_t sleep = clocksource_max_idle_ns();
+    uint64_t expires;
+
+    if (next_timer_expiry(expires)) {
+        uint64_t next = expires * TICK_NSEC;
+
+        // timer is due at the next tick anyway
+        if (next <= ts.m_next_tick)
+            return;
+
+        if (next - ts.m_idle_start < sleep)
+            sleep = next - ts.m_idle_start;
+    }
+
+    ts.m_stopped = true;
+
+    // device is programmed for the earliest of tick & other hrtimers
+    if (sleep == KTIME_MAX)
+        hrtimer_cancel(&ts.m_timer);
+    else
+        hrtimer_start(&ts.m_timer, ts.m_idle_start + sleep, hrtimer_mode::ABS);
+}
+
+void tick_nohz_idle_exit(void) noexcept
+{
+    tick_sched_t& ts = tick_sched[smp_processor_id()];
+    uint64_t now     = clock_monotonic_ns();
+
+    ts.m_idle_ns += now - ts.m_idle_start;
+    ts.m_wakeups++;
+
+    uint32_t elapsed_ms = kstd::div_u64(now - ts.m_rate_start, NSEC_PER_MSEC);
+
+    if (elapsed_ms >= RATE_SAMPLE_MS) {
+        ts.m_rate         = (ts.m_wakeups - ts.m_rate_wakeups) * 1000 / elapsed_ms;
+        ts.m_rate_wakeups = ts.m_wakeups;
+        ts.m_rate_start   = now;
+    }
+
+    if (!ts.m_stopped)
+        return;
+
+    ts.m_stopped = false;
+    tick_update_jiffies(now);
+    tick_program_next(ts);
+}
+
+void cpu_idle(void) noexcept
+{
+    tick_nohz_idle_enter();
+    arch::x86::safe_halt();
+
+    // wakeup interrupt has been handled
+    arch::x86::irq_disable();
+    tick_nohz_idle_exit();
+    arch::x86::irq_enable();
+}
+
+void tickstat(void) noexcept
+{
+    uint32_t uptime_ms = kstd::div_u64(clock_monotonic_ns(), NSEC_PER_MSEC);
+
+    printk("HZ: %u, NO_HZ idle: %s, clockevent: %s\n",
+        HZ, tick_nohz_active ? "on" : "off", clockevent ? clockevent->m_name : "none"
+    );
+    printk("jiffies: %u\n", static_cast<uint32_t>(get_jiffies()));
+
+    for (uint32_t cpu = 0; cpu < num_online_cpus(); cpu++) {
+        const tick_sched_t& ts = tick_sched[cpu];
+        uint32_t idle_ms       = kstd::div_u64(ts.m_idle_ns, NSEC_PER_MSEC);
+
+        printk("CPU %u: %u ticks, %u wakeups (%u/s), idle %u of %u ms\n",
+            cpu, ts.m_ticks, ts.m_wakeups, ts.m_rate, idle_ms, uptime_ms
+        );
+    }
+}
+
+} // namespace core
+} // namespace kernel
@@ -0,0 +1,355 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/arch/x86/system.hpp>
+#include <kernel/softirq.hpp>
+#include <kernel/printk.hpp>
+#include <kernel/bitops.hpp>
+#include <kernel/timer.hpp>
+#include <kernel/tick.hpp>
+
+
+namespace kernel {
+namespace core {
+
+percpu_t<timer_stats_t>       timer_stats;
+static percpu_t<timer_base_t> timer_bases;
+
+/**
+ * @brief Check whether jiffy a is after or equal to jiffy b.
+ *
+ * @details Comparison is correct across 32-bit counter wrap around.
+ *
+ * @param [in] a - given jiffy.
+ * @param [in] b - given jiffy.
+ * @return true - if a is not before b.
+ * @return false - otherwise.
+ */
+static inline bool time_after_eq(uint32_t a, uint32_t b) noexcept
+{
+    return static_cast<int32_t>(a - b) >= 0;
+}
+
+/**
+ * @brief Get slot index of cascading level.
+ *
+ * @param [in] jiffy - given jiffy.
+ * @param [in] level - given cascading level.
+ * @return slot index.
+ */
+static inline uint32_t tvn_index(uint32_t jiffy, uint32_t level) noexcept
+{
+    return (jiffy >> (TVR_BITS + level * TVN_BITS)) & TVN_MASK;
+}
+
+/**
+ * @brief Put timer into slot of its expiry.
+ *
+ * @param [in] base - given timer wheel.
+ * @param [in] t - given timer.
+ */
+static void internal_add_timer(timer_base_t& base, timer_list_t *t) noexcept
+{
+    uint32_t expires = t->m_expires;
+    uint32_t idx     = expires - base.m_jiffies;
+    timer_list_t **slot;
+
+    if (static_cast<int32_t>(idx) < 0) {
+        // already expired timers run at the next processed jiffy
+        slot = &base.m_tv1[base.m_jiffies & TVR_MASK];
+    }
+    else if (idx < TVR_SIZE)
+        slot = &base.m_tv1[expires & TVR_MASK];
+    else {
+        uint32_t level = 0;
+
+        // the last level covers the rest of 32-bit range
+        while (level < TVN_LEVELS - 1 && idx >= 1U << (TVR_BITS + (level + 1) * TVN_BITS))
+            level++;
+
+        slot = &base.m_tvn[level][tvn_index(expires, level)];
+    }
+
+    t->m_next  = *slot;
+    t->m_pprev = slot;
+
+    if (*slot)
+        (*slot)->m_pprev = &t->m_next;
+
+    *slot = t;
+    base.m_pending++;
+}
+
+/**
+ * @brief Remove timer from its slot.
+ *
+ * @param [in] base - given timer wheel.
+ * @param [in] t - given pending timer.
+ */
+static void detach_timer(timer_base_t& base, timer_list_t *t) noexcept
+{
+    *t->m_pprev = t->m_next;
+
+    if (t->m_next)
+        t->m_next->m_pprev = t->m_pprev;
+
+    t->m_next  = nullptr;
+    t->m_pprev = nullptr;
+    base.m_pending--;
+}
+
+/**
+ * @brief Move timers of coarse slot to finer levels.
+ *
+ * @param [in] base - given timer wheel.
+ * @param [in] level - given cascading level.
+ * @param [in] index - given slot index.
+ * @return slot index (0 - the next level has to be cascaded too).
+ */
+static uint32_t cascade(timer_base_t& base, uint32_t level, uint32_t index) noexcept
+{
+    timer_list_t *t = base.m_tvn[level][index];
+    base.m_tvn[level][index] = nullptr;
+
+    while (t) {
+        timer_list_t *next = t->m_next;
+
+        base.m_pending--;
+        internal_add_timer(base, t);
+        timer_stats.this_cpu().m_cascaded++;
+        t = next;
+    }
+
+    return index;
+}
+
+/**
+ * @brief Round expiry up within timer slack.
+ *
+ * @param [in] t - given timer.
+ * @param [in] expires - given expiry.
+ * @param [in] now - given current jiffy.
+ * @return expiry with low bits cleared.
+ */
+static uint32_t apply_slack(const timer_list_t *t, uint32_t expires, uint32_t now) noexcept
+{
+    int32_t  delta = expires - now;
+    uint32_t slack = t->m_slack;
+
+    if (t->m_slack == TIMER_SLACK_AUTO)
+        slack = delta > 0 ? delta >> 8 : 0;
+
+    uint32_t limit = expires + slack;
+    uint32_t mask  = expires ^ limit;
+
+    if (!slack || !mask)
+        return expires;
+
+    // clear bits below the highest one that differs in range
+    mask = (1U << ilog2(mask)) - 1;
+    return limit & ~mask;
+}
+
+/**
+ * @brief Run expired timers of wheel.
+ *
+ * @param [in] base - given timer wheel of current CPU.
+ */
+static void run_timers(timer_base_t& base) noexcept
+{
+    auto     flags = arch::x86::irq_save();
+    uint32_t now   = get_jiffies();
+
+    // empty wheel does not have to step through jiffies of idle period
+    if (!base.m_pending && time_after_eq(now, base.m_jiffies))
+        base.m_jiffies = now + 1;
+
+    while (time_after_eq(now, base.m_jiffies)) {
+        uint32_t index = base.m_jiffies & TVR_MASK;
+
+        // the whole per-jiffy level has passed
+        if (!index) {
+            for (uint32_t level = 0; level < TVN_LEVELS; level++) {
+                if (cascade(base, level, tvn_index(base.m_jiffies, level)))
+                    break;
+            }
+        }
+
+        base.m_jiffies++;
+
+        timer_list_t **slot = &base.m_tv1[index];
+
+        if (*slot)
+            timer_stats.this_cpu().m_batches++;
+
+        // functions may add & delete timers, so slot is reread each time
+        while (*slot) {
+            timer_list_t *t = *slot;
+            auto func       = t->m_func;
+            auto data       = t->m_data;
+
+            detach_timer(base, t);
+            timer_stats.this_cpu().m_expired++;
+
+            arch::x86::irq_restore(flags);
+            func(data);
+            flags = arch::x86::irq_save();
+        }
+    }
+
+    arch::x86::irq_restore(flags);
+}
+
+/** @brief Run expired timers of current CPU.*/
+static void run_timer_softirq(void) noexcept
+{
+    run_timers(timer_bases.this_cpu());
+}
+
+void timers_init(void) noexcept
+{
+    for (uint32_t cpu = 0; cpu < NR_CPUS; cpu++)
+        timer_bases[cpu].m_jiffies = get_jiffies();
+
+    open_softirq(SOFTIRQ::TIMER, run_timer_softirq);
+}
+
+void timer_init(timer_list_t *t, void (*func)(void *data) noexcept, void *data) noexcept
+{
+    t->m_next    = nullptr;
+    t->m_pprev   = nullptr;
+    t->m_expires = 0;
+    t->m_slack   = TIMER_SLACK_AUTO;
+    t->m_cpu     = 0;
+    t->m_func    = func;
+    t->m_data    = data;
+}
+
+void set_timer_slack(timer_list_t *t, int32_t slack) noexcept
+{
+    t->m_slack = slack;
+}
+
+bool mod_timer(timer_list_t *t, uint32_t expires) noexcept
+{
+    auto flags   = arch::x86::irq_save();
+    bool pending = timer_pending(t);
+
+    if (pending)
+        detach_timer(timer_bases[t->m_cpu], t);
+
+    t->m_cpu     = smp_processor_id();
+    t->m_expires = apply_slack(t, expires, get_jiffies());
+
+    internal_add_timer(timer_bases[t->m_cpu], t);
+    timer_stats[t->m_cpu].m_added++;
+
+    arch::x86::irq_restore(flags);
+    return pending;
+}
+
+void add_timer(timer_list_t *t) noexcept
+{
+    mod_timer(t, t->m_expires);
+}
+
+bool del_timer(timer_list_t *t) noexcept
+{
+    auto flags   = arch::x86::irq_save();
+    bool pending = timer_pending(t);
+
+    if (pending) {
+        detach_timer(timer_bases[t->m_cpu], t);
+        timer_stats[t->m_cpu].m_cancelled++;
+    }
+
+    arch::x86::irq_restore(flags);
+    return pending;
+}
+
+void run_local_timers(void) noexcept
+{
+    timer_base_t& base = timer_bases.this_cpu();
+
+    if (base.m_pending && time_after_eq(static_cast<uint32_t>(jiffies), base.m_jiffies))
+        raise_softirq_irqoff(SOFTIRQ::TIMER);
+}
+
+bool next_timer_expiry(uint64_t& expires) noexcept
+{
+    timer_base_t& base = timer_bases.this_cpu();
+
+    if (!base.m_pending)
+        return false;
+
+    uint32_t start = base.m_jiffies;
+    uint32_t delta = ~0U;   // the earliest expiry relative to start
+
+    // timers of per-jiffy slot expire exactly at its jiffy
+    for (uint32_t i = 0; i < TVR_SIZE; i++) {
+        if (base.m_tv1[(start + i) & TVR_MASK]) {
+            delta = i;
+            break;
+        }
+    }
+
+    // timers of the first non-empty slot of level expire before others of level
+    for (uint32_t level = 0; level < TVN_LEVELS; level++) {
+        uint32_t index = tvn_index(start, level);
+
+        for (uint32_t i = 1; i <= TVN_SIZE; i++) {
+            timer_list_t *t = base.m_tvn[level][(index + i) & TVN_MASK];
+
+            if (!t)
+                continue;
+
+            for (; t; t = t->m_next) {
+                uint32_t d = t->m_expires - start;
+
+                if (static_cast<int32_t>(d) < 0)
+                    d = 0;
+
+                if (d < delta)
+                    delta = d;
+            }
+
+            break;
+        }
+    }
+
+    uint64_t now = jiffies;
+    int32_t  due = start + delta - static_cast<uint32_t>(now);
+
+    expires = due > 0 ? now + due : now;
+    return true;
+}
+
+void timerstat(void) noexcept
+{
+    for (uint32_t cpu = 0; cpu < num_online_cpus(); cpu++) {
+        const timer_stats_t& stats = timer_stats[cpu];
+
+        printk("CPU %u: %u pending, %u added, %u cancelled, %u expired in %u batches, %u cascaded\n",
+            cpu, timer_bases[cpu].m_pending, stats.m_added, stats.m_cancelled,
+            stats.m_expired, stats.m_batches, stats.m_cascaded
+        );
+    }
+}
+
+} // namespace core
+} // namespace kernel
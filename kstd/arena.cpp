@@ -0,0 +1,131 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/kstd/arena.hpp>
+#include <kernel/pmm.hpp>
+
+using namespace kernel::core::memory;
+
+
+namespace kernel {
+namespace kstd {
+
+/**
+ * @brief Align pointer up.
+ *
+ * @param [in] ptr - given pointer to align.
+ * @param [in] align - given alignment (power of two).
+ * @return aligned pointer.
+ */
+static inline uint8_t *align_up(uint8_t *ptr, size_t align) noexcept
+{
+    auto addr = reinterpret_cast<uint32_t>(ptr);
+    auto mask = static_cast<uint32_t>(align - 1);
+
+    return reinterpret_cast<uint8_t*>((addr + mask) & ~mask);
+}
+
+void arena_t::init(void *buf, size_t size) noexcept
+{
+    m_chunk = nullptr;
+    m_ptr   = nullptr;
+
+    if (!buf || size <= sizeof(arena_chunk_t))
+        return;
+
+    // initial buffer is chained as a chunk that is never freed
+    auto chunk        = static_cast<arena_chunk_t*>(buf);
+    chunk->m_prev     = nullptr;
+    chunk->m_end      = static_cast<uint8_t*>(buf) + size;
+    chunk->m_order    = 0;
+    chunk->m_is_pages = false;
+
+    m_chunk = chunk;
+    m_ptr   = reinterpret_cast<uint8_t*>(chunk + 1);
+}
+
+bool arena_t::grow(size_t size) noexcept
+{
+    auto order   = get_order(size + sizeof(arena_chunk_t));
+    page_t *page = pmm.alloc_pages(GFP::KERNEL, order);
+
+    if (!page)
+        return false;
+
+    auto chunk        = static_cast<arena_chunk_t*>(page->addr());
+    chunk->m_prev     = m_chunk;
+    chunk->m_end      = reinterpret_cast<uint8_t*>(chunk) + (PAGE_SIZE << order);
+    chunk->m_order    = order;
+    chunk->m_is_pages = true;
+
+    m_chunk = chunk;
+    m_ptr   = reinterpret_cast<uint8_t*>(chunk + 1);
+
+    return true;
+}
+
+void arena_t::pop_chunk(void) noexcept
+{
+    arena_chunk_t *chunk = m_chunk;
+
+    m_chunk = chunk->m_prev;
+    m_ptr   = m_chunk ? m_chunk->m_end : nullptr;
+
+    if (chunk->m_is_pages)
+        pmm.free_pages(virt_to_phys(chunk), chunk->m_order);
+}
+
+void *arena_t::alloc(size_t size, size_t align) noexcept
+{
+    uint8_t *ptr = m_chunk ? align_up(m_ptr, align) : nullptr;
+
+    // current chunk is exhausted - chain a new one
+    if (!ptr || ptr + size > m_chunk->m_end) {
+        if (!grow(size + align))
+            return nullptr;
+
+        ptr = align_up(m_ptr, align);
+    }
+
+    m_ptr = ptr + size;
+    return ptr;
+}
+
+arena_mark_t arena_t::mark(void) const noexcept
+{
+    return {m_chunk, m_ptr};
+}
+
+void arena_t::rewind(const arena_mark_t& mark) noexcept
+{
+    while (m_chunk && m_chunk != mark.m_chunk)
+        pop_chunk();
+
+    m_ptr = mark.m_ptr;
+}
+
+void arena_t::release(void) noexcept
+{
+    while (m_chunk && m_chunk->m_is_pages)
+        pop_chunk();
+
+    m_ptr = m_chunk ? reinterpret_cast<uint8_t*>(m_chunk + 1) : nullptr;
+}
+
+} // namespace kstd
+} // namespace kernel
@@ -33,6 +33,48 @@ void *memset(void *s, int32_t c, size_t n) noexcept
     return s;
 }
 
+void *memcpy(void *dest, const void *src, size_t n) noexcept
+{
+    auto dwords = static_cast<uint32_t>(n >> 2);
+    auto bytes  = static_cast<uint32_t>(n & 0x3);
+    void *d     = dest;
+
+    // copy by double words and then the remaining bytes
+    __asm__ volatile(
+        "rep movsl\n\t"
+        "movl %3, %%ecx\n\t"
+        "rep movsb"
+        : "+D"(d), "+S"(src), "+c"(dwords)
+        : "r"(bytes)
+        : "memory"
+    );
+
+    return dest;
+}
+
+int32_t memcmp(const void *s1, const void *s2, size_t n) noexcept
+{
+    auto p1 = static_cast<const uint8_t*>(s1);
+    auto p2 = static_cast<const uint8_t*>(s2);
+
+    // skip equal double words, then find the differing byte
+    while (n >= 4 && *reinterpret_cast<const uint32_t*>(p1) == *reinterpret_cast<const uint32_t*>(p2)) {
+        p1 += 4;
+        p2 += 4;
+        n  -= 4;
+    }
+
+    while (n--) {
+        if (*p1 != *p2)
+            return *p1 - *p2;
+
+        p1++;
+        p2++;
+    }
+
+    return 0;
+}
+
 int32_t strncmp(const char *s1, const char *s2, size_t n) noexcept
 {
     size_t i = 0;
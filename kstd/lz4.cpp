@@ -0,0 +1,260 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/kstd/cstring.hpp>
+#include <kernel/kstd/lz4.hpp>
+
+
+namespace kernel {
+namespace kstd {
+
+inline const uint32_t LZ4_MINMATCH     {4};     // shortest back-reference
+inline const uint32_t LZ4_LASTLITERALS {5};     // block always ends with literals
+inline const uint32_t LZ4_MFLIMIT      {12};    // last match starts before that many bytes from the end
+inline const uint32_t LZ4_MAX_DISTANCE {0xFFFF};
+inline const uint32_t LZ4_RUN_MASK     {0xF};   // token field value followed by length bytes
+
+/**
+ * @brief Read unaligned 32-bit word.
+ *
+ * @param [in] p - given address.
+ * @return word value.
+ */
+static inline uint32_t read32(const uint8_t *p) noexcept
+{
+    uint32_t v;
+    kstd::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**
+ * @brief Hash 4 bytes at position.
+ *
+ * @param [in] p - given address.
+ * @return hash table index.
+ */
+static inline uint32_t lz4_hash(const uint8_t *p) noexcept
+{
+    return (read32(p) * 2654435761U) >> (32 - LZ4_HASH_LOG);
+}
+
+/**
+ * @brief Write length continuation bytes.
+ *
+ * @param [out] op - given output position.
+ * @param [in] len - given length left after token field.
+ * @return output position after length bytes.
+ */
+static inline uint8_t *write_length(uint8_t *op, uint32_t len) noexcept
+{
+    while (len >= 255) {
+        *op++ = 255;
+        len  -= 255;
+    }
+
+    *op++ = static_cast<uint8_t>(len);
+    return op;
+}
+
+/**
+ * @brief Write sequence of literals and optional match.
+ *
+ * @param [out] op - given output position.
+ * @param [in] oend - given output end.
+ * @param [in] lit - given literals.
+ * @param [in] nlit - given number of literals.
+ * @param [in] offset - given match distance (0 - last sequence without match).
+ * @param [in] mlen - given match length.
+ * @return output position after sequence - in case of success.
+ * @return nullptr - in case of output buffer is too small.
+ */
+static uint8_t *write_sequence(uint8_t *op, const uint8_t *oend, const uint8_t *lit,
+                               uint32_t nlit, uint32_t offset, uint32_t mlen) noexcept
+{
+    // worst case of token, length bytes, literals & offset
+    uint32_t need = 1 + nlit / 255 + 1 + nlit + 2 + (mlen / 255 + 1);
+
+    if (need > static_cast<uint32_t>(oend - op))
+        return nullptr;
+
+    uint8_t *token = op++;
+    *token = (nlit >= LZ4_RUN_MASK ? LZ4_RUN_MASK : nlit) << 4;
+
+    if (nlit >= LZ4_RUN_MASK)
+        op = write_length(op, nlit - LZ4_RUN_MASK);
+
+    kstd::memcpy(op, lit, nlit);
+    op += nlit;
+
+    if (!offset)
+        return op;
+
+    *op++ = offset & 0xFF;
+    *op++ = offset >> 8;
+
+    mlen   -= LZ4_MINMATCH;
+    *token |= mlen >= LZ4_RUN_MASK ? LZ4_RUN_MASK : mlen;
+
+    if (mlen >= LZ4_RUN_MASK)
+        op = write_length(op, mlen - LZ4_RUN_MASK);
+
+    return op;
+}
+
+uint32_t lz4_compress(const void *src, uint32_t size, void *dst, uint32_t capacity, void *wrkmem) noexcept
+{
+    if (size > LZ4_MAX_INPUT)
+        return 0;
+
+    auto base     = static_cast<const uint8_t*>(src);
+    auto table    = static_cast<uint16_t*>(wrkmem);
+    const uint8_t *ip     = base;
+    const uint8_t *anchor = base;
+    const uint8_t *end    = base + size;
+    uint8_t *op           = static_cast<uint8_t*>(dst);
+    const uint8_t *oend   = op + capacity;
+
+    kstd::memset(table, 0, LZ4_WORKMEM);
+
+    if (size > LZ4_MFLIMIT) {
+        const uint8_t *mflimit    = end - LZ4_MFLIMIT;
+        const uint8_t *matchlimit = end - LZ4_LASTLITERALS;
+
+        ip++;
+
+        while (ip < mflimit) {
+            uint32_t h         = lz4_hash(ip);
+            const uint8_t *ref = base + table[h];
+
+            table[h] = static_cast<uint16_t>(ip - base);
+
+            // stale or colliding entries are filtered by comparing bytes
+            if (ref >= ip || static_cast<uint32_t>(ip - ref) > LZ4_MAX_DISTANCE || read32(ref) != read32(ip)) {
+                // skip faster through incompressible data
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            // extend match backwards over pending literals
+            while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+                ip--;
+                ref--;
+            }
+
+            const uint8_t *m = ip + LZ4_MINMATCH;
+            const uint8_t *r = ref + LZ4_MINMATCH;
+
+            while (m < matchlimit && *m == *r) {
+                m++;
+                r++;
+            }
+
+            op = write_sequence(op, oend, anchor, ip - anchor, ip - ref, m - ip);
+
+            if (!op)
+                return 0;
+
+            ip     = m;
+            anchor = ip;
+
+            // position inside the match helps the next search
+            if (ip < mflimit)
+                table[lz4_hash(ip - 2)] = static_cast<uint16_t>(ip - 2 - base);
+        }
+    }
+
+    op = write_sequence(op, oend, anchor, end - anchor, 0, 0);
+
+    if (!op)
+        return 0;
+
+    return op - static_cast<uint8_t*>(dst);
+}
+
+int32_t lz4_decompress(const void *src, uint32_t size, void *dst, uint32_t capacity) noexcept
+{
+    auto ip         = static_cast<const uint8_t*>(src);
+    auto iend       = ip + size;
+    auto op         = static_cast<uint8_t*>(dst);
+    auto oend       = op + capacity;
+    uint8_t *ostart = op;
+
+    while (ip < iend) {
+        uint32_t token = *ip++;
+        uint32_t len   = token >> 4;
+        uint8_t b;
+
+        if (len == LZ4_RUN_MASK) {
+            do {
+                if (ip >= iend)
+                    return -1;
+
+                b    = *ip++;
+                len += b;
+            } while (b == 255);
+        }
+
+        if (len > static_cast<uint32_t>(iend - ip) || len > static_cast<uint32_t>(oend - op))
+            return -1;
+
+        kstd::memcpy(op, ip, len);
+        op += len;
+        ip += len;
+
+        // the last sequence has literals only
+        if (ip == iend)
+            break;
+
+        if (iend - ip < 2)
+            return -1;
+
+        uint32_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+
+        if (!offset || offset > static_cast<uint32_t>(op - ostart))
+            return -1;
+
+        len = token & LZ4_RUN_MASK;
+
+        if (len == LZ4_RUN_MASK) {
+            do {
+                if (ip >= iend)
+                    return -1;
+
+                b    = *ip++;
+                len += b;
+            } while (b == 255);
+        }
+
+        len += LZ4_MINMATCH;
+
+        if (len > static_cast<uint32_t>(oend - op))
+            return -1;
+
+        // match may overlap output, so it is copied byte by byte
+        const uint8_t *match = op - offset;
+
+        while (len--)
+            *op++ = *match++;
+    }
+
+    return op - ostart;
+}
+
+} // namespace kstd
+} // namespace kernel
@@ -0,0 +1,342 @@
+/**
+ * Monolithic Unix-like kernel from scratch.
+ * Copyright (C) 2024 Alexander (@alkuzin).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/kstd/rbtree.hpp>
+
+
+namespace kernel {
+namespace kstd {
+
+/**
+ * @brief Check node color.
+ *
+ * @param [in] node - given tree node (nullptr - leaf).
+ * @return true - in case of red node.
+ * @return false - in case of black node or leaf.
+ */
+static inline bool is_red(const rb_node_t *node) noexcept
+{
+    return node && node->m_red;
+}
+
+void rb_root_t::replace_child(rb_node_t *parent, rb_node_t *old, rb_node_t *node) noexcept
+{
+    if (!parent)
+        m_node = node;
+    else if (parent->m_left == old)
+        parent->m_left = node;
+    else
+        parent->m_right = node;
+}
+
+void rb_root_t::rotate_left(rb_node_t *node, rb_augment_t augment) noexcept
+{
+    rb_node_t *right = node->m_right;
+
+    node->m_right = right->m_left;
+
+    if (right->m_left)
+        right->m_left->m_parent = node;
+
+    right->m_parent = node->m_parent;
+    replace_child(node->m_parent, node, right);
+
+    right->m_left  = node;
+    node->m_parent = right;
+
+    // lower node first, since upper node depends on it
+    if (augment) {
+        augment(node);
+        augment(right);
+    }
+}
+
+void rb_root_t::rotate_right(rb_node_t *node, rb_augment_t augment) noexcept
+{
+    rb_node_t *left = node->m_left;
+
+    node->m_left = left->m_right;
+
+    if (left->m_right)
+        left->m_right->m_parent = node;
+
+    left->m_parent = node->m_parent;
+    replace_child(node->m_parent, node, left);
+
+    left->m_right  = node;
+    node->m_parent = left;
+
+    if (augment) {
+        augment(node);
+        augment(left);
+    }
+}
+
+void rb_root_t::insert(rb_node_t *node, rb_node_t *parent, rb_node_t **link, rb_augment_t augment) noexcept
+{
+    node->m_parent = parent;
+    node->m_left   = nullptr;
+    node->m_right  = nullptr;
+    node->m_red    = true;
+    *link          = node;
+
+    if (augment)
+        rb_propagate(node, augment);
+
+    while ((parent = node->m_parent) && parent->m_red) {
+        // red parent is never the root
+        rb_node_t *gparent = parent->m_parent;
+
+        if (parent == gparent->m_left) {
+            rb_node_t *uncle = gparent->m_right;
+
+            if (is_red(uncle)) {
+                parent->m_red  = false;
+                uncle->m_red   = false;
+                gparent->m_red = true;
+                node = gparent;
+                continue;
+            }
+
+            if (node == parent->m_right) {
+                rotate_left(parent, augment);
+                node   = parent;
+                parent = node->m_parent;
+            }
+
+            parent->m_red  = false;
+            gparent->m_red = true;
+            rotate_right(gparent, augment);
+        }
+        else {
+            rb_node_t *uncle = gparent->m_left;
+
+            if (is_red(uncle)) {
+                parent->m_red  = false;
+                uncle->m_red   = false;
+                gparent->m_red = true;
+                node = gparent;
+                continue;
+            }
+
+            if (node == parent->m_left) {
+                rotate_right(parent, augment);
+                node   = parent;
+                parent = node->m_parent;
+            }
+
+            parent->m_red  = false;
+            gparent->m_red = true;
+            rotate_left(gparent, augment);
+        }
+    }
+
+    m_node->m_red = false;
+}
+
+void rb_root_t::erase(rb_node_t *node, rb_augment_t augment) noexcept
+{
+    // node with two children is replaced by its successor
+    rb_node_t *victim = node;
+
+    if (node->m_left && node->m_right) {
+        victim = node->m_right;
+
+        while (victim->m_left)
+            victim = victim->m_left;
+    }
+
+    rb_node_t *child  = victim->m_left ? victim->m_left : victim->m_right;
+    rb_node_t *parent = victim->m_parent;
+    bool was_red      = victim->m_red;
+
+    if (child)
+        child->m_parent = parent;
+
+    replace_child(parent, victim, child);
+
+    if (victim != node) {
+        if (parent == node)
+            parent = victim;
+
+        victim->m_left   = node->m_left;
+        victim->m_right  = node->m_right;
+        victim->m_parent = node->m_parent;
+        victim->m_red    = node->m_red;
+        replace_child(node->m_parent, node, victim);
+
+        if (victim->m_left)
+            victim->m_left->m_parent = victim;
+
+        if (victim->m_right)
+            victim->m_right->m_parent = victim;
+    }
+
+    if (augment && parent)
+        rb_propagate(parent, augment);
+
+    if (was_red)
+        return;
+
+    // removed black node - restore black height
+    while (child != m_node && !is_red(child)) {
+        if (child == parent->m_left) {
+            rb_node_t *sibling = parent->m_right;
+
+            if (sibling->m_red) {
+                sibling->m_red = false;
+                parent->m_red  = true;
+                rotate_left(parent, augment);
+                sibling = parent->m_right;
+            }
+
+            if (!is_red(sibling->m_left) && !is_red(sibling->m_right)) {
+                sibling->m_red = true;
+                child  = parent;
+                parent = child->m_parent;
+                continue;
+            }
+
+            if (!is_red(sibling->m_right)) {
+                sibling->m_left->m_red = false;
+                sibling->m_red         = true;
+                rotate_right(sibling, augment);
+                sibling = parent->m_right;
+            }
+
+            sibling->m_red = parent->m_red;
+            parent->m_red  = false;
+            sibling->m_right->m_red = false;
+            rotate_left(parent, augment);
+            child = m_node;
+        }
+        else {
+            rb_node_t *sibling = parent->m_left;
+
+            if (sibling->m_red) {
+                sibling->m_red = false;
+                parent->m_red  = true;
+                rotate_right(parent, augment);
+                sibling = parent->m_left;
+            }
+
+            if (!is_red(sibling->m_left) && !is_red(sibling->m_right)) {
+                sibling->m_red = true;
+                child  = parent;
+                parent = child->m_parent;
+                continue;
+            }
+
+            if (!is_red(sibling->m_left)) {
+                sibling->m_right->m_red = false;
+                sibling->m_red          = true;
+                rotate_left(sibling, augment);
+                sibling = parent->m_left;
+            }
+
+            sibling->m_red = parent->m_red;
+            parent->m_red  = false;
+            sibling->m_left->m_red = false;
+            rotate_right(parent, augment);
+            child = m_node;
+        }
+    }
+
+    if (child)
+        child->m_red = false;
+}
+
+rb_node_t *rb_root_t::first(void) const noexcept
+{
+    rb_node_t *node = m_node;
+
+    while (node && node->m_left)
+        node = node->m_left;
+
+    return node;
+}
+
+rb_node_t *rb_root_t::last(void) const noexcept
+{
+    rb_node_t *node = m_node;
+
+    while (node && node->m_right)
+        node = node->m_right;
+
+    return node;
+}
+
+void rb_root_cached_t::insert(rb_node_t *node, rb_node_t *parent, rb_node_t **link, bool leftmost,
+    rb_augment_t augment) noexcept
+{
+    if (leftmost)
+        m_leftmost = node;
+
+    m_root.insert(node, parent, link, augment);
+}
+
+void rb_root_cached_t::erase(rb_node_t *node, rb_augment_t augment) noexcept
+{
+    if (m_leftmost == node)
+        m_leftmost = rb_next(node);
+
+    m_root.erase(node, augment);
+}
+
+rb_node_t *rb_next(const rb_node_t *node) noexcept
+{
+    if (node->m_right) {
+        node = node->m_right;
+
+        while (node->m_left)
+            node = node->m_left;
+
+        return const_cast<rb_node_t*>(node);
+    }
+
+    while (node->m_parent && node == node->m_parent->m_right)
+        node = node->m_parent;
+
+    return node->m_parent;
+}
+
+rb_node_t *rb_prev(const rb_node_t *node) noexcept
+{
+    if (node->m_left) {
+        node = node->m_left;
+
+        while (node->m_right)
+            node = node->m_right;
+
+        return const_cast<rb_node_t*>(node);
+    }
+
+    while (node->m_parent && node == node->m_parent->m_left)
+        node = node->m_parent;
+
+    return node->m_parent;
+}
+
+void rb_propagate(rb_node_t *node, rb_augment_t augment) noexcept
+{
+    for (; node; node = node->m_parent)
+        augment(node);
+}
+
+} // namespace kstd
+} // namespace kernel